@@ -0,0 +1,242 @@
+#include "graph_generator.h"
+
+// every cycle folds a subtraction of constants and removes a subtraction of zero
+Graph* GraphGenerator::GenerateLinear(uint32_t insts_num)
+{
+    GraphGenerator gen;
+    BasicBlock* bb = gen.NewBlock();
+    Inst* acc = gen.Append(bb, Opcode::PARAMETER);
+    Inst* param = gen.Append(bb, Opcode::PARAMETER);
+    for (int32_t i = 0; bb->GetSize() < insts_num; ++i) {
+        Inst* folded = gen.Append(bb, Opcode::SUB, {gen.AppendConstant(bb, i + 1), gen.AppendConstant(bb, i)});
+        Inst* sub_zero = gen.Append(bb, Opcode::SUB, {acc, gen.AppendConstant(bb, 0)});
+        acc = gen.Append(bb, Opcode::ADD, {sub_zero, folded});
+        acc = gen.Append(bb, Opcode::MUL, {acc, param});
+    }
+    gen.Append(bb, Opcode::RET, {acc});
+    return gen.g_;
+}
+
+// header of every loop but the innermost one is followed by the header
+// of the inner loop, the innermost body checks the parameter twice
+Graph* GraphGenerator::GenerateLoopNest(uint32_t depth)
+{
+    GraphGenerator gen;
+    BasicBlock* entry = gen.NewBlock();
+    std::vector<BasicBlock*> headers;
+    for (uint32_t i = 0; i < depth; ++i) {
+        headers.push_back(gen.NewBlock());
+    }
+    BasicBlock* body = gen.NewBlock();
+    std::vector<BasicBlock*> latches;
+    for (uint32_t i = 0; i < depth; ++i) {
+        latches.push_back(gen.NewBlock());
+    }
+    BasicBlock* exit = gen.NewBlock();
+
+    Inst* bound = gen.Append(entry, Opcode::PARAMETER);
+    Inst* zero = gen.AppendConstant(entry, 0);
+    Inst* one = gen.AppendConstant(entry, 1);
+    Connect(entry, {headers.front()});
+
+    std::vector<Inst*> counters;
+    for (uint32_t i = 0; i < depth; ++i) {
+        BasicBlock* loop_exit = i == 0 ? exit : latches[i - 1];
+        BasicBlock* loop_body = i + 1 == depth ? body : headers[i + 1];
+        // zero comes from the enclosing header, not from the block defining it
+        BasicBlock* preheader = i == 0 ? entry : headers[i - 1];
+        Inst* counter = gen.Append(headers[i], Opcode::PHI);
+        counter->CastToInstPhi()->AddInput(zero, preheader);
+        zero->AddUser(counter);
+        counters.push_back(counter);
+        gen.Append(headers[i], Opcode::CMP, {counters[i], bound});
+        gen.AppendJmp(headers[i], Opcode::JMP_GE, loop_exit);
+        Connect(headers[i], {loop_exit, loop_body});
+    }
+
+    gen.Append(body, Opcode::CHECK_EQ_ZERO, {bound});
+    gen.Append(body, Opcode::MUL, {counters.front(), counters.back()});
+    gen.Append(body, Opcode::CHECK_EQ_ZERO, {bound});
+    Connect(body, {latches.back()});
+
+    for (uint32_t i = 0; i < depth; ++i) {
+        Inst* next = gen.Append(latches[i], Opcode::ADD, {counters[i], one});
+        counters[i]->CastToInstPhi()->AddInput(next, latches[i]);
+        next->AddUser(counters[i]);
+        gen.AppendJmp(latches[i], Opcode::JMP, headers[i]);
+        Connect(latches[i], {headers[i]});
+    }
+
+    gen.Append(exit, Opcode::RET_VOID);
+    return gen.g_;
+}
+
+Graph* GraphGenerator::GenerateSwitch(uint32_t cases_num)
+{
+    GraphGenerator gen;
+    BasicBlock* entry = gen.NewBlock();
+    std::vector<BasicBlock*> dispatches;
+    std::vector<BasicBlock*> cases;
+    for (uint32_t i = 0; i < cases_num; ++i) {
+        dispatches.push_back(gen.NewBlock());
+        cases.push_back(gen.NewBlock());
+    }
+    BasicBlock* default_case = gen.NewBlock();
+    BasicBlock* merge = gen.NewBlock();
+
+    Inst* value = gen.Append(entry, Opcode::PARAMETER);
+    Connect(entry, {dispatches.front()});
+
+    std::vector<Inst*> results;
+    for (uint32_t i = 0; i < cases_num; ++i) {
+        BasicBlock* next = i + 1 == cases_num ? default_case : dispatches[i + 1];
+        Inst* case_value = gen.AppendConstant(dispatches[i], i);
+        gen.Append(dispatches[i], Opcode::CMP, {value, case_value});
+        // false branch must end with jmp, so cases are false branches
+        gen.AppendJmp(dispatches[i], Opcode::JMP_NE, next);
+        Connect(dispatches[i], {next, cases[i]});
+
+        results.push_back(gen.Append(cases[i], Opcode::MUL, {value, case_value}));
+        gen.AppendJmp(cases[i], Opcode::JMP, merge);
+        Connect(cases[i], {merge});
+    }
+    results.push_back(gen.Append(default_case, Opcode::NOT, {value}));
+    gen.AppendJmp(default_case, Opcode::JMP, merge);
+    Connect(default_case, {merge});
+
+    gen.Append(merge, Opcode::RET, {gen.AppendPhi(merge, results)});
+    return gen.g_;
+}
+
+Graph* GraphGenerator::GeneratePhis(uint32_t phis_num)
+{
+    GraphGenerator gen;
+    BasicBlock* entry = gen.NewBlock();
+    BasicBlock* left = gen.NewBlock();
+    BasicBlock* right = gen.NewBlock();
+    BasicBlock* merge = gen.NewBlock();
+
+    Inst* param1 = gen.Append(entry, Opcode::PARAMETER);
+    Inst* param2 = gen.Append(entry, Opcode::PARAMETER);
+    gen.Append(entry, Opcode::CMP, {param1, param2});
+    gen.AppendJmp(entry, Opcode::JMP_EQ, left);
+    Connect(entry, {left, right});
+
+    // values of every branch are live until the merge
+    std::vector<Inst*> left_values = {param1};
+    std::vector<Inst*> right_values = {param1};
+    for (uint32_t i = 0; i < phis_num; ++i) {
+        left_values.push_back(gen.Append(left, Opcode::ADD, {left_values.back(), param2}));
+        right_values.push_back(gen.Append(right, Opcode::SUB, {right_values.back(), param2}));
+    }
+    gen.AppendJmp(left, Opcode::JMP, merge);
+    Connect(left, {merge});
+    gen.AppendJmp(right, Opcode::JMP, merge);
+    Connect(right, {merge});
+
+    std::vector<Inst*> phis;
+    for (uint32_t i = 1; i <= phis_num; ++i) {
+        phis.push_back(gen.AppendPhi(merge, {left_values[i], right_values[i]}));
+    }
+    Inst* sum = param2;
+    for (auto phi: phis) {
+        sum = gen.Append(merge, Opcode::ADD, {sum, phi});
+    }
+    gen.Append(merge, Opcode::RET, {sum});
+    return gen.g_;
+}
+
+Graph* GraphGenerator::GenerateCalls(uint32_t calls_num)
+{
+    static Graph* callee = []() {
+        GraphGenerator gen;
+        BasicBlock* bb = gen.NewBlock();
+        Inst* param = gen.Append(bb, Opcode::PARAMETER);
+        Inst* result = gen.Append(bb, Opcode::SUB, {param, gen.AppendConstant(bb, 3)});
+        gen.Append(bb, Opcode::RET, {result});
+        return gen.g_;
+    }();
+
+    GraphGenerator gen;
+    BasicBlock* bb = gen.NewBlock();
+    Inst* value = gen.Append(bb, Opcode::PARAMETER);
+    for (uint32_t i = 0; i < calls_num; ++i) {
+        value = gen.AppendCall(bb, callee, {value});
+    }
+    gen.Append(bb, Opcode::RET, {value});
+    return gen.g_;
+}
+
+BasicBlock* GraphGenerator::NewBlock()
+{
+    BasicBlock* bb = new BasicBlock(g_->NewBBId());
+    g_->AddBasicBlock(bb);
+    return bb;
+}
+
+void GraphGenerator::Connect(BasicBlock* bb, std::vector<BasicBlock*> succs)
+{
+    for (auto succ: succs) {
+        bb->AddSucc(succ);
+        succ->AddPred(bb);
+    }
+}
+
+Inst* GraphGenerator::Append(BasicBlock* bb, Opcode opcode, std::vector<Inst*> inputs)
+{
+    Inst* inst = Inst::InstBuilder(opcode, g_->NewInstId());
+    switch (inst->GetType()) {
+    case Type::InstWithOneInput:
+        assert(inputs.size() == 1);
+        inst->CastToInstWithOneInput()->SetInput1(inputs[0]);
+        break;
+    case Type::InstWithTwoInputs:
+        assert(inputs.size() == 2);
+        inst->CastToInstWithTwoInputs()->SetInput1(inputs[0]);
+        inst->CastToInstWithTwoInputs()->SetInput2(inputs[1]);
+        break;
+    default:
+        assert(inputs.empty());
+        break;
+    }
+    for (auto input: inputs) {
+        input->AddUser(inst);
+    }
+    bb->PushBackInst(inst);
+    return inst;
+}
+
+Inst* GraphGenerator::AppendConstant(BasicBlock* bb, int32_t constant)
+{
+    Inst* inst = Append(bb, Opcode::CONSTANT);
+    inst->CastToInstConstant()->SetConstant(constant);
+    return inst;
+}
+
+Inst* GraphGenerator::AppendJmp(BasicBlock* bb, Opcode opcode, BasicBlock* target)
+{
+    Inst* inst = Append(bb, opcode);
+    inst->CastToInstJmp()->SetTargetBB(target);
+    return inst;
+}
+
+Inst* GraphGenerator::AppendPhi(BasicBlock* bb, std::vector<Inst*> inputs)
+{
+    Inst* inst = Append(bb, Opcode::PHI);
+    for (auto input: inputs) {
+        inst->CastToInstPhi()->AddInput(input, input->GetBB());
+        input->AddUser(inst);
+    }
+    return inst;
+}
+
+Inst* GraphGenerator::AppendCall(BasicBlock* bb, Graph* callee, std::vector<Inst*> arguments)
+{
+    Inst* inst = Append(bb, Opcode::CALL_STATIC);
+    inst->CastToInstCall()->SetCallee(callee);
+    inst->CastToInstCall()->SetArguments(arguments);
+    for (auto argument: arguments) {
+        argument->AddUser(inst);
+    }
+    return inst;
+}
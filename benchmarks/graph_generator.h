@@ -0,0 +1,41 @@
+#ifndef GRAPH_GENERATOR_H
+#define GRAPH_GENERATOR_H
+
+#include <utility>
+#include <vector>
+
+#include "ir/graph.h"
+
+// Synthetic graphs of a given size for benchmarks. Every graph has
+// a context of its own and is destroyed by Graph::GraphDestroyer
+class GraphGenerator {
+public:
+    // straight-line arithmetic, a part of which is folded by optimizations
+    static Graph* GenerateLinear(uint32_t insts_num);
+    // loops nested into each other, every loop counts up to a parameter
+    static Graph* GenerateLoopNest(uint32_t depth);
+    // chain of comparisons, which selects one of cases, case results
+    // are merged by a phi with an input per case
+    static Graph* GenerateSwitch(uint32_t cases_num);
+    // diamond, which merges phis_num values
+    static Graph* GeneratePhis(uint32_t phis_num);
+    // chain of calls of one small callee, which is shared by all callers
+    static Graph* GenerateCalls(uint32_t calls_num);
+
+private:
+    GraphGenerator() : g_(new Graph({})) {}
+
+    BasicBlock* NewBlock();
+    // first successor is true branch
+    static void Connect(BasicBlock* bb, std::vector<BasicBlock*> succs);
+
+    Inst* Append(BasicBlock* bb, Opcode opcode, std::vector<Inst*> inputs = {});
+    Inst* AppendConstant(BasicBlock* bb, int32_t constant);
+    Inst* AppendJmp(BasicBlock* bb, Opcode opcode, BasicBlock* target);
+    Inst* AppendPhi(BasicBlock* bb, std::vector<Inst*> inputs);
+    Inst* AppendCall(BasicBlock* bb, Graph* callee, std::vector<Inst*> arguments);
+
+    Graph* g_ = nullptr;
+};
+
+#endif // GRAPH_GENERATOR_H
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include "graph_generator.h"
+#include "ir/ir_serializer.h"
+#include "pass/pipeline.h"
+#include "pass/reg_alloc.h"
+
+// serialized graphs are optimized and allocated, as they are cached
+static Graph* GenerateCompiled(Graph* (*generate)(uint32_t), uint32_t size)
+{
+    Graph* g = generate(size);
+    Pipeline::Create(OptLevel::O2).Run(g);
+    g->RunPass<RegAlloc>();
+    return g;
+}
+
+template <Graph* (*Generate)(uint32_t)>
+static void BM_Serialize(benchmark::State& state)
+{
+    Graph* g = GenerateCompiled(Generate, state.range(0));
+    IrSerializer serializer;
+    size_t size = 0;
+    for (auto _: state) {
+        size = serializer.Serialize({g}).size();
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+    Graph::GraphDestroyer(g);
+}
+
+template <Graph* (*Generate)(uint32_t)>
+static void BM_Deserialize(benchmark::State& state)
+{
+    Graph* g = GenerateCompiled(Generate, state.range(0));
+    std::vector<uint8_t> data = IrSerializer().Serialize({g});
+    uint64_t insts_num = 0;
+    for (auto _: state) {
+        std::vector<Graph*> methods = IrDeserializer().Deserialize(data.data(), data.size());
+
+        state.PauseTiming();
+        insts_num += g->GetInstsNum();
+        for (auto method: methods) {
+            Graph::GraphDestroyer(method);
+        }
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["insts"] = benchmark::Counter(insts_num, benchmark::Counter::kIsRate);
+    Graph::GraphDestroyer(g);
+}
+
+BENCHMARK_TEMPLATE(BM_Serialize, GraphGenerator::GenerateLinear)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_Serialize, GraphGenerator::GeneratePhis)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Deserialize, GraphGenerator::GenerateLinear)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_Deserialize, GraphGenerator::GeneratePhis)->Arg(256);
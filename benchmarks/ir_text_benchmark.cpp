@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include "graph_generator.h"
+#include "ir/ir_parser.h"
+#include "ir/ir_printer.h"
+
+template <Graph* (*Generate)(uint32_t)>
+static void BM_Print(benchmark::State& state)
+{
+    Graph* g = Generate(state.range(0));
+    IrPrinter printer;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(printer.Print({g}).data());
+    }
+    state.SetBytesProcessed(state.iterations() * printer.Print({g}).size());
+    Graph::GraphDestroyer(g);
+}
+
+template <Graph* (*Generate)(uint32_t)>
+static void BM_Parse(benchmark::State& state)
+{
+    Graph* g = Generate(state.range(0));
+    std::string text = IrPrinter().Print({g});
+    Graph::GraphDestroyer(g);
+    IrParser parser;
+    for (auto _: state) {
+        std::vector<Graph*> methods = parser.Parse(text);
+
+        state.PauseTiming();
+        for (auto method: methods) {
+            Graph::GraphDestroyer(method);
+        }
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK_TEMPLATE(BM_Print, GraphGenerator::GenerateLinear)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_Print, GraphGenerator::GeneratePhis)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Parse, GraphGenerator::GenerateLinear)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_Parse, GraphGenerator::GeneratePhis)->Arg(256);
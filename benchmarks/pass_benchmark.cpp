@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include "graph_generator.h"
+#include "pass/check_elimination.h"
+#include "pass/const_folding.h"
+#include "pass/dce.h"
+#include "pass/dom_tree_fast.h"
+#include "pass/dom_tree_slow.h"
+#include "pass/inlining.h"
+#include "pass/linear_order.h"
+#include "pass/liveness_analysis.h"
+#include "pass/loop_analyzer.h"
+#include "pass/peephole.h"
+#include "pass/pipeline.h"
+#include "pass/reg_alloc.h"
+#include "pass/rpo.h"
+
+template <typename... Passes>
+static void RunRequired(Graph* g, std::tuple<Passes...>*)
+{
+    (g->RunPass<Passes>(), ...);
+}
+
+// graph is generated and requirements of the pass are run outside
+// of the measured time, so the time is of the pass alone
+template <typename Pass, Graph* (*Generate)(uint32_t)>
+static void BM_Pass(benchmark::State& state)
+{
+    uint64_t insts_num = 0;
+    for (auto _: state) {
+        state.PauseTiming();
+        Graph* g = Generate(state.range(0));
+        RunRequired(g, static_cast<typename PassTraits<Pass>::Required*>(nullptr));
+        insts_num += g->GetInstsNum();
+        state.ResumeTiming();
+
+        g->RunPass<Pass>();
+
+        state.PauseTiming();
+        Graph::GraphDestroyer(g);
+        state.ResumeTiming();
+    }
+    state.counters["insts"] = benchmark::Counter(insts_num, benchmark::Counter::kIsRate);
+}
+
+template <OptLevel level, Graph* (*Generate)(uint32_t)>
+static void BM_Pipeline(benchmark::State& state)
+{
+    Pipeline pipeline = Pipeline::Create(level);
+    uint64_t insts_num = 0;
+    for (auto _: state) {
+        state.PauseTiming();
+        Graph* g = Generate(state.range(0));
+        insts_num += g->GetInstsNum();
+        state.ResumeTiming();
+
+        pipeline.Run(g);
+
+        state.PauseTiming();
+        Graph::GraphDestroyer(g);
+        state.ResumeTiming();
+    }
+    state.counters["insts"] = benchmark::Counter(insts_num, benchmark::Counter::kIsRate);
+}
+
+#define SHAPE_BENCHMARKS(bm, arg)                                                                                      \
+    BENCHMARK_TEMPLATE(bm, arg, GraphGenerator::GenerateLinear)->Arg(256)->Arg(4096);                                  \
+    BENCHMARK_TEMPLATE(bm, arg, GraphGenerator::GenerateLoopNest)->Arg(4)->Arg(32);                                    \
+    BENCHMARK_TEMPLATE(bm, arg, GraphGenerator::GenerateSwitch)->Arg(16)->Arg(256);                                    \
+    BENCHMARK_TEMPLATE(bm, arg, GraphGenerator::GeneratePhis)->Arg(16)->Arg(256);                                      \
+    BENCHMARK_TEMPLATE(bm, arg, GraphGenerator::GenerateCalls)->Arg(4)->Arg(64);
+
+SHAPE_BENCHMARKS(BM_Pass, RPO)
+SHAPE_BENCHMARKS(BM_Pass, DomTreeSlow)
+SHAPE_BENCHMARKS(BM_Pass, DomTreeFast)
+SHAPE_BENCHMARKS(BM_Pass, LoopAnalyzer)
+SHAPE_BENCHMARKS(BM_Pass, ConstFolding)
+SHAPE_BENCHMARKS(BM_Pass, DCE)
+SHAPE_BENCHMARKS(BM_Pass, Peephole)
+SHAPE_BENCHMARKS(BM_Pass, Inlining)
+SHAPE_BENCHMARKS(BM_Pass, CheckElimination)
+SHAPE_BENCHMARKS(BM_Pass, LinearOrder)
+SHAPE_BENCHMARKS(BM_Pass, LivenessAnalysis)
+SHAPE_BENCHMARKS(BM_Pass, RegAlloc)
+
+SHAPE_BENCHMARKS(BM_Pipeline, OptLevel::O1)
+SHAPE_BENCHMARKS(BM_Pipeline, OptLevel::O2)
+
+BENCHMARK_MAIN();
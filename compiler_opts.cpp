@@ -1,10 +1,17 @@
-#include "ir/graph.h"
+#include <iostream>
 
-#define INST Inst::InstBuilder
-#define BASIC_BLOCK BasicBlock::BasicBlockBuilder
-#define GRAPH Graph
+#include "driver/compiler_driver.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-    return 0;
+    DriverOptions options;
+    if (!CompilerDriver::ParseOptions(argc, argv, &options, std::cerr)) {
+        std::cerr << CompilerDriver::GetUsage();
+        return 1;
+    }
+    if (options.is_help_) {
+        std::cout << CompilerDriver::GetUsage();
+        return 0;
+    }
+    return CompilerDriver(options, std::cout).Run() ? 0 : 1;
 }
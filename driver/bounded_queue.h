@@ -0,0 +1,67 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Queue between a producer and a consumer thread, which holds at most
+// capacity items: producer waits while the queue is full, so it runs
+// ahead of the consumer by a bounded number of items
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity)
+    {
+        assert(capacity_ > 0);
+    }
+
+    void Push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        is_not_full_.wait(lock, [this]() { return items_.size() < capacity_; });
+        assert(!is_closed_);
+        items_.push_back(std::move(item));
+        is_not_empty_.notify_one();
+    }
+
+    // no items are pushed after close
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_closed_ = true;
+        is_not_empty_.notify_all();
+    }
+
+    // returns false if the queue is closed and all its items are taken
+    bool Pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        is_not_empty_.wait(lock, [this]() { return is_closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        is_not_full_.notify_one();
+        return true;
+    }
+
+    size_t GetSize()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+private:
+    size_t capacity_;
+    std::deque<T> items_;
+    bool is_closed_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable is_not_full_;
+    std::condition_variable is_not_empty_;
+};
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <unistd.h>
+
+#include "compilation_cache.h"
+#include "ir/graph_hasher.h"
+#include "ir/ir_serializer.h"
+#include "pass/reg_alloc.h"
+
+CompilationCache::CompilationCache(const std::string& dir, const Pipeline& pipeline, bool is_reg_alloc)
+    : dir_(dir), pipeline_(pipeline), is_reg_alloc_(is_reg_alloc)
+{
+    std::error_code error;
+    std::filesystem::create_directories(dir_, error);
+    if (error) {
+        throw_error("can not create cache directory " + dir_ + ": " + error.message());
+    }
+}
+
+std::vector<Graph*> CompilationCache::Compile(Graph* g)
+{
+    return Compile(g, GetKey(g));
+}
+
+std::vector<Graph*> CompilationCache::Compile(Graph* g, uint64_t key)
+{
+    std::vector<Graph*> cached = Load(key, g->GetContext());
+    if (!cached.empty()) {
+        hits_++;
+        return cached;
+    }
+    misses_++;
+    pipeline_.Run(g);
+    if (is_reg_alloc_) {
+        g->RunPass<RegAlloc>();
+    }
+    Store(key, g);
+    return {g};
+}
+
+uint64_t CompilationCache::GetKey(Graph* g)
+{
+    GraphHasher::Accumulator key;
+    key.Add(CACHE_VERSION);
+    key.Add(ir_serialization::VERSION);
+    key.Add(pipeline_.GetDescription());
+    key.Add(g->GetContext()->GetRegCount());
+    key.Add(is_reg_alloc_);
+    key.Add(GraphHasher().Hash(g));
+    return key.Get();
+}
+
+std::vector<Graph*> CompilationCache::Load(uint64_t key, CompilationContext* context)
+{
+    return IrDeserializer(context).DeserializeFile(GetPath(key));
+}
+
+// entry is renamed into place only when it is written completely,
+// so readers never see a partial entry
+void CompilationCache::Store(uint64_t key, Graph* compiled)
+{
+    static std::atomic<uint64_t> tmp_counter = 0;
+    std::string path = GetPath(key);
+    std::string tmp_path = path + ".tmp" + std::to_string(getpid()) + "." + std::to_string(tmp_counter++);
+    IrSerializer serializer;
+    const std::vector<uint8_t>& data = serializer.Serialize({compiled});
+    // failed store is a miss of the next lookup, not an error
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.close();
+    if (!file || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+    }
+}
+
+std::string CompilationCache::GetPath(uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.coir", static_cast<unsigned long long>(key));
+    return dir_ + "/" + name;
+}
@@ -0,0 +1,56 @@
+#ifndef COMPILATION_CACHE_H
+#define COMPILATION_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ir/graph.h"
+#include "pass/pipeline.h"
+
+// On-disk cache of optimized and register allocated graphs. Key is
+// a structural hash of the graph before compilation together with the
+// pipeline, the register count and whether registers are allocated.
+// Entries are binary IR files named by key, which are written atomically,
+// so processes may share the directory.
+// CACHE_VERSION is increased on changes of passes, which change results
+class CompilationCache
+{
+public:
+    static constexpr uint32_t CACHE_VERSION = 1;
+
+    CompilationCache(const std::string& dir, const Pipeline& pipeline, bool is_reg_alloc = true);
+
+    // g is compiled by the pipeline and RegAlloc, unless it is found in
+    // the cache. Returns g or a graph loaded from the cache, which is
+    // followed by its callees, in the latter case g is not changed
+    std::vector<Graph*> Compile(Graph* g);
+    // key may be computed before g is changed, e.g. by compilation of its callees
+    std::vector<Graph*> Compile(Graph* g, uint64_t key);
+
+    uint64_t GetKey(Graph* g);
+    // returns empty vector if there is no entry, or it can not be read
+    std::vector<Graph*> Load(uint64_t key, CompilationContext* context = nullptr);
+    void Store(uint64_t key, Graph* compiled);
+
+    uint64_t GetHits()
+    {
+        return hits_;
+    }
+
+    uint64_t GetMisses()
+    {
+        return misses_;
+    }
+
+private:
+    std::string GetPath(uint64_t key);
+
+    std::string dir_;
+    Pipeline pipeline_;
+    bool is_reg_alloc_ = true;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+#endif // COMPILATION_CACHE_H
@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+
+#include <sys/resource.h>
+
+#include "bounded_queue.h"
+#include "compiler_driver.h"
+#include "ir/ir_parser.h"
+#include "ir/ir_printer.h"
+#include "pass/call_graph.h"
+#include "pass/reg_alloc.h"
+
+namespace {
+
+double GetMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool StartsWith(const std::string& arg, const std::string& prefix)
+{
+    return arg.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+const char* CompilerDriver::GetUsage()
+{
+    return "usage: compiler_opts [options] <file.ir | dir>...\n"
+           "    -O0, -O1, -O2            optimization level, -O2 by default\n"
+           "    --pipeline=<passes>      pipeline description, e.g. \"inlining,[peephole,const_folding,dce]\"\n"
+           "    -o <dir>, --output-dir=<dir>\n"
+           "                             write optimized IR of every input to <dir>, instead of stdout\n"
+           "    --cache=<dir>            reuse compiled methods from the cache directory\n"
+           "    --regs=<n>               number of registers for register allocation\n"
+           "    --prefetch=<n>           number of files parsed and compiled ahead, 0 runs stages in one thread\n"
+           "    --no-regalloc            do not allocate registers\n"
+           "    --stats                  print counters of passes\n"
+           "    -q, --quiet              do not print the report\n"
+           "    -h, --help               print this message\n";
+}
+
+bool CompilerDriver::ParseOptions(int argc, const char* const* argv, DriverOptions* options, std::ostream& err)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-O0") {
+            options->pipeline_ = Pipeline::GetDescription(OptLevel::O0);
+        } else if (arg == "-O1") {
+            options->pipeline_ = Pipeline::GetDescription(OptLevel::O1);
+        } else if (arg == "-O2") {
+            options->pipeline_ = Pipeline::GetDescription(OptLevel::O2);
+        } else if (StartsWith(arg, "--pipeline=")) {
+            options->pipeline_ = arg.substr(std::string("--pipeline=").size());
+        } else if (arg == "-o") {
+            if (i + 1 == argc) {
+                err << "missing directory after -o\n";
+                return false;
+            }
+            options->output_dir_ = argv[++i];
+        } else if (StartsWith(arg, "--output-dir=")) {
+            options->output_dir_ = arg.substr(std::string("--output-dir=").size());
+        } else if (StartsWith(arg, "--cache=")) {
+            options->cache_dir_ = arg.substr(std::string("--cache=").size());
+        } else if (StartsWith(arg, "--regs=")) {
+            std::string value = arg.substr(std::string("--regs=").size());
+            char* end = nullptr;
+            unsigned long reg_count = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || reg_count > CompilationContext::MAX_REG_COUNT) {
+                err << "invalid register count: " << value << ", at most "
+                    << CompilationContext::MAX_REG_COUNT << " registers are supported\n";
+                return false;
+            }
+            options->reg_count_ = reg_count;
+        } else if (StartsWith(arg, "--prefetch=")) {
+            std::string value = arg.substr(std::string("--prefetch=").size());
+            char* end = nullptr;
+            unsigned long prefetch = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0') {
+                err << "invalid prefetch: " << value << "\n";
+                return false;
+            }
+            options->prefetch_ = prefetch;
+        } else if (arg == "--no-regalloc") {
+            options->is_reg_alloc_ = false;
+        } else if (arg == "--stats") {
+            options->is_stats_dumped_ = true;
+        } else if (arg == "-q" || arg == "--quiet") {
+            options->is_quiet_ = true;
+        } else if (arg == "-h" || arg == "--help") {
+            options->is_help_ = true;
+        } else if (StartsWith(arg, "-")) {
+            err << "unknown option: " << arg << "\n";
+            return false;
+        } else {
+            options->inputs_.push_back(arg);
+        }
+    }
+    if (options->inputs_.empty() && !options->is_help_) {
+        err << "no input files\n";
+        return false;
+    }
+    return true;
+}
+
+CompilerDriver::CompilerDriver(const DriverOptions& options, std::ostream& out)
+    : options_(options), pipeline_(Pipeline::Parse(options.pipeline_)), out_(out)
+{
+    if (!options_.cache_dir_.empty()) {
+        cache_ = std::make_unique<CompilationCache>(options_.cache_dir_, pipeline_, options_.is_reg_alloc_);
+    }
+}
+
+bool CompilerDriver::Run()
+{
+    std::vector<Input> inputs;
+    bool is_found = CollectInputs(&inputs);
+    if (!options_.output_dir_.empty()) {
+        std::filesystem::create_directories(options_.output_dir_);
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (options_.prefetch_ == 0) {
+        RunSequentially(inputs);
+    } else {
+        RunStreaming(inputs);
+    }
+    total_.wall_ms_ = GetMs(start);
+    if (!options_.is_quiet_) {
+        PrintReport("total", total_);
+        if (cache_ != nullptr) {
+            out_ << "# cache: " << cache_->GetHits() << " hits, " << cache_->GetMisses() << " misses\n";
+        }
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        out_ << "# peak RSS: " << usage.ru_maxrss << " KB\n";
+    }
+    if (options_.is_stats_dumped_) {
+        for (const auto& [name, value]: statistics_.GetCounters()) {
+            out_ << "# " << name << " " << value << "\n";
+        }
+    }
+    return is_found && !is_failed_;
+}
+
+// files of a directory are compiled in order of their paths,
+// so that output does not depend on the file system
+bool CompilerDriver::CollectInputs(std::vector<Input>* inputs)
+{
+    namespace fs = std::filesystem;
+    bool is_found = true;
+    for (const auto& path: options_.inputs_) {
+        if (fs::is_regular_file(path)) {
+            inputs->push_back({path, fs::path(path).filename().string()});
+            continue;
+        }
+        if (!fs::is_directory(path)) {
+            std::cerr << "input not found: " << path << "\n";
+            is_found = false;
+            continue;
+        }
+        std::vector<Input> dir_inputs;
+        for (const auto& entry: fs::recursive_directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ir") {
+                dir_inputs.push_back({entry.path().string(), fs::relative(entry.path(), path).string()});
+            }
+        }
+        std::sort(dir_inputs.begin(), dir_inputs.end(),
+                  [](const Input& lhs, const Input& rhs) { return lhs.path_ < rhs.path_; });
+        inputs->insert(inputs->end(), dir_inputs.begin(), dir_inputs.end());
+    }
+    return is_found;
+}
+
+void CompilerDriver::RunSequentially(const std::vector<Input>& inputs)
+{
+    for (const auto& input: inputs) {
+        std::unique_ptr<Unit> unit = ParseUnit(input);
+        CompileUnit(unit.get());
+        WriteUnit(unit.get());
+    }
+}
+
+// parsing and compilation run in threads of their own, writing in the
+// calling thread, so the cache is used by one thread, and statistics,
+// reports and output are written by another one
+void CompilerDriver::RunStreaming(const std::vector<Input>& inputs)
+{
+    BoundedQueue<std::unique_ptr<Unit>> parsed(options_.prefetch_);
+    BoundedQueue<std::unique_ptr<Unit>> compiled(options_.prefetch_);
+    std::thread parser([&]() {
+        for (const auto& input: inputs) {
+            parsed.Push(ParseUnit(input));
+        }
+        parsed.Close();
+    });
+    std::thread compiler([&]() {
+        std::unique_ptr<Unit> unit;
+        while (parsed.Pop(unit)) {
+            CompileUnit(unit.get());
+            compiled.Push(std::move(unit));
+        }
+        compiled.Close();
+    });
+    std::unique_ptr<Unit> unit;
+    while (compiled.Pop(unit)) {
+        WriteUnit(unit.get());
+        unit.reset();
+    }
+    parser.join();
+    compiler.join();
+}
+
+// methods of a file share one context, so inlined instructions keep
+// unique ids, and the context is destroyed together with the graphs
+std::unique_ptr<CompilerDriver::Unit> CompilerDriver::ParseUnit(const Input& input)
+{
+    auto unit = std::make_unique<Unit>();
+    unit->input_ = input;
+    unit->context_ = std::make_unique<CompilationContext>();
+    unit->context_->SetRegCount(options_.reg_count_);
+    Report& report = unit->report_;
+    report.files_ = 1;
+
+    auto start = std::chrono::steady_clock::now();
+    IrParser parser(unit->context_.get());
+    if (!parser.TryParseFile(input.path_, &unit->methods_)) {
+        unit->error_ = parser.GetError();
+    }
+    report.parse_ms_ = GetMs(start);
+    report.methods_ = unit->methods_.size();
+    for (auto g: unit->methods_) {
+        report.insts_ += g->GetInstsNum();
+    }
+    return unit;
+}
+
+void CompilerDriver::CompileUnit(Unit* unit)
+{
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<Graph*>& methods = unit->methods_;
+    // keys are computed before callees are compiled and inlined
+    std::unordered_map<Graph*, uint64_t> keys;
+    if (cache_ != nullptr) {
+        for (auto g: methods) {
+            keys[g] = cache_->GetKey(g);
+        }
+    }
+    std::unordered_map<std::string, Graph*> methods_by_name;
+    for (auto g: methods) {
+        methods_by_name[g->GetName()] = g;
+    }
+
+    // methods loaded from the cache replace parsed ones, callees loaded
+    // together with them are replaced by methods of the file with the same name
+    std::unordered_map<Graph*, Graph*> replacements;
+    CallGraph call_graph;
+    call_graph.Build(methods);
+    for (auto g: call_graph.GetBottomUpOrder()) {
+        RetargetCalls(g, replacements);
+        std::vector<Graph*> compiled = CompileMethod(g, keys.count(g) != 0 ? keys[g] : 0);
+        if (compiled[0] == g) {
+            continue;
+        }
+        replacements[g] = compiled[0];
+        unit->loaded_.insert(unit->loaded_.end(), compiled.begin(), compiled.end());
+        for (size_t i = 1; i < compiled.size(); i++) {
+            replacements[compiled[i]] = methods_by_name.at(compiled[i]->GetName());
+        }
+    }
+    // results of one cycle may refer to each other before replacement
+    for (auto g: methods) {
+        auto it = replacements.find(g);
+        unit->results_.push_back(it == replacements.end() ? g : it->second);
+    }
+    for (auto& [original, replacement]: replacements) {
+        auto it = replacements.find(replacement);
+        if (it != replacements.end()) {
+            replacement = it->second;
+        }
+    }
+    for (auto g: unit->results_) {
+        RetargetCalls(g, replacements);
+    }
+    unit->report_.compile_ms_ = GetMs(start);
+}
+
+void CompilerDriver::WriteUnit(Unit* unit)
+{
+    if (!unit->error_.empty()) {
+        std::cerr << unit->input_.path_ << ": " << unit->error_ << "\n";
+        is_failed_ = true;
+        return;
+    }
+    Report& report = unit->report_;
+    auto start = std::chrono::steady_clock::now();
+    IrPrinter printer;
+    printer.SetPrintLiveIntervals(true);
+    if (options_.output_dir_.empty()) {
+        printer.Print(unit->results_, out_);
+        out_ << "\n";
+    } else {
+        // unit, which can not be written, is reported, other units are written anyway
+        std::filesystem::path path = std::filesystem::path(options_.output_dir_) / unit->input_.name_;
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        std::ofstream file(path);
+        if (file) {
+            printer.Print(unit->results_, file);
+            file.close();
+        }
+        if (!file) {
+            std::cerr << "can not write " << path.string() << "\n";
+            report.failed_files_ = 1;
+            is_failed_ = true;
+        }
+    }
+    report.write_ms_ = GetMs(start);
+    report.wall_ms_ = report.parse_ms_ + report.compile_ms_ + report.write_ms_;
+
+    for (const auto& [name, value]: unit->context_->GetStatistics().GetCounters()) {
+        statistics_.Add(name, value);
+    }
+    if (!options_.is_quiet_) {
+        PrintReport(unit->input_.path_, report);
+    }
+    total_.files_ += report.files_;
+    total_.failed_files_ += report.failed_files_;
+    total_.methods_ += report.methods_;
+    total_.insts_ += report.insts_;
+    total_.parse_ms_ += report.parse_ms_;
+    total_.compile_ms_ += report.compile_ms_;
+    total_.write_ms_ += report.write_ms_;
+
+    std::unordered_set<Graph*> destroyed(unit->methods_.begin(), unit->methods_.end());
+    destroyed.insert(unit->loaded_.begin(), unit->loaded_.end());
+    for (auto g: destroyed) {
+        Graph::GraphDestroyer(g);
+    }
+    unit->methods_.clear();
+    unit->results_.clear();
+    unit->loaded_.clear();
+}
+
+std::vector<Graph*> CompilerDriver::CompileMethod(Graph* g, uint64_t key)
+{
+    if (cache_ != nullptr) {
+        return cache_->Compile(g, key);
+    }
+    pipeline_.Run(g);
+    if (options_.is_reg_alloc_) {
+        g->RunPass<RegAlloc>();
+    }
+    return {g};
+}
+
+void CompilerDriver::RetargetCalls(Graph* g, const std::unordered_map<Graph*, Graph*>& replacements)
+{
+    if (replacements.empty()) {
+        return;
+    }
+    for (auto inst: g->Insts(Opcode::CALL_STATIC)) {
+        auto it = replacements.find(inst->CastToInstCall()->GetCallee());
+        if (it != replacements.end()) {
+            inst->CastToInstCall()->SetCallee(it->second);
+        }
+    }
+}
+
+void CompilerDriver::PrintReport(const std::string& name, const Report& report)
+{
+    double insts_per_sec = report.wall_ms_ > 0 ? report.insts_ * 1000.0 / report.wall_ms_ : 0;
+    out_ << std::fixed << std::setprecision(3);
+    out_ << "# " << name << ": ";
+    if (report.files_ != 1) {
+        out_ << report.files_ << " files, ";
+    }
+    if (report.failed_files_ != 0) {
+        out_ << report.failed_files_ << " not written, ";
+    }
+    out_ << report.methods_ << " methods, " << report.insts_ << " insts, parse " << report.parse_ms_
+         << " ms, compile " << report.compile_ms_ << " ms, write " << report.write_ms_ << " ms, ";
+    if (report.files_ != 1) {
+        out_ << "wall " << report.wall_ms_ << " ms, ";
+    }
+    out_ << std::setprecision(0) << insts_per_sec << " insts/s\n";
+    out_ << std::defaultfloat;
+}
@@ -0,0 +1,116 @@
+#ifndef COMPILER_DRIVER_H
+#define COMPILER_DRIVER_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compilation_cache.h"
+#include "pass/pipeline.h"
+
+struct DriverOptions {
+    // files with textual IR and directories, which are searched for *.ir files
+    std::vector<std::string> inputs_;
+    std::string pipeline_ = Pipeline::GetDescription(OptLevel::O2);
+    // optimized IR of every input is written to a file with the same relative
+    // path, or to the output stream if the directory is not set
+    std::string output_dir_;
+    std::string cache_dir_;
+    size_t reg_count_ = CompilationContext::MAX_REG_COUNT;
+    bool is_reg_alloc_ = true;
+    // number of files, which are parsed ahead of compilation and compiled
+    // ahead of writing, stages run sequentially in one thread if it is zero
+    size_t prefetch_ = 2;
+    bool is_stats_dumped_ = false;
+    bool is_quiet_ = false;
+    bool is_help_ = false;
+};
+
+// Compiles files with textual IR in one process: methods of a file are
+// compiled bottom-up by the call graph, so callers inline optimized
+// callees, then results are written, and graphs of the file are destroyed.
+// Files are streamed through parsing, compilation and writing, which run
+// in threads of their own connected by queues of prefetch_ files, so at
+// most 2 * prefetch_ + 3 files are in memory regardless of the number of
+// inputs. Compile time and throughput are reported for every file and
+// in total, report lines start with '#', so output without output
+// directory remains valid textual IR
+class CompilerDriver
+{
+public:
+    // returns false and reports the error to err on invalid arguments
+    static bool ParseOptions(int argc, const char* const* argv, DriverOptions* options, std::ostream& err);
+    static const char* GetUsage();
+
+    CompilerDriver(const DriverOptions& options, std::ostream& out);
+
+    // returns false if some inputs are not found, can not be parsed
+    // or written, other inputs are compiled anyway
+    bool Run();
+
+    // counters of passes summed over all compiled files
+    Statistics& GetStatistics()
+    {
+        return statistics_;
+    }
+
+private:
+    struct Input {
+        std::string path_;
+        // relative to the input directory, name of the output file
+        std::string name_;
+    };
+
+    struct Report {
+        uint32_t files_ = 0;
+        // files, output of which can not be written
+        uint32_t failed_files_ = 0;
+        uint32_t methods_ = 0;
+        uint64_t insts_ = 0;
+        double parse_ms_ = 0;
+        double compile_ms_ = 0;
+        double write_ms_ = 0;
+        // time of all stages, which is less than their sum if they overlap
+        double wall_ms_ = 0;
+    };
+
+    // methods of a file, which share a context and are destroyed together
+    struct Unit {
+        Input input_;
+        std::unique_ptr<CompilationContext> context_;
+        // parsing error, unit has no methods if it is set
+        std::string error_;
+        std::vector<Graph*> methods_;
+        // results in order of methods, some of them are loaded from the cache
+        std::vector<Graph*> results_;
+        std::vector<Graph*> loaded_;
+        Report report_;
+    };
+
+    bool CollectInputs(std::vector<Input>* inputs);
+    void RunSequentially(const std::vector<Input>& inputs);
+    void RunStreaming(const std::vector<Input>& inputs);
+    std::unique_ptr<Unit> ParseUnit(const Input& input);
+    void CompileUnit(Unit* unit);
+    // writes results, adds the report and destroys graphs of unit,
+    // reports the error instead if unit is not parsed
+    void WriteUnit(Unit* unit);
+    // returns graph with the result followed by graphs, which are loaded
+    // together with it from the cache, the result differs from g on cache hits
+    std::vector<Graph*> CompileMethod(Graph* g, uint64_t key);
+    static void RetargetCalls(Graph* g, const std::unordered_map<Graph*, Graph*>& replacements);
+    void PrintReport(const std::string& name, const Report& report);
+
+    DriverOptions options_;
+    Pipeline pipeline_;
+    std::unique_ptr<CompilationCache> cache_;
+    std::ostream& out_;
+    Statistics statistics_;
+    Report total_;
+    bool is_failed_ = false;
+};
+
+#endif // COMPILER_DRIVER_H
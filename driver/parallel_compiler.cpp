@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+#include "parallel_compiler.h"
+#include "pass/pipeline.h"
+
+void ParallelCompiler::Compile(const std::vector<Graph*>& graphs)
+{
+    call_graph_.Build(graphs);
+    uint32_t components_num = call_graph_.GetComponentsNum();
+    components_.assign(components_num, {});
+    callers_.assign(components_num, {});
+    pending_callees_ = std::vector<std::atomic<uint32_t>>(components_num);
+
+    std::unordered_map<CompilationContext*, uint32_t> context_owners;
+    for (auto g: call_graph_.GetBottomUpOrder()) {
+        uint32_t id = call_graph_.GetComponentId(g);
+        components_[id].push_back(g);
+        [[maybe_unused]] auto owner = context_owners.emplace(g->GetContext(), id).first;
+        assert(owner->second == id);
+    }
+    for (uint32_t id = 0; id < components_num; ++id) {
+        std::vector<uint32_t> callees;
+        for (auto g: components_[id]) {
+            for (auto callee: call_graph_.GetCallees(g)) {
+                uint32_t callee_id = call_graph_.GetComponentId(callee);
+                if (callee_id != id && std::find(callees.begin(), callees.end(), callee_id) == callees.end()) {
+                    callees.push_back(callee_id);
+                    callers_[callee_id].push_back(id);
+                }
+            }
+        }
+        pending_callees_[id] = callees.size();
+    }
+
+    // leaves are collected before the first submit, since
+    // finished tasks start decrementing pending_callees_ at once
+    std::vector<uint32_t> leaves;
+    for (uint32_t id = 0; id < components_num; ++id) {
+        if (pending_callees_[id] == 0) {
+            leaves.push_back(id);
+        }
+    }
+    for (auto id: leaves) {
+        pool_.Submit([this, id]() { CompileComponent(id); });
+    }
+    pool_.Wait();
+}
+
+void ParallelCompiler::CompileComponent(uint32_t component_id)
+{
+    for (auto g: components_[component_id]) {
+        pipeline_(g);
+    }
+    for (auto caller_id: callers_[component_id]) {
+        if (--pending_callees_[caller_id] == 0) {
+            pool_.Submit([this, caller_id]() { CompileComponent(caller_id); });
+        }
+    }
+}
+
+void ParallelCompiler::RunDefaultPipeline(Graph* g)
+{
+    static const ::Pipeline pipeline = ::Pipeline::Create(OptLevel::O2);
+    pipeline.Run(g);
+}
@@ -0,0 +1,41 @@
+#ifndef PARALLEL_COMPILER_H
+#define PARALLEL_COMPILER_H
+
+#include <atomic>
+#include <functional>
+
+#include "pass/call_graph.h"
+#include "thread_pool.h"
+
+// Runs the pipeline on many graphs in parallel. Graphs are independent
+// except for calls: inlining reads callees, so a graph is compiled only
+// after all its callees, and graphs calling each other are compiled
+// sequentially by one task. Graphs compiled in parallel must not share
+// a compilation context
+class ParallelCompiler {
+public:
+    using Pipeline = std::function<void(Graph*)>;
+
+    explicit ParallelCompiler(size_t threads_num, Pipeline pipeline = RunDefaultPipeline)
+        : pool_(threads_num), pipeline_(std::move(pipeline)) {}
+
+    // compiles graphs together with all graphs called from them
+    void Compile(const std::vector<Graph*>& graphs);
+
+    // runs Pipeline for OptLevel::O2
+    static void RunDefaultPipeline(Graph* g);
+
+private:
+    void CompileComponent(uint32_t component_id);
+
+    ThreadPool pool_;
+    Pipeline pipeline_;
+    CallGraph call_graph_;
+
+    std::vector<std::vector<Graph*>> components_;
+    std::vector<std::vector<uint32_t>> callers_;
+    // number of callee components, which are not compiled yet
+    std::vector<std::atomic<uint32_t>> pending_callees_;
+};
+
+#endif // PARALLEL_COMPILER_H
@@ -0,0 +1,104 @@
+#include <cassert>
+
+#include "thread_pool.h"
+
+namespace {
+// index of the worker running on the current thread
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads_num)
+{
+    assert(threads_num > 0);
+    for (size_t i = 0; i < threads_num; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads_num; ++i) {
+        threads_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopped_ = true;
+    }
+    has_tasks_.notify_all();
+    for (auto& thread: threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(Task task)
+{
+    size_t index = current_pool == this ? current_worker : next_worker_++ % workers_.size();
+    pending_tasks_++;
+    queued_tasks_++;
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex_);
+        workers_[index]->tasks_.push_back(std::move(task));
+    }
+    // taking the lock orders this notification after a check of a sleeping worker
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    has_tasks_.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    all_done_.wait(lock, [this]() { return pending_tasks_ == 0; });
+}
+
+void ThreadPool::WorkerLoop(size_t index)
+{
+    current_pool = this;
+    current_worker = index;
+    while (true) {
+        Task task;
+        if (PopTask(index, task) || StealTask(index, task)) {
+            queued_tasks_--;
+            task();
+            if (--pending_tasks_ == 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                all_done_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        has_tasks_.wait(lock, [this]() { return is_stopped_ || queued_tasks_ > 0; });
+        if (is_stopped_ && queued_tasks_ == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::PopTask(size_t index, Task& task)
+{
+    std::lock_guard<std::mutex> lock(workers_[index]->mutex_);
+    if (workers_[index]->tasks_.empty()) {
+        return false;
+    }
+    task = std::move(workers_[index]->tasks_.back());
+    workers_[index]->tasks_.pop_back();
+    return true;
+}
+
+bool ThreadPool::StealTask(size_t index, Task& task)
+{
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        Worker& victim = *workers_[(index + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex_);
+        if (!victim.tasks_.empty()) {
+            task = std::move(victim.tasks_.front());
+            victim.tasks_.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it takes tasks
+// from the back of its own deque and steals from the front of others'.
+// Tasks submitted from a worker go to its own deque, so dependent work
+// stays on the thread which produced it
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t threads_num);
+    ~ThreadPool();
+
+    void Submit(Task task);
+    // blocks until all submitted tasks, including the ones
+    // submitted by other tasks, are finished
+    void Wait();
+
+    size_t GetThreadsNum()
+    {
+        return threads_.size();
+    }
+
+private:
+    struct Worker {
+        std::deque<Task> tasks_;
+        std::mutex mutex_;
+    };
+
+    void WorkerLoop(size_t index);
+    bool PopTask(size_t index, Task& task);
+    bool StealTask(size_t index, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    // tasks lying in deques and tasks not finished yet
+    std::atomic<size_t> queued_tasks_ = 0;
+    std::atomic<size_t> pending_tasks_ = 0;
+    std::atomic<size_t> next_worker_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable has_tasks_;
+    std::condition_variable all_done_;
+    bool is_stopped_ = false;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,59 @@
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump pointer allocator, memory is released all at once together with
+// the arena. Destructors of allocated objects are never called, so only
+// trivially destructible objects may be placed here
+class ArenaAllocator
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    ArenaAllocator() = default;
+    ArenaAllocator(const ArenaAllocator&) = delete;
+    ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        uintptr_t aligned = (cur_ + align - 1) & ~(align - 1);
+        if (chunks_.empty() || aligned + size > end_) {
+            // big objects get a chunk of their own
+            size_t chunk_size = std::max(CHUNK_SIZE, size + align);
+            chunks_.push_back(std::make_unique<uint8_t[]>(chunk_size));
+            cur_ = reinterpret_cast<uintptr_t>(chunks_.back().get());
+            end_ = cur_ + chunk_size;
+            aligned = (cur_ + align - 1) & ~(align - 1);
+        }
+        cur_ = aligned + size;
+        allocated_size_ += size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return new (Allocate(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+    }
+
+    size_t GetAllocatedSize()
+    {
+        return allocated_size_;
+    }
+
+private:
+    std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+    uintptr_t cur_ = 0;
+    uintptr_t end_ = 0;
+    size_t allocated_size_ = 0;
+};
+
+#endif // ARENA_ALLOCATOR_H
@@ -4,10 +4,8 @@
 void BasicBlock::BasicBlockDestroyer(BasicBlock* bb)
 {
     assert(bb != nullptr);
-    for (Inst* item = bb->GetFirstInst(); item != nullptr;) {
-        Inst* curr = item;
-        item = item->GetNext();
-        delete curr;
+    for (auto item: bb->InstsSafe()) {
+        Inst::InstDestroyer(item);
     }
 
     delete bb;
@@ -29,7 +27,7 @@ void BasicBlock::Dump()
     }
     std::cout << "]\n";
 
-    for (Inst* item = first_inst_; item != nullptr; item = item->GetNext()) {
+    for (auto item: Insts()) {
         item->Dump();
     }
 }
@@ -8,6 +8,7 @@
 #include <variant>
 
 #include "inst.h"
+#include "inst_range.h"
 #include "marker.h"
 
 class Graph;
@@ -16,13 +17,7 @@ class Loop;
 class BasicBlock : public Markers
 {
   public:
-    BasicBlock(uint32_t bb_id) : id_(bb_id)
-    {
-        if (next_id_ < bb_id) {
-            next_id_ = bb_id;
-        }
-        next_id_++;
-    }
+    BasicBlock(uint32_t bb_id) : id_(bb_id) {}
     static void BasicBlockDestroyer(BasicBlock* bb);
 
     void PushBackInst(Inst* inst)
@@ -32,6 +27,8 @@ class BasicBlock : public Markers
         inst->SetBB(this);
         if (last_inst_ != nullptr)
             last_inst_->SetNext(inst);
+        else
+            first_inst_ = inst;
         last_inst_ = inst;
         size_++;
     }
@@ -43,6 +40,8 @@ class BasicBlock : public Markers
         inst->SetBB(this);
         if (first_inst_ != nullptr)
             first_inst_->SetPrev(inst);
+        else
+            last_inst_ = inst;
         first_inst_ = inst;
         size_++;
     }
@@ -50,32 +49,24 @@ class BasicBlock : public Markers
     // TODO fix pop instructions
     void PopFrontInst()
     {
-        delete first_inst_;
+        Inst::InstDestroyer(first_inst_);
         size_--;
     }
 
     void PopBackInst()
     {
-        delete last_inst_;
+        Inst::InstDestroyer(last_inst_);
         size_--;
     }
 
     void UnbindFrontInst()
     {
-        first_inst_->GetNext()->SetPrev(nullptr);
-        auto next_first = first_inst_->GetNext();
-        first_inst_->SetNext(nullptr);
-        first_inst_ = next_first;
-        size_--;
+        UnbindInst(first_inst_);
     }
 
     void UnbindBackInst()
     {
-        last_inst_->GetPrev()->SetNext(nullptr);
-        auto next_last = last_inst_->GetPrev();
-        last_inst_->SetPrev(nullptr);
-        last_inst_ = next_last;
-        size_--;
+        UnbindInst(last_inst_);
     }
 
     // inserts inst before reference_inst
@@ -84,13 +75,51 @@ class BasicBlock : public Markers
         assert(inst->GetPrev() == nullptr);
         assert(inst->GetNext() == nullptr);
         inst->SetPrev(reference_inst->GetPrev());
-        reference_inst->GetPrev()->SetNext(inst);
+        if (reference_inst->GetPrev() != nullptr) {
+            reference_inst->GetPrev()->SetNext(inst);
+        } else {
+            first_inst_ = inst;
+        }
         inst->SetNext(reference_inst);
         reference_inst->SetPrev(inst);
         inst->SetBB(this);
         size_++;
     }
 
+    // inserts inst after phis at the beginning of the block
+    void InsertAfterPhis(Inst* inst)
+    {
+        Inst* first_non_phi = first_inst_;
+        while (first_non_phi != nullptr && first_non_phi->GetOpcode() == Opcode::PHI) {
+            first_non_phi = first_non_phi->GetNext();
+        }
+        if (first_non_phi != nullptr) {
+            InsertInst(first_non_phi, inst);
+        } else {
+            PushBackInst(inst);
+        }
+    }
+
+    // unlinks inst from the block without destroying it
+    void UnbindInst(Inst* inst)
+    {
+        assert(inst->GetBB() == this);
+        if (inst->GetPrev() != nullptr) {
+            inst->GetPrev()->SetNext(inst->GetNext());
+        } else {
+            first_inst_ = inst->GetNext();
+        }
+        if (inst->GetNext() != nullptr) {
+            inst->GetNext()->SetPrev(inst->GetPrev());
+        } else {
+            last_inst_ = inst->GetPrev();
+        }
+        inst->SetPrev(nullptr);
+        inst->SetNext(nullptr);
+        inst->SetBB(nullptr);
+        size_--;
+    }
+
     bool IsFirstBB()
     {
         assert(graph_ != nullptr);
@@ -105,10 +134,10 @@ class BasicBlock : public Markers
 
     bool HasInst(Inst* inst)
     {
-        for (auto item = first_inst_; item != nullptr; item = item->GetNext()) {
+        for (auto item: Insts()) {
             if (item == inst) {
                 return true;
-            } 
+            }
         }
         return false;
     }
@@ -117,16 +146,48 @@ class BasicBlock : public Markers
 
     Inst* GetInstById(uint32_t id)
     {
-        for (auto item = first_inst_; item != nullptr; item = item->GetNext()) {
+        for (auto item: Insts()) {
             if (item->GetId() == id) {
                 return item;
-            } 
+            }
         }
         return nullptr;
     }
 
     void Dump();
 
+    // ranges of instructions, safe ones allow to unlink or delete the visited instruction
+    InstRange<> Insts()
+    {
+        return InstRange<>(first_inst_);
+    }
+
+    InstRange<AnyInst, false, true> InstsSafe()
+    {
+        return InstRange<AnyInst, false, true>(first_inst_);
+    }
+
+    InstRange<AnyInst, true> InstsReverse()
+    {
+        return InstRange<AnyInst, true>(last_inst_);
+    }
+
+    InstRange<AnyInst, true, true> InstsSafeReverse()
+    {
+        return InstRange<AnyInst, true, true>(last_inst_);
+    }
+
+    InstRange<InstWithOpcode> Insts(Opcode opcode)
+    {
+        return InstRange<InstWithOpcode>(first_inst_, {opcode});
+    }
+
+    // visits phis only, not the whole block
+    InstRange<PhiInsts> Phis()
+    {
+        return InstRange<PhiInsts>(first_inst_);
+    }
+
     ACCESSOR_MUTATOR(first_inst_, FirstInst, Inst*)
     ACCESSOR_MUTATOR(last_inst_, LastInst, Inst*)
     ACCESSOR_MUTATOR(graph_, Graph, Graph*)
@@ -189,11 +250,6 @@ class BasicBlock : public Markers
         dominators_.push_back(bb);
     }
 
-    static uint32_t NextId()
-    {
-        return next_id_;
-    }
-
     static const uint32_t FALSE_BRANCH_INDEX = 1;
     static const uint32_t TRUE_BRANCH_INDEX = 0;
   private:
@@ -214,8 +270,6 @@ class BasicBlock : public Markers
 
     uint32_t id_ = 0;
     uint32_t size_ = 0;
-    
-    static inline uint32_t next_id_ = 0;
 };
 
 #endif // BASIC_BLOCK_H
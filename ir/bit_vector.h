@@ -0,0 +1,120 @@
+#ifndef BIT_VECTOR_H
+#define BIT_VECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// set of dense indices, e.g. linear numbers of instructions
+class BitVector
+{
+public:
+    BitVector() = default;
+    explicit BitVector(size_t size) : size_(size), words_((size + WORD_BITS - 1) / WORD_BITS) {}
+
+    size_t GetSize() const
+    {
+        return size_;
+    }
+
+    void Set(size_t index)
+    {
+        assert(index < size_);
+        words_[index / WORD_BITS] |= uint64_t{1} << (index % WORD_BITS);
+    }
+
+    void Reset(size_t index)
+    {
+        assert(index < size_);
+        words_[index / WORD_BITS] &= ~(uint64_t{1} << (index % WORD_BITS));
+    }
+
+    bool Test(size_t index) const
+    {
+        assert(index < size_);
+        return (words_[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+    }
+
+    void SetAll()
+    {
+        for (auto& word: words_) {
+            word = ~uint64_t{0};
+        }
+        // bits past the size are kept clear, so that equal sets compare equal
+        if (size_ % WORD_BITS != 0) {
+            words_.back() &= (uint64_t{1} << (size_ % WORD_BITS)) - 1;
+        }
+    }
+
+    void ResetAll()
+    {
+        for (auto& word: words_) {
+            word = 0;
+        }
+    }
+
+    void Union(const BitVector& other)
+    {
+        assert(size_ == other.size_);
+        for (size_t i = 0; i < words_.size(); i++) {
+            words_[i] |= other.words_[i];
+        }
+    }
+
+    void Intersect(const BitVector& other)
+    {
+        assert(size_ == other.size_);
+        for (size_t i = 0; i < words_.size(); i++) {
+            words_[i] &= other.words_[i];
+        }
+    }
+
+    // this = gen | (in & ~kill), returns true if this was changed
+    bool Transfer(const BitVector& in, const BitVector& gen, const BitVector& kill)
+    {
+        assert(size_ == in.size_ && size_ == gen.size_ && size_ == kill.size_);
+        bool is_changed = false;
+        for (size_t i = 0; i < words_.size(); i++) {
+            uint64_t word = gen.words_[i] | (in.words_[i] & ~kill.words_[i]);
+            is_changed |= word != words_[i];
+            words_[i] = word;
+        }
+        return is_changed;
+    }
+
+    bool IsEmpty() const
+    {
+        return std::all_of(words_.begin(), words_.end(), [](uint64_t word) { return word == 0; });
+    }
+
+    bool operator==(const BitVector& other) const
+    {
+        return size_ == other.size_ && words_ == other.words_;
+    }
+
+    bool operator!=(const BitVector& other) const
+    {
+        return !(*this == other);
+    }
+
+    // calls func for indices of set bits in ascending order
+    template <typename Func>
+    void ForEach(Func func) const
+    {
+        for (size_t i = 0; i < words_.size(); i++) {
+            for (uint64_t word = words_[i]; word != 0; word &= word - 1) {
+                func(i * WORD_BITS + __builtin_ctzll(word));
+            }
+        }
+    }
+
+private:
+    static constexpr size_t WORD_BITS = 64;
+
+    size_t size_ = 0;
+    std::vector<uint64_t> words_;
+};
+
+#endif // BIT_VECTOR_H
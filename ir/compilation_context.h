@@ -0,0 +1,162 @@
+#ifndef COMPILATION_CONTEXT_H
+#define COMPILATION_CONTEXT_H
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include "arena_allocator.h"
+#include "pass_profiler.h"
+#include "utils.h"
+
+class IdGenerator
+{
+public:
+    uint32_t NewId()
+    {
+        return next_id_++;
+    }
+
+    // reserves count consecutive ids, returns the first one
+    uint32_t Reserve(uint32_t count)
+    {
+        uint32_t first_id = next_id_;
+        next_id_ += count;
+        return first_id;
+    }
+
+    // makes id taken, so that it is never generated
+    void Skip(uint32_t id)
+    {
+        next_id_ = std::max(next_id_, id + 1);
+    }
+
+    ACCESSOR_MUTATOR(next_id_, NextId, uint32_t)
+
+private:
+    uint32_t next_id_ = 0;
+};
+
+// named counters, which are filled by passes, names are prefixed
+// with the pass name, e.g. "DCE.RemovedInsts"
+class Statistics
+{
+public:
+    void Add(const std::string& name, uint64_t value = 1)
+    {
+        counters_[name] += value;
+    }
+
+    uint64_t Get(const std::string& name)
+    {
+        auto it = counters_.find(name);
+        return it == counters_.end() ? 0 : it->second;
+    }
+
+    const std::map<std::string, uint64_t>& GetCounters()
+    {
+        return counters_;
+    }
+
+    void Dump(std::ostream& out)
+    {
+        for (const auto& [name, value]: counters_) {
+            out << name << " " << value << "\n";
+        }
+    }
+
+    void Clear()
+    {
+        counters_.clear();
+    }
+
+private:
+    std::map<std::string, uint64_t> counters_;
+};
+
+// checks of graph consistency after every pass, which changes graph:
+// CHEAP checks are linear in the size of graph, FULL ones also check
+// dominance and users, see GraphVerifier
+enum class VerifyLevel {
+    OFF,
+    CHEAP,
+    FULL,
+};
+
+// State of one compilation: id generators, target configuration, arena
+// for analyses data, statistics and pass profile. Graphs of one context share id spaces,
+// so instructions may move between them, e.g. by inlining. Context is not
+// thread safe, graphs compiled in parallel must have different contexts
+class CallGraph;
+
+class CompilationContext
+{
+public:
+    static constexpr size_t MAX_REG_COUNT = 31;
+
+    CompilationContext() = default;
+    CompilationContext(const CompilationContext&) = delete;
+    CompilationContext& operator=(const CompilationContext&) = delete;
+
+    IdGenerator& GetInstIds()
+    {
+        return inst_ids_;
+    }
+
+    IdGenerator& GetBBIds()
+    {
+        return bb_ids_;
+    }
+
+    ArenaAllocator& GetArena()
+    {
+        return arena_;
+    }
+
+    Statistics& GetStatistics()
+    {
+        return statistics_;
+    }
+
+    PassProfiler& GetPassProfiler()
+    {
+        return pass_profiler_;
+    }
+
+    // number of registers available for register allocation
+    size_t GetRegCount()
+    {
+        return reg_count_;
+    }
+
+    void SetRegCount(size_t reg_count)
+    {
+        assert(reg_count <= MAX_REG_COUNT);
+        reg_count_ = reg_count;
+    }
+
+    // FULL in debug builds, so that tests check every pass, CHEAP otherwise
+    ACCESSOR_MUTATOR(verify_level_, VerifyLevel, VerifyLevel)
+
+    // call graph of the unit, which is being inlined by InliningDriver,
+    // so that Inlining does not build it for every graph
+    ACCESSOR_MUTATOR(call_graph_, CallGraph, CallGraph*)
+
+private:
+    IdGenerator inst_ids_;
+    IdGenerator bb_ids_;
+    ArenaAllocator arena_;
+    Statistics statistics_;
+    PassProfiler pass_profiler_;
+    size_t reg_count_ = MAX_REG_COUNT;
+    CallGraph* call_graph_ = nullptr;
+#ifdef NDEBUG
+    VerifyLevel verify_level_ = VerifyLevel::CHEAP;
+#else
+    VerifyLevel verify_level_ = VerifyLevel::FULL;
+#endif
+};
+
+#endif // COMPILATION_CONTEXT_H
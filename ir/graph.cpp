@@ -19,6 +19,15 @@ BasicBlock* Graph::GetBBbyId(uint32_t id)
     }
     return nullptr;
 }
+uint32_t Graph::GetInstsNum()
+{
+    uint32_t insts_num = 0;
+    for (auto bb: basic_blocks_) {
+        insts_num += bb->GetSize();
+    }
+    return insts_num;
+}
+
 Inst* Graph::GetInstById(uint32_t id)
 {
     Inst* result = nullptr;
@@ -31,6 +40,21 @@ Inst* Graph::GetInstById(uint32_t id)
     return result;
 }
 
+marker Graph::NewMarker()
+{
+    if (!HasCleanSlot()) {
+        uint32_t dirty_slots = GetDirtySlots();
+        for (auto bb: basic_blocks_) {
+            bb->ResetSlots(dirty_slots);
+            for (auto inst: bb->Insts()) {
+                inst->ResetSlots(dirty_slots);
+            }
+        }
+        SetSlotsCleared();
+    }
+    return MarkerManager::NewMarker();
+}
+
 Graph::~Graph()
 {
     delete root_loop_;
@@ -41,7 +65,7 @@ void Graph::GraphDestroyer(Graph *g)
     for (auto item : g->basic_blocks_) {
         BasicBlock::BasicBlockDestroyer(item);
     }
-    delete g->root_loop_;
+    // root loop is deleted by the destructor
     delete g;
 }
 
@@ -75,6 +99,15 @@ void Graph::AddBasicBlock(BasicBlock* bb)
     assert(bb->GetGraph() == nullptr);
     bb->SetGraph(this);
     basic_blocks_.push_back(bb);
+    UpdateNextIds(bb);
+}
+
+void Graph::UpdateNextIds(BasicBlock* bb)
+{
+    context_->GetBBIds().Skip(bb->GetId());
+    for (auto inst: bb->Insts()) {
+        context_->GetInstIds().Skip(inst->GetId());
+    }
 }
 
 void Graph::Clear()
@@ -2,29 +2,120 @@
 #define GRAPH_H
 
 #include <bitset>
+#include <memory>
+#include <string>
+#include <unordered_map>
 
 #include "basic_block.h"
+#include "compilation_context.h"
 #include "marker.h"
 #include "loop.h"
 #include "pass/pass_manager.h"
 #include "liveness_info.h"
 
+// Iterator over instructions of all blocks in order of Graph::GetBasicBlocks()
+template <typename Filter>
+class GraphInstIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Inst*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Inst**;
+    using reference = Inst*;
+
+    GraphInstIterator() = default;
+    GraphInstIterator(const std::vector<BasicBlock*>* bbs, Filter filter) : bbs_(bbs), filter_(filter)
+    {
+        SeekBlock();
+    }
+
+    Inst* operator*() const
+    {
+        return *inst_;
+    }
+
+    GraphInstIterator& operator++()
+    {
+        ++inst_;
+        if (inst_ == InstIterator<Filter, false, false>()) {
+            bb_index_++;
+            SeekBlock();
+        }
+        return *this;
+    }
+
+    bool operator==(const GraphInstIterator& other) const
+    {
+        return inst_ == other.inst_;
+    }
+
+    bool operator!=(const GraphInstIterator& other) const
+    {
+        return inst_ != other.inst_;
+    }
+
+private:
+    // moves to the first visited instruction of blocks starting from the current one
+    void SeekBlock()
+    {
+        for (; bb_index_ < bbs_->size(); bb_index_++) {
+            inst_ = InstIterator<Filter, false, false>((*bbs_)[bb_index_]->GetFirstInst(), filter_);
+            if (inst_ != InstIterator<Filter, false, false>()) {
+                return;
+            }
+        }
+    }
+
+    const std::vector<BasicBlock*>* bbs_ = nullptr;
+    size_t bb_index_ = 0;
+    InstIterator<Filter, false, false> inst_;
+    Filter filter_ {};
+};
+
+template <typename Filter = AnyInst>
+class GraphInstRange
+{
+public:
+    GraphInstRange(const std::vector<BasicBlock*>* bbs, Filter filter = {}) : bbs_(bbs), filter_(filter) {}
+
+    GraphInstIterator<Filter> begin() const
+    {
+        return GraphInstIterator<Filter>(bbs_, filter_);
+    }
+
+    GraphInstIterator<Filter> end() const
+    {
+        return GraphInstIterator<Filter>();
+    }
+
+private:
+    const std::vector<BasicBlock*>* bbs_;
+    Filter filter_;
+};
+
 class Graph : public PassManager, public MarkerManager
 {
   public:
-    Graph(std::initializer_list<BasicBlock*> bbs) : basic_blocks_(bbs) {}
+    // graph without context gets a context of its own
+    Graph(std::initializer_list<BasicBlock*> bbs, CompilationContext* context = nullptr) :
+        basic_blocks_(bbs), context_(context)
+    {
+        if (context_ == nullptr) {
+            owned_context_ = std::make_unique<CompilationContext>();
+            context_ = owned_context_.get();
+        }
+        for (auto bb: basic_blocks_) {
+            UpdateNextIds(bb);
+        }
+    }
 
     ~Graph();
     static void GraphDestroyer(Graph *g);
     
+    // returns false if the pass was not run or did not change graph
     template <typename Pass>
-    void RunPass();
-
-    template <typename Pass>
-    bool IsPassValid();
-
-    template <typename Pass>
-    void SetPassValidity(bool is_valid);
+    bool RunPass();
 
     // Check that prob_dominator dominates prob_dominated
     bool CheckDominance(BasicBlock *prob_dominator, BasicBlock *prob_dominated);
@@ -34,10 +125,20 @@ class Graph : public PassManager, public MarkerManager
     BasicBlock *GetBBbyId(uint32_t id);
     Inst* GetInstById(uint32_t id);
 
+    // hides MarkerManager::NewMarker, since a slot of an erased marker
+    // is reused only after it is cleared in blocks and instructions
+    marker NewMarker();
+
     ACCESSOR_MUTATOR(basic_blocks_, BasicBlocks, const std::vector<BasicBlock*>&)
     ACCESSOR_MUTATOR(rpo_basic_blocks_, RPOBasicBlocks, std::vector<BasicBlock*>)
     ACCESSOR_MUTATOR(linear_order_, LinearOrder, std::vector<BasicBlock*>)
     ACCESSOR_MUTATOR(root_loop_, RootLoop, Loop*)
+    // deepest nesting of callees inlined into this graph
+    ACCESSOR_MUTATOR(inline_depth_, InlineDepth, uint32_t)
+    // instructions inlined into this graph by all runs of Inlining, see Inlining::INLINE_BUDGET
+    ACCESSOR_MUTATOR(inlined_size_, InlinedSize, uint32_t)
+    // name of the method in textual IR, callees are referred by it
+    ACCESSOR_MUTATOR(name_, Name, const std::string&)
 
     std::unordered_map<Inst*, LiveInterval*>& GetLiveIntervals()
     {
@@ -51,36 +152,64 @@ class Graph : public PassManager, public MarkerManager
 
     void AddBasicBlock(BasicBlock* bb);
 
+    // instructions of all blocks, blocks must not be added during iteration
+    GraphInstRange<> Insts()
+    {
+        return GraphInstRange<>(&basic_blocks_);
+    }
+
+    GraphInstRange<InstWithOpcode> Insts(Opcode opcode)
+    {
+        return GraphInstRange<InstWithOpcode>(&basic_blocks_, {opcode});
+    }
+
+    GraphInstRange<PhiInsts> Phis()
+    {
+        return GraphInstRange<PhiInsts>(&basic_blocks_);
+    }
+
+    uint32_t GetInstsNum();
+
+    CompilationContext* GetContext()
+    {
+        return context_;
+    }
+
+    // ids are unique within the context of a graph
+    uint32_t NewInstId()
+    {
+        return context_->GetInstIds().NewId();
+    }
+
+    uint32_t NewBBId()
+    {
+        return context_->GetBBIds().NewId();
+    }
+
     void Clear();
 
     void Dump();
 
   private:
+    void UpdateNextIds(BasicBlock* bb);
+
     std::vector<BasicBlock*> basic_blocks_;
     std::vector<BasicBlock*> rpo_basic_blocks_;
     std::vector<BasicBlock*> linear_order_;
     std::unordered_map<Inst*, LiveInterval*> live_intervals_;
     Loop* root_loop_ = nullptr;
+    uint32_t inline_depth_ = 0;
+    uint32_t inlined_size_ = 0;
+    std::string name_;
 
-    std::bitset<std::tuple_size_v<PassList>> pass_validity_;
+    CompilationContext* context_ = nullptr;
+    std::unique_ptr<CompilationContext> owned_context_;
 };
 
 template <typename Pass>
-void Graph::RunPass()
-{
-    PassManager::RunPass<Pass>(this);
-}
-
-template <typename Pass>
-bool Graph::IsPassValid()
-{
-    return pass_validity_[GetPassIndex<Pass>()];
-}
-
-template <typename Pass>
-void Graph::SetPassValidity(bool is_valid)
+bool Graph::RunPass()
 {
-    pass_validity_[GetPassIndex<Pass>()] = is_valid;
+    return PassManager::RunPass<Pass>(this);
 }
 
 #endif // GRAPH_H
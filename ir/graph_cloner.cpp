@@ -0,0 +1,116 @@
+#include "graph_cloner.h"
+
+Graph* GraphCloner::CloneGraph(Graph* src, CompilationContext* context)
+{
+    bb_map_.clear();
+    inst_map_.clear();
+    inst_id_offset_ = 0;
+    bb_id_offset_ = 0;
+    if (context != nullptr) {
+        // context of source may be shared with other graphs, e.g. with the caller,
+        // so only ids used by source are reserved
+        uint32_t max_inst_id = 0;
+        uint32_t max_bb_id = 0;
+        for (auto src_bb: src->GetBasicBlocks()) {
+            max_bb_id = std::max(max_bb_id, src_bb->GetId());
+            for (auto src_inst: src_bb->Insts()) {
+                max_inst_id = std::max(max_inst_id, src_inst->GetId());
+            }
+        }
+        inst_id_offset_ = context->GetInstIds().Reserve(max_inst_id + 1);
+        bb_id_offset_ = context->GetBBIds().Reserve(max_bb_id + 1);
+    }
+
+    Graph* dst = new Graph({}, context);
+    CloneBlocks(src, dst);
+    CloneInsts(src);
+    if (context == nullptr) {
+        // instructions are pushed after blocks are added to the copy,
+        // so their ids are not taken by its context yet
+        dst->GetContext()->GetInstIds().SetNextId(src->GetContext()->GetInstIds().GetNextId());
+        dst->GetContext()->GetBBIds().SetNextId(src->GetContext()->GetBBIds().GetNextId());
+        dst->GetContext()->SetRegCount(src->GetContext()->GetRegCount());
+    }
+    return dst;
+}
+
+void GraphCloner::CloneBlocks(Graph* src, Graph* dst)
+{
+    for (auto src_bb: src->GetBasicBlocks()) {
+        BasicBlock* dst_bb = new BasicBlock(src_bb->GetId() + bb_id_offset_);
+        bb_map_[src_bb] = dst_bb;
+        dst->AddBasicBlock(dst_bb);
+    }
+
+    for (auto src_bb: src->GetBasicBlocks()) {
+        BasicBlock* dst_bb = bb_map_[src_bb];
+        for (auto pred: src_bb->GetPreds()) {
+            dst_bb->AddPred(bb_map_.at(pred));
+        }
+        for (auto succ: src_bb->GetSuccs()) {
+            dst_bb->AddSucc(bb_map_.at(succ));
+        }
+    }
+}
+
+// all instructions are created before inputs are resolved,
+// since phis may refer to instructions defined later
+void GraphCloner::CloneInsts(Graph* src)
+{
+    for (auto src_bb: src->GetBasicBlocks()) {
+        for (auto src_inst: src_bb->Insts()) {
+            Inst* dst_inst = Inst::InstBuilder(src_inst->GetOpcode(), src_inst->GetId() + inst_id_offset_);
+            inst_map_[src_inst] = dst_inst;
+            bb_map_[src_bb]->PushBackInst(dst_inst);
+        }
+    }
+
+    for (auto item: inst_map_) {
+        CloneInputs(item.first, item.second);
+        CloneUsers(item.first, item.second);
+    }
+}
+
+void GraphCloner::CloneInputs(Inst* src_inst, Inst* dst_inst)
+{
+    std::vector<Inst*> inputs;
+    inputs.reserve(src_inst->GetInputCount());
+    for (auto input: src_inst->GetInputs()) {
+        inputs.push_back(inst_map_.at(input));
+    }
+    dst_inst->SetInputs(inputs);
+
+    switch (src_inst->GetType())
+    {
+    case Type::InstPhi: {
+        std::vector<BasicBlock*> input_bbs;
+        for (auto bb: src_inst->CastToInstPhi()->GetInputBB()) {
+            input_bbs.push_back(bb_map_.at(bb));
+        }
+        dst_inst->CastToInstPhi()->SetInputBB(input_bbs);
+        break;
+    }
+    case Type::InstConstant: {
+        dst_inst->CastToInstConstant()->SetConstant(src_inst->CastToInstConstant()->GetConstant());
+        break;
+    }
+    case Type::InstCall: {
+        dst_inst->CastToInstCall()->SetCallee(src_inst->CastToInstCall()->GetCallee());
+        break;
+    }
+    case Type::InstJmp: {
+        dst_inst->CastToInstJmp()->SetTargetBB(bb_map_.at(src_inst->CastToInstJmp()->GetTargetBB()));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// users are copied in the same order as in source instruction
+void GraphCloner::CloneUsers(Inst* src_inst, Inst* dst_inst)
+{
+    for (auto user: src_inst->GetUsers()) {
+        dst_inst->AddUser(inst_map_.at(user));
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef GRAPH_CLONER_H
+#define GRAPH_CLONER_H
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "graph.h"
+
+// Creates a deep copy of graph: blocks with their preds and succs,
+// instructions with inputs, phi inputs and users. Analyses results
+// (dominators, loops, linear order, live intervals) are not copied.
+// Copy is created in the given context, e.g. the context of a graph the copy
+// is going to be merged into. Ids up to the largest id of source are reserved
+// there, so ids of the copy are unique and keep relative order. Without context the copy gets a context of its
+// own and the same ids as the source
+class GraphCloner
+{
+public:
+    Graph* CloneGraph(Graph* src, CompilationContext* context = nullptr);
+
+    Inst* GetClonedInst(Inst* src_inst)
+    {
+        return inst_map_.at(src_inst);
+    }
+
+    BasicBlock* GetClonedBB(BasicBlock* src_bb)
+    {
+        return bb_map_.at(src_bb);
+    }
+
+private:
+    void CloneBlocks(Graph* src, Graph* dst);
+    void CloneInsts(Graph* src);
+    void CloneInputs(Inst* src_inst, Inst* dst_inst);
+    void CloneUsers(Inst* src_inst, Inst* dst_inst);
+
+    std::unordered_map<BasicBlock*, BasicBlock*> bb_map_;
+    std::unordered_map<Inst*, Inst*> inst_map_;
+
+    uint32_t inst_id_offset_ = 0;
+    uint32_t bb_id_offset_ = 0;
+};
+
+#endif // GRAPH_CLONER_H
@@ -0,0 +1,78 @@
+#include "graph_hasher.h"
+
+uint64_t GraphHasher::Hash(Graph* g)
+{
+    auto it = hashes_.find(g);
+    if (it != hashes_.end()) {
+        return it->second;
+    }
+    Accumulator hash;
+    hash.Add(g->GetName());
+    // recursive calls of g get this hash
+    hashes_[g] = hash.Get();
+
+    hash.Add(g->GetInlineDepth());
+    hash.Add(g->GetInlinedSize());
+    hash.Add(g->GetValidPasses());
+    for (auto bb: g->GetBasicBlocks()) {
+        hash.Add(bb->GetId());
+        hash.Add(bb->GetPreds().size());
+        for (auto pred: bb->GetPreds()) {
+            hash.Add(pred->GetId());
+        }
+        hash.Add(bb->GetSuccs().size());
+        for (auto succ: bb->GetSuccs()) {
+            hash.Add(succ->GetId());
+        }
+        hash.Add(bb->GetSize());
+        for (auto inst: bb->Insts()) {
+            HashInst(inst, hash);
+        }
+    }
+    hashes_[g] = hash.Get();
+    return hash.Get();
+}
+
+void GraphHasher::HashInst(Inst* inst, Accumulator& hash)
+{
+    hash.Add(inst->GetId());
+    hash.Add(static_cast<uint64_t>(inst->GetOpcode()));
+    switch (inst->GetType()) {
+    case Type::InstWithTwoInputs:
+        hash.Add(inst->CastToInstWithTwoInputs()->GetInput1()->GetId());
+        hash.Add(inst->CastToInstWithTwoInputs()->GetInput2()->GetId());
+        break;
+    case Type::InstWithOneInput:
+        hash.Add(inst->CastToInstWithOneInput()->GetInput1()->GetId());
+        break;
+    case Type::InstPhi: {
+        const auto& input_insts = inst->CastToInstPhi()->GetInputInst();
+        const auto& input_bbs = inst->CastToInstPhi()->GetInputBB();
+        hash.Add(input_insts.size());
+        for (size_t i = 0; i < input_insts.size(); ++i) {
+            hash.Add(input_insts[i]->GetId());
+            hash.Add(input_bbs[i]->GetId());
+        }
+        break;
+    }
+    case Type::InstCall:
+        hash.Add(Hash(inst->CastToInstCall()->GetCallee()));
+        hash.Add(inst->CastToInstCall()->GetArguments().size());
+        for (auto argument: inst->CastToInstCall()->GetArguments()) {
+            hash.Add(argument->GetId());
+        }
+        break;
+    case Type::InstJmp:
+        hash.Add(inst->CastToInstJmp()->GetTargetBB()->GetId());
+        break;
+    case Type::InstConstant:
+        hash.Add(static_cast<uint64_t>(inst->CastToInstConstant()->GetConstant()));
+        break;
+    default:
+        break;
+    }
+    hash.Add(inst->GetUsers().size());
+    for (auto user: inst->GetUsers()) {
+        hash.Add(user->GetId());
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef GRAPH_HASHER_H
+#define GRAPH_HASHER_H
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "graph.h"
+
+// Structural hash of graph, which is stable between runs and hosts.
+// It depends on everything, which may change results of compilation:
+// ids, opcodes, operands, users, CFG, name, validity of passes and
+// hashes of callees. Recursive callees are represented by their names.
+// Hashes are memoized, so a hasher must not outlive changes of graphs
+class GraphHasher
+{
+public:
+    uint64_t Hash(Graph* g);
+
+    // FNV-1a over 64-bit values with a final mix
+    class Accumulator
+    {
+    public:
+        void Add(uint64_t value)
+        {
+            hash_ = (hash_ ^ value) * 0x100000001b3ULL;
+        }
+
+        void Add(std::string_view text)
+        {
+            Add(text.size());
+            for (char c: text) {
+                Add(static_cast<uint8_t>(c));
+            }
+        }
+
+        uint64_t Get() const
+        {
+            uint64_t hash = hash_;
+            hash = (hash ^ (hash >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+            hash = (hash ^ (hash >> 27U)) * 0x94d049bb133111ebULL;
+            return hash ^ (hash >> 31U);
+        }
+
+    private:
+        uint64_t hash_ = 0xcbf29ce484222325ULL;
+    };
+
+private:
+    void HashInst(Inst* inst, Accumulator& hash);
+
+    // of graphs, which are hashed or being hashed
+    std::unordered_map<Graph*, uint64_t> hashes_;
+};
+
+#endif // GRAPH_HASHER_H
@@ -0,0 +1,348 @@
+#include <algorithm>
+
+#include "graph_verifier.h"
+
+bool GraphVerifier::Verify(Graph* g)
+{
+    errors_.clear();
+    insts_.clear();
+    positions_.clear();
+    sorted_users_.clear();
+    if (g->GetBasicBlocks().empty()) {
+        errors_.push_back("graph has no blocks");
+        return false;
+    }
+
+    bb_marker_ = g->NewMarker();
+    inst_marker_ = g->NewMarker();
+    for (auto bb: g->GetBasicBlocks()) {
+        if (bb->IsMarked(bb_marker_)) {
+            Error(bb, "is listed in graph twice");
+            continue;
+        }
+        bb->SetMarker(bb_marker_);
+        if (bb->GetGraph() != g) {
+            Error(bb, "belongs to another graph");
+        }
+        for (auto inst: bb->Insts()) {
+            if (inst->IsMarked(inst_marker_)) {
+                Error(inst, "is listed twice");
+                break;
+            }
+            inst->SetMarker(inst_marker_);
+        }
+    }
+    // instructions are checked after all of them are marked, so that
+    // inputs defined in later blocks are found
+    if (errors_.empty()) {
+        for (auto bb: g->GetBasicBlocks()) {
+            VerifyBasicBlock(bb);
+        }
+    }
+    g->EraseMarker(inst_marker_);
+    g->EraseMarker(bb_marker_);
+
+    if (level_ == VerifyLevel::FULL && errors_.empty()) {
+        for (auto bb: g->GetBasicBlocks()) {
+            uint32_t position = 0;
+            for (auto inst: bb->Insts()) {
+                insts_.insert(inst);
+                positions_[inst] = position++;
+            }
+        }
+        for (auto inst: insts_) {
+            VerifyUsers(inst);
+        }
+        if (errors_.empty()) {
+            VerifyDominance(g);
+        }
+    }
+    return errors_.empty();
+}
+
+void GraphVerifier::VerifyBasicBlock(BasicBlock* bb)
+{
+    uint32_t size = 0;
+    bool is_phi_allowed = true;
+    Inst* prev = nullptr;
+    for (auto inst: bb->Insts()) {
+        size++;
+        if (inst->GetPrev() != prev) {
+            Error(inst, "has wrong previous instruction");
+        }
+        if (inst->GetBB() != bb) {
+            Error(inst, "refers to another block");
+        }
+        if (inst->GetType() == Type::InstPhi) {
+            if (!is_phi_allowed) {
+                Error(inst, "is a phi after other instructions");
+            }
+            VerifyPhi(inst->CastToInstPhi(), bb);
+        } else {
+            is_phi_allowed = false;
+        }
+        VerifyInputs(inst);
+        Opcode opcode = inst->GetOpcode();
+        bool is_terminator = inst->GetType() == Type::InstJmp || opcode == Opcode::RET ||
+                             opcode == Opcode::RET_VOID || opcode == Opcode::THROW;
+        if (is_terminator && inst->GetNext() != nullptr) {
+            Error(inst, "terminates block, but is followed by other instructions");
+        }
+        prev = inst;
+    }
+    if (bb->GetLastInst() != prev) {
+        Error(bb, "has wrong last instruction");
+    }
+    if (bb->GetSize() != size) {
+        Error(bb, "has size " + std::to_string(bb->GetSize()) + ", but " + std::to_string(size) + " instructions");
+    }
+
+    for (auto succ: bb->GetSuccs()) {
+        if (!succ->IsMarked(bb_marker_)) {
+            Error(bb, "has successor bb" + std::to_string(succ->GetId()) + ", which is not in graph");
+            continue;
+        }
+        const auto& succ_preds = succ->GetPreds();
+        if (std::count(succ_preds.begin(), succ_preds.end(), bb) !=
+            std::count(bb->GetSuccs().begin(), bb->GetSuccs().end(), succ)) {
+            Error(bb, "is not a predecessor of its successor bb" + std::to_string(succ->GetId()));
+        }
+    }
+    for (auto pred: bb->GetPreds()) {
+        if (!pred->IsMarked(bb_marker_)) {
+            Error(bb, "has predecessor bb" + std::to_string(pred->GetId()) + ", which is not in graph");
+            continue;
+        }
+        const auto& pred_succs = pred->GetSuccs();
+        if (std::count(pred_succs.begin(), pred_succs.end(), bb) !=
+            std::count(bb->GetPreds().begin(), bb->GetPreds().end(), pred)) {
+            Error(bb, "is not a successor of its predecessor bb" + std::to_string(pred->GetId()));
+        }
+    }
+    VerifyTermination(bb);
+}
+
+// blocks without a terminating instruction fall through to their only
+// successor, blocks without successors may end with any instruction.
+// Throw may have a successor, which handles it
+void GraphVerifier::VerifyTermination(BasicBlock* bb)
+{
+    const auto& succs = bb->GetSuccs();
+    Inst* last = bb->GetLastInst();
+    if (succs.size() > 2) {
+        Error(bb, "has more than two successors");
+        return;
+    }
+    if (last == nullptr) {
+        if (succs.size() == 2) {
+            Error(bb, "has two successors, but no conditional jump");
+        }
+        return;
+    }
+    if (last->GetType() == Type::InstJmp) {
+        BasicBlock* target = last->CastToInstJmp()->GetTargetBB();
+        size_t expected_succs = last->GetOpcode() == Opcode::JMP ? 1 : 2;
+        if (succs.size() != expected_succs) {
+            Error(last, "is a jump, but its block has " + std::to_string(succs.size()) + " successors");
+        } else if (std::find(succs.begin(), succs.end(), target) == succs.end()) {
+            Error(last, "jumps to a block, which is not a successor");
+        }
+    } else if (last->GetOpcode() == Opcode::RET || last->GetOpcode() == Opcode::RET_VOID) {
+        if (!succs.empty()) {
+            Error(last, "leaves method, but its block has successors");
+        }
+    } else if (succs.size() == 2) {
+        Error(bb, "has two successors, but no conditional jump");
+    }
+}
+
+void GraphVerifier::VerifyInputs(Inst* inst)
+{
+    auto verify_input = [this, inst](Inst* input) {
+        if (input == nullptr) {
+            Error(inst, "has no input");
+            return;
+        }
+        if (!input->IsMarked(inst_marker_)) {
+            Error(inst, "has input v" + std::to_string(input->GetId()) + ", which is not in graph");
+            return;
+        }
+        if (!IsUser(input, inst)) {
+            Error(inst, "is not a user of its input v" + std::to_string(input->GetId()));
+        }
+    };
+
+    for (auto input: inst->GetInputs()) {
+        verify_input(input);
+    }
+}
+
+// phi inputs coming from the same value along several edges are merged,
+// so a phi may have fewer inputs than its block has predecessors
+void GraphVerifier::VerifyPhi(InstPhi* phi, BasicBlock* bb)
+{
+    const auto& input_bbs = phi->GetInputBB();
+    const auto& preds = bb->GetPreds();
+    if (input_bbs.size() != phi->GetInputInst().size()) {
+        Error(phi, "has " + std::to_string(phi->GetInputInst().size()) + " inputs, but " +
+                       std::to_string(input_bbs.size()) + " input blocks");
+    }
+    if (input_bbs.size() > preds.size()) {
+        Error(phi, "has more inputs than its block has predecessors");
+    }
+    for (auto input_bb: input_bbs) {
+        if (std::find(preds.begin(), preds.end(), input_bb) == preds.end()) {
+            Error(phi, "has input from bb" + std::to_string(input_bb->GetId()) + ", which is not a predecessor");
+        }
+    }
+}
+
+// users of instructions with many users, e.g. parameters, are sorted
+// once and searched, so that checks do not become quadratic
+bool GraphVerifier::IsUser(Inst* inst, Inst* user)
+{
+    const auto& users = inst->GetUsers();
+    if (users.size() <= MAX_SCANNED_USERS) {
+        return std::find(users.begin(), users.end(), user) != users.end();
+    }
+    auto [it, is_inserted] = sorted_users_.try_emplace(inst);
+    if (is_inserted) {
+        it->second.assign(users.begin(), users.end());
+        std::sort(it->second.begin(), it->second.end());
+    }
+    return std::binary_search(it->second.begin(), it->second.end(), user);
+}
+
+void GraphVerifier::VerifyUsers(Inst* inst)
+{
+    for (auto user: inst->GetUsers()) {
+        // user is not dereferenced, unless it is in graph, since it may be deleted
+        if (insts_.count(user) == 0) {
+            Error(inst, "has user, which is not in graph");
+            continue;
+        }
+        auto inputs = user->GetInputs();
+        bool is_input = std::find(inputs.begin(), inputs.end(), inst) != inputs.end();
+        if (!is_input) {
+            Error(inst, "has user v" + std::to_string(user->GetId()) + ", which does not use it");
+        }
+    }
+}
+
+void GraphVerifier::VerifyDominance(Graph* g)
+{
+    ComputeDominators(g);
+    for (auto bb: rpo_) {
+        for (auto inst: bb->Insts()) {
+            if (inst->GetType() != Type::InstPhi) {
+                for (auto input: inst->GetInputs()) {
+                    VerifyDominance(input, inst, bb);
+                }
+                continue;
+            }
+            // input is used at the end of the predecessor
+            auto phi = inst->CastToInstPhi();
+            for (size_t i = 0; i < phi->GetInputInst().size(); i++) {
+                VerifyDominance(phi->GetInputInst()[i], nullptr, phi->GetInputBB()[i]);
+            }
+        }
+    }
+}
+
+// user is nullptr for uses at the end of use_bb
+void GraphVerifier::VerifyDominance(Inst* def, Inst* user, BasicBlock* use_bb)
+{
+    BasicBlock* def_bb = def->GetBB();
+    if (rpo_numbers_.count(use_bb) == 0) {
+        return;
+    }
+    bool is_dominated = def_bb == use_bb ? user == nullptr || positions_[def] < positions_[user]
+                                         : rpo_numbers_.count(def_bb) != 0 && Dominates(def_bb, use_bb);
+    if (!is_dominated) {
+        Error(def, "does not dominate its use in bb" + std::to_string(use_bb->GetId()));
+    }
+}
+
+// iterative algorithm by Cooper, Harvey and Kennedy over reverse post order
+void GraphVerifier::ComputeDominators(Graph* g)
+{
+    rpo_.clear();
+    rpo_numbers_.clear();
+    idoms_.clear();
+
+    std::vector<BasicBlock*> post_order;
+    std::unordered_set<BasicBlock*> visited;
+    std::vector<std::pair<BasicBlock*, size_t>> stack = {{g->GetBasicBlocks()[0], 0}};
+    visited.insert(g->GetBasicBlocks()[0]);
+    while (!stack.empty()) {
+        auto& [bb, succ_index] = stack.back();
+        if (succ_index == bb->GetSuccs().size()) {
+            post_order.push_back(bb);
+            stack.pop_back();
+            continue;
+        }
+        BasicBlock* succ = bb->GetSuccs()[succ_index++];
+        if (visited.insert(succ).second) {
+            stack.push_back({succ, 0});
+        }
+    }
+    rpo_.assign(post_order.rbegin(), post_order.rend());
+    for (uint32_t i = 0; i < rpo_.size(); i++) {
+        rpo_numbers_[rpo_[i]] = i;
+    }
+
+    constexpr uint32_t UNDEFINED = UINT32_MAX;
+    idoms_.assign(rpo_.size(), UNDEFINED);
+    idoms_[0] = 0;
+    bool is_changed = true;
+    while (is_changed) {
+        is_changed = false;
+        for (uint32_t i = 1; i < rpo_.size(); i++) {
+            uint32_t new_idom = UNDEFINED;
+            for (auto pred: rpo_[i]->GetPreds()) {
+                auto it = rpo_numbers_.find(pred);
+                if (it == rpo_numbers_.end() || idoms_[it->second] == UNDEFINED) {
+                    continue;
+                }
+                uint32_t other = it->second;
+                if (new_idom == UNDEFINED) {
+                    new_idom = other;
+                    continue;
+                }
+                while (new_idom != other) {
+                    while (new_idom > other) {
+                        new_idom = idoms_[new_idom];
+                    }
+                    while (other > new_idom) {
+                        other = idoms_[other];
+                    }
+                }
+            }
+            if (idoms_[i] != new_idom) {
+                idoms_[i] = new_idom;
+                is_changed = true;
+            }
+        }
+    }
+}
+
+bool GraphVerifier::Dominates(BasicBlock* dominator, BasicBlock* bb)
+{
+    uint32_t dominator_number = rpo_numbers_.at(dominator);
+    uint32_t number = rpo_numbers_.at(bb);
+    while (number > dominator_number) {
+        number = idoms_[number];
+    }
+    return number == dominator_number;
+}
+
+void GraphVerifier::Error(Inst* inst, const std::string& msg)
+{
+    std::string location = inst->GetBB() != nullptr ? "bb" + std::to_string(inst->GetBB()->GetId()) + ": " : "";
+    errors_.push_back(location + "v" + std::to_string(inst->GetId()) + " " + msg);
+}
+
+void GraphVerifier::Error(BasicBlock* bb, const std::string& msg)
+{
+    errors_.push_back("bb" + std::to_string(bb->GetId()) + " " + msg);
+}
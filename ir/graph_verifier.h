@@ -0,0 +1,69 @@
+#ifndef GRAPH_VERIFIER_H
+#define GRAPH_VERIFIER_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "graph.h"
+
+// Checks consistency of graph. Cheap checks are linear in the size of graph
+// and assume that all pointers refer to live objects:
+//     - blocks belong to graph, lists of instructions are well linked
+//       and their sizes match
+//     - predecessors and successors are symmetric
+//     - jumps, returns and throws terminate blocks, blocks with two
+//       successors end with a conditional jump, jump targets are successors
+//     - phis precede other instructions, their input blocks are predecessors
+//     - inputs are in graph and have their users
+// Full checks also find users, which are not in graph or do not use the
+// instruction, and check that definitions dominate uses in reachable blocks.
+// Dominators are computed by the verifier, so results of passes are not used
+class GraphVerifier
+{
+public:
+    explicit GraphVerifier(VerifyLevel level = VerifyLevel::FULL) : level_(level) {}
+
+    // returns false if graph is inconsistent, errors describe the problems
+    bool Verify(Graph* g);
+
+    const std::vector<std::string>& GetErrors()
+    {
+        return errors_;
+    }
+
+private:
+    void VerifyBasicBlock(BasicBlock* bb);
+    void VerifyTermination(BasicBlock* bb);
+    void VerifyInputs(Inst* inst);
+    void VerifyPhi(InstPhi* phi, BasicBlock* bb);
+    void VerifyUsers(Inst* inst);
+    bool IsUser(Inst* inst, Inst* user);
+    void VerifyDominance(Graph* g);
+    void VerifyDominance(Inst* def, Inst* user, BasicBlock* use_bb);
+
+    void ComputeDominators(Graph* g);
+    bool Dominates(BasicBlock* dominator, BasicBlock* bb);
+
+    void Error(Inst* inst, const std::string& msg);
+    void Error(BasicBlock* bb, const std::string& msg);
+
+    VerifyLevel level_;
+    std::vector<std::string> errors_;
+    marker bb_marker_ = 0;
+    marker inst_marker_ = 0;
+
+    static constexpr size_t MAX_SCANNED_USERS = 16;
+    std::unordered_map<Inst*, std::vector<Inst*>> sorted_users_;
+
+    std::unordered_set<Inst*> insts_;
+    // position of instruction in its block
+    std::unordered_map<Inst*, uint32_t> positions_;
+    // reachable blocks in reverse post order and their immediate dominators
+    std::vector<BasicBlock*> rpo_;
+    std::unordered_map<BasicBlock*, uint32_t> rpo_numbers_;
+    std::vector<uint32_t> idoms_;
+};
+
+#endif // GRAPH_VERIFIER_H
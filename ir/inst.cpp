@@ -1,8 +1,98 @@
+#include <array>
+#include <type_traits>
+
 #include "inst.h"
 #include "basic_block.h"
 #include "graph.h"
 
+namespace {
+
+template <typename T>
+void DumpAs(Inst* inst)
+{
+    static_cast<T*>(inst)->Dump();
+}
+
+template <typename T>
+void DestroyAs(Inst* inst)
+{
+    delete static_cast<T*>(inst);
+}
+
+static_assert(!std::is_polymorphic_v<Inst>);
+
+constexpr size_t OPCODES_NUM = static_cast<size_t>(Opcode::SIZE);
+
+#define BUILD_DISPATCH_TABLE(name, type) DumpAs<type>,
+constexpr std::array<void (*)(Inst*), OPCODES_NUM> DUMP_TABLE {OPCODE_LIST(BUILD_DISPATCH_TABLE)};
+#undef BUILD_DISPATCH_TABLE
+
+#define BUILD_DISPATCH_TABLE(name, type) DestroyAs<type>,
+constexpr std::array<void (*)(Inst*), OPCODES_NUM> DESTROY_TABLE {OPCODE_LIST(BUILD_DISPATCH_TABLE)};
+#undef BUILD_DISPATCH_TABLE
+
+}  // namespace
+
 void Inst::Dump()
+{
+    DUMP_TABLE[static_cast<size_t>(opcode_)](this);
+}
+
+void Inst::SubstituteInput(Inst* old_input, Inst* new_input)
+{
+    bool is_found = false;
+    for (auto& input: GetInputs()) {
+        if (input == old_input) {
+            input = new_input;
+            is_found = true;
+        }
+    }
+    assert(is_found);
+}
+
+void Inst::SetInputs(const std::vector<Inst*>& inputs)
+{
+    ReserveInputs(inputs.size());
+    std::copy(inputs.begin(), inputs.end(), GetInputsData());
+    inputs_num_ = inputs.size();
+}
+
+void Inst::AppendInput(Inst* input)
+{
+    if (inputs_num_ == inputs_capacity_) {
+        ReserveInputs(2 * inputs_capacity_);
+    }
+    GetInputsData()[inputs_num_++] = input;
+}
+
+void Inst::RemoveInput(uint32_t index)
+{
+    assert(index < inputs_num_);
+    Inst** inputs = GetInputsData();
+    inputs[index] = inputs[inputs_num_ - 1];
+    inputs_num_--;
+}
+
+void Inst::ReserveInputs(uint32_t capacity)
+{
+    if (capacity <= inputs_capacity_) {
+        return;
+    }
+    auto new_inputs = new Inst*[capacity];
+    std::copy_n(GetInputsData(), inputs_num_, new_inputs);
+    if (inputs_capacity_ > INLINE_INPUTS_NUM) {
+        delete[] heap_inputs_;
+    }
+    heap_inputs_ = new_inputs;
+    inputs_capacity_ = capacity;
+}
+
+void Inst::InstDestroyer(Inst* inst)
+{
+    DESTROY_TABLE[static_cast<size_t>(inst->GetOpcode())](inst);
+}
+
+void Inst::DumpHeader()
 {
     if (bb_ != nullptr) {
         std::cout << bb_->GetId();
@@ -22,8 +112,26 @@ void Inst::Dump()
 #undef PRINT_OPCODE
 }
 
+Inst* Inst::InstBuilder(Opcode opcode, uint32_t ins_id)
+{
+#define BUILD_INST(name, type)                                                                                         \
+    case Opcode::name:                                                                                                 \
+        return InstBuilder<Opcode::name>(ins_id);
+
+    switch (opcode) {
+        OPCODE_LIST(BUILD_INST)
+    default:
+        UNREACHABLE()
+        return nullptr;
+    }
+#undef BUILD_INST
+}
+
 Inst::~Inst()
 {
+    if (inputs_capacity_ > INLINE_INPUTS_NUM) {
+        delete[] heap_inputs_;
+    }
     if (GetPrev() != nullptr)
         GetPrev()->SetNext(GetNext());
     if (GetNext() != nullptr)
@@ -50,31 +158,31 @@ bool Inst::IsEndInst()
 
 void InstWithTwoInputs::Dump()
 {
-    Inst::Dump();
-    std::cout << input1_->GetId() << " " << input2_->GetId() << " -> ";
+    Inst::DumpHeader();
+    std::cout << GetInput1()->GetId() << " " << GetInput2()->GetId() << " -> ";
     Inst::DumpUsers();
     std::cout << "\n";
 }
 
 void InstWithOneInput::Dump()
 {
-    Inst::Dump();
-    std::cout << input1_->GetId() << " -> ";
+    Inst::DumpHeader();
+    std::cout << GetInput1()->GetId() << " -> ";
     Inst::DumpUsers();
     std::cout << "\n";
 }
 
 void InstJmp::Dump()
 {
-    Inst::Dump();
+    Inst::DumpHeader();
     std::cout << target_bb_->GetId() << "\n";
 }
 
 void InstPhi::Dump()
 {
-    Inst::Dump();
-    for (int i = 0; i < input_inst_.size(); ++i) {
-        std::cout << "(" << input_inst_[i]->GetId() << ", " << input_bb_[i]->GetId() << ") ";
+    Inst::DumpHeader();
+    for (uint32_t i = 0; i < GetInputCount(); ++i) {
+        std::cout << "(" << GetInput(i)->GetId() << ", " << input_bb_[i]->GetId() << ") ";
     }
     std::cout << "-> ";
     Inst::DumpUsers();
@@ -83,7 +191,7 @@ void InstPhi::Dump()
 
 void InstConstant::Dump()
 {
-    Inst::Dump();
+    Inst::DumpHeader();
     std::cout << constant_ << " -> ";
     Inst::DumpUsers();
     std::cout << "\n";
@@ -91,9 +199,9 @@ void InstConstant::Dump()
 
 void InstCall::Dump()
 {
-    Inst::Dump();
+    Inst::DumpHeader();
     std::cout << "( ";
-    for (auto&& item: arguments_) {
+    for (auto item: GetInputs()) {
         std::cout << item->GetId() << ", ";
     }
     std::cout << ")";
@@ -103,39 +211,11 @@ void InstCall::Dump()
 
 void InstWithNoInputs::Dump()
 {
-    Inst::Dump();
+    Inst::DumpHeader();
     Inst::DumpUsers();
     std::cout << "\n";
 }
 
-void InstWithTwoInputs::SubstituteInput(Inst* old_input, Inst* new_input)
-{
-    assert(input1_ == old_input || input2_ == old_input);
-    if (input1_ == old_input) {
-        input1_ = new_input;
-    } else {
-        input2_ = new_input;
-    }
-}
-
-void InstWithOneInput::SubstituteInput(Inst* old_input, Inst* new_input)
-{
-    assert(input1_ == old_input);
-    input1_ = new_input;
-}
-
-void InstPhi::SubstituteInput(Inst* old_input, Inst* new_input)
-{
-    for (int i = 0; i < input_inst_.size(); ++i) {
-        if (input_inst_[i] == old_input) {
-            input_inst_[i] = new_input;
-            input_bb_[i] = new_input->GetBB();
-            return;
-        }
-    }
-    UNREACHABLE()
-}
-
 #define CAST_DEFINE_METHOD(Type)                                        \
 Type* Inst::CastTo##Type()                                              \
 {                                                                       \
@@ -143,4 +223,4 @@ Type* Inst::CastTo##Type()                                              \
 }
 
     TYPE_LIST(CAST_DEFINE_METHOD)
-#undef CAST_METHOD
+#undef CAST_DEFINE_METHOD
@@ -11,6 +11,7 @@
 #include <vector>
 #include <algorithm>
 
+#include "inst_allocator.h"
 #include "opcode.h"
 #include "utils.h"
 #include "marker.h"
@@ -25,11 +26,18 @@ class Type;
     TYPE_LIST(FORWARD_DECLARATION)
 #undef FORWARD_DECLARATION
 
+// Instructions have no virtual functions: methods, which depend on the type
+// of instruction, are dispatched through tables indexed by opcode, so that
+// instructions have no vtable pointer. Instructions are destroyed by
+// InstDestroyer, which deletes them as objects of their types
 class Inst : public Markers
 {
   public:
     template <Opcode opcode>
     static Inst* InstBuilder(uint32_t ins_id);
+    // for opcodes known only at runtime
+    static Inst* InstBuilder(Opcode opcode, uint32_t ins_id);
+    static void InstDestroyer(Inst* inst);
 
     ACCESSOR_MUTATOR(next_, Next, Inst*)
     ACCESSOR_MUTATOR(prev_, Prev, Inst*)
@@ -43,16 +51,45 @@ class Inst : public Markers
 
     bool IsStartInst();
     bool IsEndInst();
-    virtual void Dump();
-    virtual void SubstituteInput(Inst* old_input, Inst* new_input)
-    {}
+    void Dump();
+    // users are unique, so all uses of old_input are replaced at once
+    void SubstituteInput(Inst* old_input, Inst* new_input);
 
-    // TODO rule of 5?
-    ~Inst();
+    // inputs of all types of instructions, phi inputs are in order of their input blocks
+    Span<Inst*> GetInputs()
+    {
+        return Span<Inst*>(GetInputsData(), inputs_num_);
+    }
 
-    static uint32_t NextId()
+    uint32_t GetInputCount()
     {
-        return next_id_;
+        return inputs_num_;
+    }
+
+    Inst* GetInput(uint32_t index)
+    {
+        assert(index < inputs_num_);
+        return GetInputsData()[index];
+    }
+
+    void SetInput(uint32_t index, Inst* input)
+    {
+        assert(index < inputs_num_);
+        GetInputsData()[index] = input;
+    }
+
+    // users of inputs are not changed
+    void SetInputs(const std::vector<Inst*>& inputs);
+
+    // instructions of a graph are placed close to each other, see InstAllocator
+    static void* operator new(size_t size)
+    {
+        return InstAllocator::Allocate(size);
+    }
+
+    static void operator delete(void* ptr)
+    {
+        InstAllocator::Free(ptr);
     }
 
     void AddUser(Inst* user)
@@ -65,22 +102,38 @@ class Inst : public Markers
     void RemoveUser(Inst* user)
     {
         auto it = std::find(users_.begin(), users_.end(), user);
+        assert(it != users_.end());
         *it = users_.back();
         users_.pop_back();
     }
 
+    bool HasUser(Inst* user)
+    {
+        return std::find(users_.begin(), users_.end(), user) != users_.end();
+    }
+
 #define CAST_DECLARE_METHOD(Type)                                                   \
     Type* CastTo##Type();                                                    \
 
     TYPE_LIST(CAST_DECLARE_METHOD)
-#undef CAST_METHOD
+#undef CAST_DECLARE_METHOD
 
   protected:
-    Inst() = default;
-    Inst(Inst& inst) = default;
-    Inst(uint32_t id, Opcode op, Type type) : id_(id), opcode_(op), type_(type)
+    Inst(uint32_t id, Opcode op, Type type, uint32_t inputs_num = 0) :
+        id_(id), opcode_(op), type_(type), inputs_num_(inputs_num)
     {
+        assert(inputs_num <= INLINE_INPUTS_NUM);
     }
+    Inst(const Inst&) = delete;
+    Inst& operator=(const Inst&) = delete;
+    // unlinks instruction from its block
+    ~Inst();
+
+    void AppendInput(Inst* input);
+    // the last input takes place of the removed one
+    void RemoveInput(uint32_t index);
+
+    void DumpHeader();
 
     void DumpUsers()
     {
@@ -92,6 +145,17 @@ class Inst : public Markers
     }
 
   private:
+    // instructions with fixed inputs keep them in place, phis and calls
+    // move them to the heap, when they have more inputs
+    static constexpr uint32_t INLINE_INPUTS_NUM = 2;
+
+    Inst** GetInputsData()
+    {
+        return inputs_capacity_ <= INLINE_INPUTS_NUM ? inline_inputs_ : heap_inputs_;
+    }
+
+    void ReserveInputs(uint32_t capacity);
+
     uint32_t id_ = 0;
     BasicBlock* bb_ = nullptr;
     Opcode opcode_ = Opcode::DEFAULT;
@@ -104,37 +168,58 @@ class Inst : public Markers
     Inst* next_ = nullptr;
     Inst* prev_ = nullptr;
 
-    static inline uint32_t next_id_ = 0;
+    union {
+        Inst* inline_inputs_[INLINE_INPUTS_NUM] = {};
+        Inst** heap_inputs_;
+    };
+    uint32_t inputs_num_ = 0;
+    uint32_t inputs_capacity_ = INLINE_INPUTS_NUM;
 };
 
 class InstWithTwoInputs : public Inst
 {
   public:
-    InstWithTwoInputs(uint32_t id, Opcode opcode) : Inst(id, opcode, Type::InstWithTwoInputs) {}
+    InstWithTwoInputs(uint32_t id, Opcode opcode) : Inst(id, opcode, Type::InstWithTwoInputs, 2) {}
+
+    Inst* GetInput1()
+    {
+        return GetInput(0);
+    }
 
-    ACCESSOR_MUTATOR(input1_, Input1, Inst*)
-    ACCESSOR_MUTATOR(input2_, Input2, Inst*)
+    void SetInput1(Inst* input)
+    {
+        SetInput(0, input);
+    }
 
-    void Dump() override;
-    void SubstituteInput(Inst* old_input, Inst* new_input) override;
+    Inst* GetInput2()
+    {
+        return GetInput(1);
+    }
 
-  private:
-    Inst* input1_ = nullptr;
-    Inst* input2_ = nullptr;
+    void SetInput2(Inst* input)
+    {
+        SetInput(1, input);
+    }
+
+    void Dump();
 };
 
 class InstWithOneInput : public Inst
 {
   public:
-    InstWithOneInput(uint32_t id, Opcode opcode) : Inst(id, opcode, Type::InstWithOneInput) {}
+    InstWithOneInput(uint32_t id, Opcode opcode) : Inst(id, opcode, Type::InstWithOneInput, 1) {}
 
-    ACCESSOR_MUTATOR(input1_, Input1, Inst*)
+    Inst* GetInput1()
+    {
+        return GetInput(0);
+    }
 
-    void Dump() override;
-    void SubstituteInput(Inst* old_input, Inst* new_input) override;
+    void SetInput1(Inst* input)
+    {
+        SetInput(0, input);
+    }
 
-  private:
-    Inst* input1_ = nullptr;
+    void Dump();
 };
 
 class InstWithNoInputs : public Inst
@@ -143,7 +228,7 @@ class InstWithNoInputs : public Inst
     InstWithNoInputs(uint32_t id, Opcode opcode) : Inst(id, opcode, Type::InstWithNoInputs)
     {}
     
-    void Dump() override;
+    void Dump();
 };
 
 class InstJmp : public Inst
@@ -153,7 +238,7 @@ class InstJmp : public Inst
 
     ACCESSOR_MUTATOR(target_bb_, TargetBB, BasicBlock*)
 
-    void Dump() override;
+    void Dump();
 
   private:
     BasicBlock* target_bb_ = nullptr;
@@ -164,33 +249,39 @@ class InstPhi : public Inst
   public:
     InstPhi(uint32_t id, Opcode opcode) : Inst(id, opcode, Type::InstPhi) {}
 
-    ACCESSOR_MUTATOR(input_inst_, InputInst, const std::vector<Inst*>&)
+    Span<Inst*> GetInputInst()
+    {
+        return GetInputs();
+    }
+
+    void SetInputInst(const std::vector<Inst*>& input_inst)
+    {
+        SetInputs(input_inst);
+    }
+
     ACCESSOR_MUTATOR(input_bb_, InputBB, const std::vector<BasicBlock*>&)
 
     void AddInput(Inst* inst, BasicBlock* bb)
     {
-        if (std::find(input_inst_.begin(), input_inst_.end(), inst) == input_inst_.end()) {
-            input_inst_.push_back(inst);
+        auto inputs = GetInputs();
+        if (std::find(inputs.begin(), inputs.end(), inst) == inputs.end()) {
+            AppendInput(inst);
             input_bb_.push_back(bb);
         }
     }
 
     void RemoveInput(Inst* inst)
     {
-        auto it = std::find(input_inst_.begin(), input_inst_.end(), inst);
-        *it = input_inst_.back();
-        input_inst_.pop_back();
-
-        size_t index = std::distance(input_inst_.begin(), it);
+        auto inputs = GetInputs();
+        uint32_t index = std::distance(inputs.begin(), std::find(inputs.begin(), inputs.end(), inst));
+        Inst::RemoveInput(index);
         input_bb_[index] = input_bb_.back();
         input_bb_.pop_back();
     }
 
-    void Dump() override;
-    void SubstituteInput(Inst* old_input, Inst* new_input) override;
+    void Dump();
 
   private:
-    std::vector<Inst*> input_inst_;
     std::vector<BasicBlock*> input_bb_;
 };
 
@@ -201,12 +292,20 @@ public:
     {}
 
     ACCESSOR_MUTATOR(callee_, Callee, Graph*)
-    ACCESSOR_MUTATOR(arguments_, Arguments, std::vector<Inst*>)
 
-    void Dump() override;
+    Span<Inst*> GetArguments()
+    {
+        return GetInputs();
+    }
+
+    void SetArguments(const std::vector<Inst*>& arguments)
+    {
+        SetInputs(arguments);
+    }
+
+    void Dump();
 private:
-    Graph* callee_;
-    std::vector<Inst*> arguments_;
+    Graph* callee_ = nullptr;
 };
 
 class InstConstant : public Inst
@@ -217,7 +316,7 @@ class InstConstant : public Inst
 
     ACCESSOR_MUTATOR(constant_, Constant, int32_t)
 
-    void Dump() override;
+    void Dump();
 
   private:
     int32_t constant_ = 0;
@@ -226,10 +325,6 @@ class InstConstant : public Inst
 template <Opcode opcode>
 Inst* Inst::InstBuilder(uint32_t ins_id)
 {
-    if (next_id_ < ins_id)
-        next_id_ = ins_id;
-    next_id_++;
-
 #define BUILD_INST(name, type)                                                         \
     if constexpr (opcode == Opcode::name) {                                          \
         return static_cast<Inst*>(new type(ins_id, opcode));       \
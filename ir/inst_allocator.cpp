@@ -0,0 +1,201 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "inst_allocator.h"
+#include "inst.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define INST_ALLOCATOR_SANITIZED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define INST_ALLOCATOR_SANITIZED
+#endif
+#endif
+
+#define CHECK_SIZE(Type) static_assert(sizeof(Type) <= InstAllocator::MAX_OBJECT_SIZE);
+TYPE_LIST(CHECK_SIZE)
+#undef CHECK_SIZE
+
+static thread_local size_t allocated_size = 0;
+
+size_t InstAllocator::GetAllocatedSize()
+{
+    return allocated_size;
+}
+
+#ifndef INST_ALLOCATOR_SANITIZED
+
+namespace {
+
+// objects are rounded up to granules, every size class has chunks of its own
+constexpr size_t GRANULE = 16;
+constexpr size_t SIZE_CLASSES_NUM = InstAllocator::MAX_OBJECT_SIZE / GRANULE;
+
+struct FreeObject {
+    FreeObject* next_;
+};
+
+class Pool;
+
+// chunks are aligned to their size, so the header is found by the address of object
+struct alignas(GRANULE) ChunkHeader {
+    Pool* pool_;
+    size_t size_class_;
+};
+
+ChunkHeader* GetHeader(void* ptr)
+{
+    return reinterpret_cast<ChunkHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(InstAllocator::CHUNK_SIZE - 1));
+}
+
+class Pool
+{
+public:
+    void* Allocate(size_t size_class)
+    {
+        if (free_lists_[size_class] == nullptr && remote_free_.load(std::memory_order_relaxed) != nullptr) {
+            TakeRemoteFree();
+        }
+        FreeObject* object = free_lists_[size_class];
+        if (object != nullptr) {
+            free_lists_[size_class] = object->next_;
+            return object;
+        }
+        size_t size = (size_class + 1) * GRANULE;
+        if (cur_[size_class] + size > end_[size_class]) {
+            NewChunk(size_class);
+        }
+        void* result = reinterpret_cast<void*>(cur_[size_class]);
+        cur_[size_class] += size;
+        return result;
+    }
+
+    void Free(void* ptr, size_t size_class)
+    {
+        auto object = static_cast<FreeObject*>(ptr);
+        object->next_ = free_lists_[size_class];
+        free_lists_[size_class] = object;
+    }
+
+    // called by threads, which do not own the pool
+    void FreeRemote(void* ptr)
+    {
+        auto object = static_cast<FreeObject*>(ptr);
+        object->next_ = remote_free_.load(std::memory_order_relaxed);
+        while (!remote_free_.compare_exchange_weak(object->next_, object, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    void TakeRemoteFree()
+    {
+        // the whole list is taken at once, so there is no ABA problem
+        FreeObject* object = remote_free_.exchange(nullptr, std::memory_order_acquire);
+        while (object != nullptr) {
+            FreeObject* next = object->next_;
+            Free(object, GetHeader(object)->size_class_);
+            object = next;
+        }
+    }
+
+    void NewChunk(size_t size_class)
+    {
+        void* chunk = std::aligned_alloc(InstAllocator::CHUNK_SIZE, InstAllocator::CHUNK_SIZE);
+        if (chunk == nullptr) {
+            throw std::bad_alloc();
+        }
+        auto header = new (chunk) ChunkHeader{this, size_class};
+        cur_[size_class] = reinterpret_cast<uintptr_t>(header + 1);
+        end_[size_class] = reinterpret_cast<uintptr_t>(chunk) + InstAllocator::CHUNK_SIZE;
+    }
+
+    FreeObject* free_lists_[SIZE_CLASSES_NUM] = {};
+    uintptr_t cur_[SIZE_CLASSES_NUM] = {};
+    uintptr_t end_[SIZE_CLASSES_NUM] = {};
+    std::atomic<FreeObject*> remote_free_ {nullptr};
+};
+
+// pools are never destroyed, since their objects may outlive the thread
+std::mutex abandoned_pools_mutex;
+
+std::vector<Pool*>& GetAbandonedPools()
+{
+    static auto pools = new std::vector<Pool*>();
+    return *pools;
+}
+
+thread_local Pool* thread_pool = nullptr;
+
+// gives the pool of the thread to the next new thread, when this one finishes
+struct PoolReleaser {
+    ~PoolReleaser()
+    {
+        std::lock_guard lock(abandoned_pools_mutex);
+        GetAbandonedPools().push_back(thread_pool);
+        thread_pool = nullptr;
+    }
+};
+
+thread_local PoolReleaser pool_releaser;
+
+Pool* GetThreadPool()
+{
+    if (thread_pool == nullptr) {
+        {
+            std::lock_guard lock(abandoned_pools_mutex);
+            auto& abandoned_pools = GetAbandonedPools();
+            if (abandoned_pools.empty()) {
+                thread_pool = new Pool();
+            } else {
+                thread_pool = abandoned_pools.back();
+                abandoned_pools.pop_back();
+            }
+        }
+        // registers the destructor of releaser
+        (void)&pool_releaser;
+    }
+    return thread_pool;
+}
+
+}  // namespace
+
+void* InstAllocator::Allocate(size_t size)
+{
+    assert(size != 0 && size <= MAX_OBJECT_SIZE);
+    allocated_size += size;
+    return GetThreadPool()->Allocate((size - 1) / GRANULE);
+}
+
+void InstAllocator::Free(void* ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    ChunkHeader* header = GetHeader(ptr);
+    if (header->pool_ == thread_pool) {
+        header->pool_->Free(ptr, header->size_class_);
+    } else {
+        header->pool_->FreeRemote(ptr);
+    }
+}
+
+#else
+
+void* InstAllocator::Allocate(size_t size)
+{
+    allocated_size += size;
+    return ::operator new(size);
+}
+
+void InstAllocator::Free(void* ptr)
+{
+    ::operator delete(ptr);
+}
+
+#endif // INST_ALLOCATOR_SANITIZED
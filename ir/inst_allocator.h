@@ -0,0 +1,36 @@
+#ifndef INST_ALLOCATOR_H
+#define INST_ALLOCATOR_H
+
+#include <cstddef>
+
+// Allocator of instructions, which keeps instructions of a graph close to
+// each other: objects of one size are cut from 64 KB chunks in order of
+// allocation, so instructions, which are created one after another, e.g.
+// by the parser, the cloner or a pass, share cache lines and pages instead
+// of being scattered among vectors of users and other heap objects.
+// Addresses are stable, so instructions remain linked into blocks.
+//
+// Every thread allocates from a pool of its own without locks. Objects
+// may be freed by any thread: objects of another pool are returned to it
+// through a lock free list, which the owner takes when its free list is
+// empty, so memory is reused when graphs are parsed and destroyed by
+// different threads. Pools of finished threads are adopted by new ones.
+// Chunks are kept for reuse and are never returned to the system.
+//
+// Under address sanitizer objects are allocated by operator new, so that
+// use after free of instructions is still found
+class InstAllocator
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_OBJECT_SIZE = 256;
+
+    static void* Allocate(size_t size);
+    static void Free(void* ptr);
+
+    // bytes of objects allocated by the calling thread, freed objects
+    // are not subtracted, e.g. to measure allocations of a pass
+    static size_t GetAllocatedSize();
+};
+
+#endif // INST_ALLOCATOR_H
@@ -0,0 +1,153 @@
+#ifndef INST_RANGE_H
+#define INST_RANGE_H
+
+#include <cstddef>
+#include <iterator>
+
+#include "inst.h"
+
+// Filters of instructions visited by ranges. Stops ends iteration at
+// the first instruction it accepts, Accepts skips others
+struct AnyInst {
+    bool Accepts(Inst*) const
+    {
+        return true;
+    }
+
+    bool Stops(Inst*) const
+    {
+        return false;
+    }
+};
+
+struct InstWithOpcode {
+    bool Accepts(Inst* inst) const
+    {
+        return inst->GetOpcode() == opcode_;
+    }
+
+    bool Stops(Inst*) const
+    {
+        return false;
+    }
+
+    Opcode opcode_;
+};
+
+// phis precede other instructions of block, so iteration stops at the first non phi
+struct PhiInsts {
+    bool Accepts(Inst*) const
+    {
+        return true;
+    }
+
+    bool Stops(Inst* inst) const
+    {
+        return inst->GetType() != Type::InstPhi;
+    }
+};
+
+// Iterator over a list of instructions. Instructions inserted after the
+// current one are visited. Safe iterator reads the next instruction
+// before the current one is visited, so the current one may be unlinked
+// or deleted, but the next one must stay in place
+template <typename Filter, bool is_reverse, bool is_safe>
+class InstIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Inst*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Inst**;
+    using reference = Inst*;
+
+    InstIterator() = default;
+    InstIterator(Inst* inst, Filter filter) : filter_(filter)
+    {
+        Seek(inst);
+    }
+
+    Inst* operator*() const
+    {
+        return inst_;
+    }
+
+    InstIterator& operator++()
+    {
+        if constexpr (is_safe) {
+            Seek(next_);
+        } else {
+            Seek(Step(inst_));
+        }
+        return *this;
+    }
+
+    InstIterator operator++(int)
+    {
+        InstIterator result = *this;
+        ++*this;
+        return result;
+    }
+
+    bool operator==(const InstIterator& other) const
+    {
+        return inst_ == other.inst_;
+    }
+
+    bool operator!=(const InstIterator& other) const
+    {
+        return inst_ != other.inst_;
+    }
+
+private:
+    static Inst* Step(Inst* inst)
+    {
+        return is_reverse ? inst->GetPrev() : inst->GetNext();
+    }
+
+    // moves to the first instruction starting from inst, which is accepted by filter
+    void Seek(Inst* inst)
+    {
+        while (inst != nullptr && !filter_.Stops(inst) && !filter_.Accepts(inst)) {
+            inst = Step(inst);
+        }
+        inst_ = inst != nullptr && filter_.Stops(inst) ? nullptr : inst;
+        if constexpr (is_safe) {
+            next_ = inst_ != nullptr ? Step(inst_) : nullptr;
+        }
+    }
+
+    Inst* inst_ = nullptr;
+    Inst* next_ = nullptr;
+    Filter filter_ {};
+};
+
+template <typename Filter = AnyInst, bool is_reverse = false, bool is_safe = false>
+class InstRange
+{
+public:
+    using Iterator = InstIterator<Filter, is_reverse, is_safe>;
+
+    explicit InstRange(Inst* first, Filter filter = {}) : first_(first), filter_(filter) {}
+
+    Iterator begin() const
+    {
+        return Iterator(first_, filter_);
+    }
+
+    Iterator end() const
+    {
+        return Iterator();
+    }
+
+    bool empty() const
+    {
+        return begin() == end();
+    }
+
+private:
+    Inst* first_;
+    Filter filter_;
+};
+
+#endif // INST_RANGE_H
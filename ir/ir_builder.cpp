@@ -2,7 +2,7 @@
 
 Graph* IrBuilder::GraphBuilder(std::initializer_list<BasicBlock*> bbs)
 {
-    Graph* result = new Graph{bbs};
+    Graph* result = new Graph(bbs, context_);
 
     for (auto item: bb_id_to_succs_ids_) {
         auto bb = result->GetBBbyId(item.first);
@@ -27,23 +27,9 @@ Graph* IrBuilder::GraphBuilder(std::initializer_list<BasicBlock*> bbs)
 void IrBuilder::BuildDFG(Graph* g)
 {
     for (auto bb: g->GetBasicBlocks()) {
-        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        for (auto inst: bb->Insts()) {
             switch (inst->GetType())
             {
-            case Type::InstWithOneInput: {
-                InstWithOneInput* inst_casted = inst->CastToInstWithOneInput();
-                inst_casted->SetInput1(g->GetInstById(inst_id_to_inputs_ids_[inst->GetId()][0]));
-                inst_casted->GetInput1()->AddUser(inst);
-                break;
-            }
-            case Type::InstWithTwoInputs: {
-                InstWithTwoInputs* inst_casted = inst->CastToInstWithTwoInputs();
-                inst_casted->SetInput1(g->GetInstById(inst_id_to_inputs_ids_[inst->GetId()][0]));
-                inst_casted->GetInput1()->AddUser(inst);
-                inst_casted->SetInput2(g->GetInstById(inst_id_to_inputs_ids_[inst->GetId()][1]));
-                inst_casted->GetInput2()->AddUser(inst);
-                break;
-            }
             case Type::InstWithNoInputs: {
                 break;
             }
@@ -61,22 +47,20 @@ void IrBuilder::BuildDFG(Graph* g)
                 inst->CastToInstConstant()->SetConstant(inst_id_to_inputs_ids_[inst->GetId()][0]);
                 break;
             }
-            case Type::InstCall: {
-                std::vector<Inst*> call_arguments;
-                for (int i = 0; i < inst_id_to_inputs_ids_[inst->GetId()].size(); ++i) {
-                    call_arguments.push_back(g->GetInstById(inst_id_to_inputs_ids_[inst->GetId()][i]));
-                    call_arguments[i]->AddUser(inst);
-                }
-                inst->CastToInstCall()->SetArguments(call_arguments);
-                break;
-            }
             case Type::InstJmp: {
                 inst->CastToInstJmp()->SetTargetBB(g->GetBBbyId(inst_id_to_inputs_ids_[inst->GetId()][0]));
                 break;
             }
-            default:
+            default: {
+                std::vector<Inst*> inputs;
+                for (auto input_id: inst_id_to_inputs_ids_[inst->GetId()]) {
+                    inputs.push_back(g->GetInstById(input_id));
+                    inputs.back()->AddUser(inst);
+                }
+                inst->SetInputs(inputs);
                 break;
             }
+            }
         }
     }
 }
\ No newline at end of file
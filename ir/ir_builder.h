@@ -9,6 +9,9 @@
 class IrBuilder
 {
 public:
+    // graphs are built in the given context, or each in a context of its own
+    explicit IrBuilder(CompilationContext* context = nullptr) : context_(context) {}
+
     Graph* GraphBuilder(std::initializer_list<BasicBlock*> bbs);
 
     // first successor is true branch
@@ -31,6 +34,7 @@ private:
 
     std::map<uint32_t, std::vector<uint32_t>> inst_id_to_inputs_ids_;
     std::map<uint32_t, std::vector<uint32_t>> bb_id_to_succs_ids_;
+    CompilationContext* context_ = nullptr;
 };
 
 template <Opcode opcode, typename... Args>
@@ -0,0 +1,385 @@
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+#include "ir_parser.h"
+
+// thrown by Error and caught by TryParse, so that nested parsing
+// functions do not check the result of each other
+struct IrParseError {
+    std::string msg_;
+};
+
+std::vector<Graph*> IrParser::Parse(std::string_view text)
+{
+    std::vector<Graph*> methods;
+    if (!TryParse(text, &methods)) {
+        throw_error(error_);
+    }
+    return methods;
+}
+
+std::vector<Graph*> IrParser::ParseFile(const std::string& path)
+{
+    std::vector<Graph*> methods;
+    if (!TryParseFile(path, &methods)) {
+        throw_error(error_);
+    }
+    return methods;
+}
+
+bool IrParser::TryParse(std::string_view text, std::vector<Graph*>* methods)
+{
+    error_.clear();
+    try {
+        ParseText(text);
+    } catch (const IrParseError& error) {
+        error_ = error.msg_;
+        DestroyParsed();
+        return false;
+    }
+    *methods = std::move(methods_);
+    methods_.clear();
+    return true;
+}
+
+bool IrParser::TryParseFile(const std::string& path, std::vector<Graph*>* methods)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error_ = "can not open IR file " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return TryParse(text.str(), methods);
+}
+
+void IrParser::ParseText(std::string_view text)
+{
+    text_ = text;
+    pos_ = 0;
+    line_ = 1;
+    methods_.clear();
+    methods_by_name_.clear();
+    // blocks of previous text may be destroyed already
+    std::fill(bbs_.begin(), bbs_.end(), nullptr);
+
+    SkipSpaces();
+    while (pos_ < text_.size()) {
+        ParseMethod();
+        SkipSpaces();
+    }
+
+    for (auto [name, g]: methods_by_name_) {
+        if (g->GetBasicBlocks().empty()) {
+            Error("method @" + std::string(name) + " is called, but not defined");
+        }
+    }
+}
+
+// blocks of the current method, which are referred, but not defined, belong
+// to no graph, instructions are destroyed together with their blocks
+void IrParser::DestroyParsed()
+{
+    for (auto bb: bbs_) {
+        if (bb != nullptr && bb->GetGraph() == nullptr) {
+            BasicBlock::BasicBlockDestroyer(bb);
+        }
+    }
+    std::fill(bbs_.begin(), bbs_.end(), nullptr);
+    std::fill(insts_.begin(), insts_.end(), nullptr);
+    for (auto [name, g]: methods_by_name_) {
+        Graph::GraphDestroyer(g);
+    }
+    methods_.clear();
+    methods_by_name_.clear();
+}
+
+void IrParser::ParseMethod()
+{
+    if (ParseWord() != "method") {
+        Error("expected 'method'");
+    }
+    std::string_view name = ParseWord();
+    if (name.empty()) {
+        Error("expected method name");
+    }
+    Graph* g = GetMethod(name);
+    if (!g->GetBasicBlocks().empty()) {
+        Error("method @" + std::string(name) + " is defined twice");
+    }
+    methods_.push_back(g);
+    Expect('{');
+
+    std::fill(bbs_.begin(), bbs_.end(), nullptr);
+    std::fill(insts_.begin(), insts_.end(), nullptr);
+    defined_bbs_.clear();
+    input_ids_.clear();
+    pending_inputs_.clear();
+    while (!TryConsume('}')) {
+        ParseBasicBlock(g);
+    }
+    if (defined_bbs_.empty()) {
+        Error("method @" + std::string(name) + " has no basic blocks");
+    }
+    FinishMethod(g);
+}
+
+void IrParser::ParseBasicBlock(Graph* g)
+{
+    BasicBlock* bb = GetBasicBlock(ParseId("bb"));
+    if (bb->GetGraph() != nullptr) {
+        Error("bb" + std::to_string(bb->GetId()) + " is defined twice");
+    }
+    g->AddBasicBlock(bb);
+    defined_bbs_.push_back(bb);
+
+    if (TryConsume('-')) {
+        Expect('>');
+        do {
+            bb->AddSucc(GetBasicBlock(ParseId("bb")));
+        } while (TryConsume(','));
+    }
+    Expect(':');
+
+    while (IsNext('v')) {
+        ParseInst(g, bb);
+    }
+}
+
+void IrParser::ParseInst(Graph* g, BasicBlock* bb)
+{
+    uint32_t id = ParseId("v");
+    if (id < insts_.size() && insts_[id] != nullptr) {
+        Error("v" + std::to_string(id) + " is defined twice");
+    }
+    Expect('=');
+
+    static const std::unordered_map<std::string_view, Opcode> OPCODES = []() {
+        std::unordered_map<std::string_view, Opcode> opcodes;
+        for (size_t i = 0; i < std::size(OPCODE_NAMES); ++i) {
+            opcodes[OPCODE_NAMES[i]] = static_cast<Opcode>(i);
+        }
+        return opcodes;
+    }();
+    std::string_view opcode_name = ParseWord();
+    auto it = OPCODES.find(opcode_name);
+    if (it == OPCODES.end()) {
+        Error("unknown opcode '" + std::string(opcode_name) + "'");
+    }
+
+    Inst* inst = Inst::InstBuilder(it->second, id);
+    if (insts_.size() <= id) {
+        insts_.resize(id + 1, nullptr);
+    }
+    insts_[id] = inst;
+    g->GetContext()->GetInstIds().Skip(id);
+    bb->PushBackInst(inst);
+    ParseInputs(inst);
+}
+
+void IrParser::ParseInputs(Inst* inst)
+{
+    PendingInputs pending;
+    pending.inst_ = inst;
+    pending.begin_ = input_ids_.size();
+    switch (inst->GetType()) {
+    case Type::InstWithTwoInputs:
+        input_ids_.push_back(ParseId("v"));
+        Expect(',');
+        input_ids_.push_back(ParseId("v"));
+        break;
+    case Type::InstWithOneInput:
+        input_ids_.push_back(ParseId("v"));
+        break;
+    case Type::InstPhi:
+        if (!IsNext('(')) {
+            break;
+        }
+        do {
+            Expect('(');
+            input_ids_.push_back(ParseId("v"));
+            Expect(',');
+            // block is created here, so that it is checked to be defined
+            input_ids_.push_back(GetBasicBlock(ParseId("bb"))->GetId());
+            Expect(')');
+        } while (TryConsume(','));
+        break;
+    case Type::InstCall: {
+        Expect('@');
+        inst->CastToInstCall()->SetCallee(GetMethod(ParseWord()));
+        Expect('(');
+        if (!TryConsume(')')) {
+            do {
+                input_ids_.push_back(ParseId("v"));
+            } while (TryConsume(','));
+            Expect(')');
+        }
+        break;
+    }
+    case Type::InstJmp:
+        inst->CastToInstJmp()->SetTargetBB(GetBasicBlock(ParseId("bb")));
+        break;
+    case Type::InstConstant:
+        inst->CastToInstConstant()->SetConstant(ParseConstant());
+        break;
+    default:
+        break;
+    }
+    pending.end_ = input_ids_.size();
+    if (pending.begin_ != pending.end_) {
+        pending_inputs_.push_back(pending);
+    }
+}
+
+void IrParser::FinishMethod(Graph* g)
+{
+    for (auto bb: bbs_) {
+        if (bb != nullptr && bb->GetGraph() != g) {
+            Error("bb" + std::to_string(bb->GetId()) + " is referred, but not defined");
+        }
+    }
+    for (auto bb: defined_bbs_) {
+        for (auto succ: bb->GetSuccs()) {
+            succ->AddPred(bb);
+        }
+    }
+
+    for (const auto& pending: pending_inputs_) {
+        Inst* inst = pending.inst_;
+        const uint32_t* ids = input_ids_.data() + pending.begin_;
+        uint32_t ids_num = pending.end_ - pending.begin_;
+        if (inst->GetType() == Type::InstPhi) {
+            for (uint32_t i = 0; i < ids_num; i += 2) {
+                inst->CastToInstPhi()->AddInput(GetInst(ids[i]), bbs_[ids[i + 1]]);
+                GetInst(ids[i])->AddUser(inst);
+            }
+            continue;
+        }
+        std::vector<Inst*> inputs;
+        inputs.reserve(ids_num);
+        for (uint32_t i = 0; i < ids_num; ++i) {
+            inputs.push_back(GetInst(ids[i]));
+            inputs.back()->AddUser(inst);
+        }
+        inst->SetInputs(inputs);
+    }
+}
+
+Graph* IrParser::GetMethod(std::string_view name)
+{
+    auto it = methods_by_name_.find(name);
+    if (it != methods_by_name_.end()) {
+        return it->second;
+    }
+    Graph* g = new Graph({}, context_);
+    g->SetName(std::string(name));
+    // key refers to the name stored in graph, which outlives the text
+    methods_by_name_[g->GetName()] = g;
+    return g;
+}
+
+// blocks are created when they are referred for the first time
+// and added to graph when they are defined
+BasicBlock* IrParser::GetBasicBlock(uint32_t id)
+{
+    if (bbs_.size() <= id) {
+        bbs_.resize(id + 1, nullptr);
+    }
+    if (bbs_[id] == nullptr) {
+        bbs_[id] = new BasicBlock(id);
+    }
+    return bbs_[id];
+}
+
+Inst* IrParser::GetInst(uint32_t id)
+{
+    if (id >= insts_.size() || insts_[id] == nullptr) {
+        Error("v" + std::to_string(id) + " is referred, but not defined");
+    }
+    return insts_[id];
+}
+
+void IrParser::SkipSpaces()
+{
+    while (pos_ < text_.size()) {
+        char c = text_[pos_];
+        if (c == '\n') {
+            line_++;
+        } else if (c == '#') {
+            while (pos_ < text_.size() && text_[pos_] != '\n') {
+                pos_++;
+            }
+            continue;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            return;
+        }
+        pos_++;
+    }
+}
+
+bool IrParser::TryConsume(char c)
+{
+    SkipSpaces();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+        pos_++;
+        return true;
+    }
+    return false;
+}
+
+void IrParser::Expect(char c)
+{
+    if (!TryConsume(c)) {
+        Error(std::string("expected '") + c + "'");
+    }
+}
+
+bool IrParser::IsNext(char c)
+{
+    SkipSpaces();
+    return pos_ < text_.size() && text_[pos_] == c;
+}
+
+std::string_view IrParser::ParseWord()
+{
+    SkipSpaces();
+    size_t begin = pos_;
+    while (pos_ < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_')) {
+        pos_++;
+    }
+    return text_.substr(begin, pos_ - begin);
+}
+
+uint32_t IrParser::ParseId(std::string_view prefix)
+{
+    std::string_view word = ParseWord();
+    uint32_t id = 0;
+    if (word.size() <= prefix.size() || word.substr(0, prefix.size()) != prefix) {
+        Error("expected " + std::string(prefix) + "<id>, got '" + std::string(word) + "'");
+    }
+    auto [end, error] = std::from_chars(word.data() + prefix.size(), word.data() + word.size(), id);
+    if (error != std::errc() || end != word.data() + word.size() || id >= MAX_ID) {
+        Error("invalid id '" + std::string(word) + "'");
+    }
+    return id;
+}
+
+int32_t IrParser::ParseConstant()
+{
+    SkipSpaces();
+    int32_t constant = 0;
+    auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), constant);
+    if (error != std::errc()) {
+        Error("expected 32-bit integer constant");
+    }
+    pos_ = end - text_.data();
+    return constant;
+}
+
+void IrParser::Error(const std::string& msg)
+{
+    throw IrParseError{"IR parsing error, line " + std::to_string(line_) + ": " + msg};
+}
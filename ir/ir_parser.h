@@ -0,0 +1,106 @@
+#ifndef IR_PARSER_H
+#define IR_PARSER_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "graph.h"
+
+// Parser of textual IR, which is printed by IrPrinter:
+//
+//     method callee {
+//     bb0 -> bb1, bb2:
+//         v0 = PARAMETER
+//         v1 = CONSTANT -3
+//         v2 = CMP v0, v1
+//         v3 = JMP_EQ bb1
+//     bb2 -> bb1:
+//         v4 = JMP bb1
+//     bb1:
+//         v5 = PHI (v0, bb0), (v1, bb2)
+//         v6 = CALL_STATIC @callee(v5)
+//         v7 = RET v6
+//     }
+//
+// First successor is true branch. Blocks and instructions may be referred
+// before they are defined, methods are called by name and may be defined
+// later in the text. Predecessors are the blocks, which have the block
+// as a successor, in order of definition. Text after '#' is a comment.
+// Parsing is done in one pass over the text, references are resolved when
+// a method ends. Invalid text is reported with its line number, Parse aborts
+// on it, TryParse returns false and destroys graphs built so far
+class IrParser
+{
+public:
+    // graphs are built in the given context, or each in a context of its own
+    explicit IrParser(CompilationContext* context = nullptr) : context_(context) {}
+
+    // returns methods in order of definition
+    std::vector<Graph*> Parse(std::string_view text);
+    std::vector<Graph*> ParseFile(const std::string& path);
+    bool TryParse(std::string_view text, std::vector<Graph*>* methods);
+    bool TryParseFile(const std::string& path, std::vector<Graph*>* methods);
+
+    // message of the error, which made TryParse fail
+    const std::string& GetError()
+    {
+        return error_;
+    }
+
+    // bound for ids of blocks and instructions, which index lookup tables
+    static constexpr uint32_t MAX_ID = 1U << 24;
+
+private:
+    // inputs of an instruction, ids of which are stored in input_ids_,
+    // phi inputs are pairs of instruction and block ids
+    struct PendingInputs {
+        Inst* inst_ = nullptr;
+        uint32_t begin_ = 0;
+        uint32_t end_ = 0;
+    };
+
+    void ParseText(std::string_view text);
+    // destroys graphs and blocks, which were created before an error
+    void DestroyParsed();
+    void ParseMethod();
+    void ParseBasicBlock(Graph* g);
+    void ParseInst(Graph* g, BasicBlock* bb);
+    void ParseInputs(Inst* inst);
+    // binds blocks with each other and instructions with their inputs
+    void FinishMethod(Graph* g);
+
+    Graph* GetMethod(std::string_view name);
+    BasicBlock* GetBasicBlock(uint32_t id);
+    Inst* GetInst(uint32_t id);
+
+    void SkipSpaces();
+    bool TryConsume(char c);
+    void Expect(char c);
+    bool IsNext(char c);
+    std::string_view ParseWord();
+    // word, which consists of prefix and number, e.g. "bb3" or "v5"
+    uint32_t ParseId(std::string_view prefix);
+    int32_t ParseConstant();
+    [[noreturn]] void Error(const std::string& msg);
+
+    CompilationContext* context_ = nullptr;
+    std::string error_;
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    uint32_t line_ = 1;
+
+    std::vector<Graph*> methods_;
+    std::unordered_map<std::string_view, Graph*> methods_by_name_;
+
+    // state of the current method, indexed by id
+    std::vector<BasicBlock*> bbs_;
+    std::vector<Inst*> insts_;
+    std::vector<BasicBlock*> defined_bbs_;
+    std::vector<uint32_t> input_ids_;
+    std::vector<PendingInputs> pending_inputs_;
+};
+
+#endif // IR_PARSER_H
@@ -0,0 +1,192 @@
+#include <charconv>
+
+#include "ir_printer.h"
+
+const std::string& IrPrinter::Print(const std::vector<Graph*>& graphs)
+{
+    buffer_.clear();
+    methods_.clear();
+    names_.clear();
+    for (auto g: graphs) {
+        AddMethod(g);
+    }
+    // callees are added to methods_ while it is traversed
+    for (size_t i = 0; i < methods_.size(); ++i) {
+        for (auto bb: methods_[i]->GetBasicBlocks()) {
+            for (auto call: bb->Insts(Opcode::CALL_STATIC)) {
+                AddMethod(call->CastToInstCall()->GetCallee());
+            }
+        }
+    }
+    NameMethods();
+    for (auto g: methods_) {
+        PrintMethod(g);
+    }
+    return buffer_;
+}
+
+void IrPrinter::Print(const std::vector<Graph*>& graphs, std::ostream& out)
+{
+    const std::string& text = Print(graphs);
+    out.write(text.data(), text.size());
+}
+
+void IrPrinter::PrintMethod(Graph* g)
+{
+    if (!buffer_.empty()) {
+        Append("\n");
+    }
+    Append("method ");
+    Append(names_.at(g));
+    Append(" {\n");
+    live_intervals_ = nullptr;
+    if (is_live_intervals_printed_ && g->IsPassValid<LivenessAnalysis>()) {
+        live_intervals_ = &g->GetLiveIntervals();
+        is_allocated_ = g->IsPassValid<RegAlloc>();
+    }
+    for (auto bb: g->GetBasicBlocks()) {
+        PrintBasicBlock(bb);
+    }
+    Append("}\n");
+}
+
+void IrPrinter::PrintBasicBlock(BasicBlock* bb)
+{
+    AppendId("bb", bb->GetId());
+    const auto& succs = bb->GetSuccs();
+    for (size_t i = 0; i < succs.size(); ++i) {
+        Append(i == 0 ? " -> " : ", ");
+        AppendId("bb", succs[i]->GetId());
+    }
+    Append(":\n");
+    for (auto inst: bb->Insts()) {
+        PrintInst(inst);
+    }
+}
+
+void IrPrinter::PrintInst(Inst* inst)
+{
+    Append("    ");
+    AppendId("v", inst->GetId());
+    Append(" = ");
+    Append(OPCODE_NAMES[static_cast<size_t>(inst->GetOpcode())]);
+    PrintInputs(inst);
+    if (live_intervals_ != nullptr) {
+        PrintLiveInterval(inst);
+    }
+    Append("\n");
+}
+
+void IrPrinter::PrintLiveInterval(Inst* inst)
+{
+    auto it = live_intervals_->find(inst);
+    if (it == live_intervals_->end()) {
+        return;
+    }
+    LiveInterval* interval = it->second;
+    Append("  # ");
+    if (is_allocated_) {
+        Append(interval->GetIsStackLocation() ? "S" : "R");
+        Append(static_cast<int64_t>(interval->GetLocation()));
+        Append(" ");
+    }
+    Append("[");
+    Append(static_cast<int64_t>(interval->GetStart()));
+    Append(", ");
+    Append(static_cast<int64_t>(interval->GetEnd()));
+    Append(")");
+}
+
+void IrPrinter::PrintInputs(Inst* inst)
+{
+    switch (inst->GetType()) {
+    case Type::InstWithTwoInputs:
+        AppendId(" v", inst->CastToInstWithTwoInputs()->GetInput1()->GetId());
+        AppendId(", v", inst->CastToInstWithTwoInputs()->GetInput2()->GetId());
+        break;
+    case Type::InstWithOneInput:
+        AppendId(" v", inst->CastToInstWithOneInput()->GetInput1()->GetId());
+        break;
+    case Type::InstPhi: {
+        const auto& input_insts = inst->CastToInstPhi()->GetInputInst();
+        const auto& input_bbs = inst->CastToInstPhi()->GetInputBB();
+        for (size_t i = 0; i < input_insts.size(); ++i) {
+            AppendId(i == 0 ? " (v" : ", (v", input_insts[i]->GetId());
+            AppendId(", bb", input_bbs[i]->GetId());
+            Append(")");
+        }
+        break;
+    }
+    case Type::InstCall: {
+        InstCall* call = inst->CastToInstCall();
+        Append(" @");
+        Append(names_.at(call->GetCallee()));
+        Append("(");
+        const auto& arguments = call->GetArguments();
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            AppendId(i == 0 ? "v" : ", v", arguments[i]->GetId());
+        }
+        Append(")");
+        break;
+    }
+    case Type::InstJmp:
+        AppendId(" bb", inst->CastToInstJmp()->GetTargetBB()->GetId());
+        break;
+    case Type::InstConstant:
+        Append(" ");
+        Append(inst->CastToInstConstant()->GetConstant());
+        break;
+    default:
+        break;
+    }
+}
+
+void IrPrinter::AddMethod(Graph* g)
+{
+    if (names_.count(g) != 0) {
+        return;
+    }
+    names_[g] = g->GetName();
+    methods_.push_back(g);
+}
+
+// names of all methods are known before unnamed ones get a name,
+// so that it does not collide with a name of a method printed later
+void IrPrinter::NameMethods()
+{
+    std::unordered_set<std::string> used_names;
+    for (auto g: methods_) {
+        if (!g->GetName().empty()) {
+            used_names.insert(g->GetName());
+        }
+    }
+    for (size_t i = 0; i < methods_.size(); ++i) {
+        std::string& name = names_[methods_[i]];
+        if (!name.empty()) {
+            continue;
+        }
+        name = "method" + std::to_string(i);
+        while (used_names.count(name) != 0) {
+            name += "_";
+        }
+        used_names.insert(name);
+    }
+}
+
+void IrPrinter::Append(std::string_view text)
+{
+    buffer_.append(text);
+}
+
+void IrPrinter::Append(int64_t number)
+{
+    char digits[24];
+    auto [end, error] = std::to_chars(std::begin(digits), std::end(digits), number);
+    buffer_.append(digits, end);
+}
+
+void IrPrinter::AppendId(std::string_view prefix, uint32_t id)
+{
+    Append(prefix);
+    Append(static_cast<int64_t>(id));
+}
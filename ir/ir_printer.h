@@ -0,0 +1,55 @@
+#ifndef IR_PRINTER_H
+#define IR_PRINTER_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "graph.h"
+
+// Printer of textual IR, which is parsed by IrParser. Text is accumulated
+// in a buffer, which is reused by the next print. Methods without name
+// are named "method<index>", which is extended by '_' while it is taken
+// by another printed method
+class IrPrinter
+{
+public:
+    // callees, which are not in graphs, are printed after graphs,
+    // so that the text can be parsed back
+    const std::string& Print(const std::vector<Graph*>& graphs);
+    void Print(const std::vector<Graph*>& graphs, std::ostream& out);
+
+    // live intervals are printed as comments, if liveness of graph is valid,
+    // together with locations, if registers are allocated, e.g.
+    // "v3 = ADD v1, v2  # R0 [8, 12)"
+    void SetPrintLiveIntervals(bool is_enabled)
+    {
+        is_live_intervals_printed_ = is_enabled;
+    }
+
+private:
+    void PrintMethod(Graph* g);
+    void PrintBasicBlock(BasicBlock* bb);
+    void PrintInst(Inst* inst);
+    void PrintLiveInterval(Inst* inst);
+    void PrintInputs(Inst* inst);
+
+    void AddMethod(Graph* g);
+    void NameMethods();
+    void Append(std::string_view text);
+    void Append(int64_t number);
+    void AppendId(std::string_view prefix, uint32_t id);
+
+    std::string buffer_;
+    std::vector<Graph*> methods_;
+    std::unordered_map<Graph*, std::string> names_;
+    bool is_live_intervals_printed_ = false;
+    // of the current method, nullptr if they are not printed
+    std::unordered_map<Inst*, LiveInterval*>* live_intervals_ = nullptr;
+    bool is_allocated_ = false;
+};
+
+#endif // IR_PRINTER_H
@@ -0,0 +1,507 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ir_serializer.h"
+
+using namespace ir_serialization;
+
+const std::vector<uint8_t>& IrSerializer::Serialize(const std::vector<Graph*>& graphs)
+{
+    methods_.clear();
+    method_indices_.clear();
+    method_records_.clear();
+    bb_records_.clear();
+    inst_records_.clear();
+    interval_records_.clear();
+    words_.clear();
+    chars_.clear();
+
+    for (auto g: graphs) {
+        AddMethod(g);
+    }
+    // callees are added to methods_ while it is serialized
+    for (size_t i = 0; i < methods_.size(); ++i) {
+        SerializeMethod(methods_[i]);
+    }
+
+    FileHeader header;
+    header.methods_num_ = method_records_.size();
+    header.bbs_num_ = bb_records_.size();
+    header.insts_num_ = inst_records_.size();
+    header.intervals_num_ = interval_records_.size();
+    header.words_num_ = words_.size();
+    header.chars_num_ = chars_.size();
+    // chars_ are the last, so padding is not needed
+    size_t size = sizeof(FileHeader) + method_records_.size() * sizeof(MethodRecord) +
+                  bb_records_.size() * sizeof(BlockRecord) + inst_records_.size() * sizeof(InstRecord) +
+                  interval_records_.size() * sizeof(IntervalRecord) + words_.size() * sizeof(uint32_t) +
+                  chars_.size();
+    header.size_ = size;
+
+    buffer_.resize(size);
+    uint8_t* pos = buffer_.data();
+    auto append = [&pos](const void* data, size_t data_size) {
+        std::memcpy(pos, data, data_size);
+        pos += data_size;
+    };
+    append(&header, sizeof(header));
+    append(method_records_.data(), method_records_.size() * sizeof(MethodRecord));
+    append(bb_records_.data(), bb_records_.size() * sizeof(BlockRecord));
+    append(inst_records_.data(), inst_records_.size() * sizeof(InstRecord));
+    append(interval_records_.data(), interval_records_.size() * sizeof(IntervalRecord));
+    append(words_.data(), words_.size() * sizeof(uint32_t));
+    append(chars_.data(), chars_.size());
+    return buffer_;
+}
+
+void IrSerializer::SerializeToFile(const std::vector<Graph*>& graphs, const std::string& path)
+{
+    const std::vector<uint8_t>& data = Serialize(graphs);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file) {
+        throw_error("can not write IR file " + path);
+    }
+}
+
+void IrSerializer::AddMethod(Graph* g)
+{
+    if (method_indices_.count(g) == 0) {
+        method_indices_[g] = methods_.size();
+        methods_.push_back(g);
+    }
+}
+
+void IrSerializer::SerializeMethod(Graph* g)
+{
+    bb_indices_.clear();
+    inst_indices_.clear();
+    uint32_t bb_index = 0;
+    uint32_t inst_index = 0;
+    for (auto bb: g->GetBasicBlocks()) {
+        bb_indices_[bb] = bb_index++;
+        for (auto inst: bb->Insts()) {
+            inst_indices_[inst] = inst_index++;
+        }
+    }
+
+    MethodRecord method;
+    method.name_begin_ = chars_.size();
+    method.name_size_ = g->GetName().size();
+    chars_ += g->GetName();
+    method.bbs_begin_ = bb_records_.size();
+    method.bbs_num_ = bb_indices_.size();
+    method.insts_begin_ = inst_records_.size();
+    method.insts_num_ = inst_indices_.size();
+    method.next_inst_id_ = g->GetContext()->GetInstIds().GetNextId();
+    method.next_bb_id_ = g->GetContext()->GetBBIds().GetNextId();
+    method.inline_depth_ = g->GetInlineDepth();
+    PassMask valid_passes = g->GetValidPasses() & ~Graph::GetPassMask<CFGAnalyses>();
+    method.valid_passes_low_ = static_cast<uint32_t>(valid_passes);
+    method.valid_passes_high_ = static_cast<uint32_t>(valid_passes >> 32U);
+
+    for (auto bb: g->GetBasicBlocks()) {
+        BlockRecord record;
+        record.id_ = bb->GetId();
+        record.insts_num_ = bb->GetSize();
+        record.preds_begin_ = words_.size();
+        record.preds_num_ = bb->GetPreds().size();
+        for (auto pred: bb->GetPreds()) {
+            words_.push_back(GetIndex(pred));
+        }
+        record.succs_begin_ = words_.size();
+        record.succs_num_ = bb->GetSuccs().size();
+        for (auto succ: bb->GetSuccs()) {
+            words_.push_back(GetIndex(succ));
+        }
+        bb_records_.push_back(record);
+
+        for (auto inst: bb->Insts()) {
+            inst_records_.emplace_back();
+            SerializeInst(inst, &inst_records_.back());
+        }
+    }
+
+    // results of stale analyses may refer to deleted blocks and instructions
+    method.linear_order_begin_ = words_.size();
+    if (g->IsPassValid<LinearOrder>()) {
+        method.linear_order_num_ = g->GetLinearOrder().size();
+        for (auto bb: g->GetLinearOrder()) {
+            words_.push_back(GetIndex(bb));
+        }
+    }
+    method.intervals_begin_ = interval_records_.size();
+    if (g->IsPassValid<LivenessAnalysis>()) {
+        for (auto [inst, interval]: g->GetLiveIntervals()) {
+            IntervalRecord record;
+            record.inst_index_ = GetIndex(inst);
+            record.start_ = interval->GetStart();
+            record.end_ = interval->GetEnd();
+            record.location_ = interval->GetLocation();
+            record.is_stack_location_ = interval->GetIsStackLocation();
+            interval_records_.push_back(record);
+        }
+        // order of the map is not deterministic
+        std::sort(interval_records_.begin() + method.intervals_begin_, interval_records_.end(),
+                  [](const IntervalRecord& lhs, const IntervalRecord& rhs) {
+                      return lhs.inst_index_ < rhs.inst_index_;
+                  });
+    }
+    method.intervals_num_ = interval_records_.size() - method.intervals_begin_;
+    method_records_.push_back(method);
+}
+
+void IrSerializer::SerializeInst(Inst* inst, InstRecord* record)
+{
+    record->id_ = inst->GetId();
+    record->opcode_ = static_cast<uint32_t>(inst->GetOpcode());
+    record->linear_number_ = inst->GetLinearNumber();
+    record->live_number_ = inst->GetLiveNumber();
+
+    record->operands_begin_ = words_.size();
+    switch (inst->GetType()) {
+    case Type::InstWithTwoInputs:
+        words_.push_back(GetIndex(inst->CastToInstWithTwoInputs()->GetInput1()));
+        words_.push_back(GetIndex(inst->CastToInstWithTwoInputs()->GetInput2()));
+        break;
+    case Type::InstWithOneInput:
+        words_.push_back(GetIndex(inst->CastToInstWithOneInput()->GetInput1()));
+        break;
+    case Type::InstPhi: {
+        const auto& input_insts = inst->CastToInstPhi()->GetInputInst();
+        const auto& input_bbs = inst->CastToInstPhi()->GetInputBB();
+        for (size_t i = 0; i < input_insts.size(); ++i) {
+            words_.push_back(GetIndex(input_insts[i]));
+            words_.push_back(GetIndex(input_bbs[i]));
+        }
+        break;
+    }
+    case Type::InstCall:
+        AddMethod(inst->CastToInstCall()->GetCallee());
+        words_.push_back(method_indices_.at(inst->CastToInstCall()->GetCallee()));
+        for (auto argument: inst->CastToInstCall()->GetArguments()) {
+            words_.push_back(GetIndex(argument));
+        }
+        break;
+    case Type::InstJmp:
+        words_.push_back(GetIndex(inst->CastToInstJmp()->GetTargetBB()));
+        break;
+    case Type::InstConstant:
+        words_.push_back(static_cast<uint32_t>(inst->CastToInstConstant()->GetConstant()));
+        break;
+    default:
+        break;
+    }
+    record->operands_num_ = words_.size() - record->operands_begin_;
+
+    record->users_begin_ = words_.size();
+    record->users_num_ = inst->GetUsers().size();
+    for (auto user: inst->GetUsers()) {
+        words_.push_back(GetIndex(user));
+    }
+}
+
+uint32_t IrSerializer::GetIndex(BasicBlock* bb)
+{
+    auto it = bb_indices_.find(bb);
+    if (it == bb_indices_.end()) {
+        throw_error("serialized graph refers to a block of another graph");
+    }
+    return it->second;
+}
+
+uint32_t IrSerializer::GetIndex(Inst* inst)
+{
+    auto it = inst_indices_.find(inst);
+    if (it == inst_indices_.end()) {
+        throw_error("serialized graph refers to an instruction of another graph");
+    }
+    return it->second;
+}
+
+std::vector<Graph*> IrDeserializer::Deserialize(const uint8_t* data, size_t size)
+{
+    assert(reinterpret_cast<uintptr_t>(data) % alignof(FileHeader) == 0);
+    if (size < sizeof(FileHeader)) {
+        return {};
+    }
+    header_ = reinterpret_cast<const FileHeader*>(data);
+    if (header_->magic_ != MAGIC || header_->version_ != VERSION || header_->size_ != size) {
+        return {};
+    }
+    uint64_t expected_size = sizeof(FileHeader) + uint64_t(header_->methods_num_) * sizeof(MethodRecord) +
+                             uint64_t(header_->bbs_num_) * sizeof(BlockRecord) +
+                             uint64_t(header_->insts_num_) * sizeof(InstRecord) +
+                             uint64_t(header_->intervals_num_) * sizeof(IntervalRecord) +
+                             uint64_t(header_->words_num_) * sizeof(uint32_t) + header_->chars_num_;
+    if (expected_size != size) {
+        return {};
+    }
+    method_records_ = reinterpret_cast<const MethodRecord*>(header_ + 1);
+    bb_records_ = reinterpret_cast<const BlockRecord*>(method_records_ + header_->methods_num_);
+    inst_records_ = reinterpret_cast<const InstRecord*>(bb_records_ + header_->bbs_num_);
+    interval_records_ = reinterpret_cast<const IntervalRecord*>(inst_records_ + header_->insts_num_);
+    words_ = reinterpret_cast<const uint32_t*>(interval_records_ + header_->intervals_num_);
+    chars_ = reinterpret_cast<const char*>(words_ + header_->words_num_);
+    if (!Validate()) {
+        return {};
+    }
+
+    // callees may be defined after callers
+    methods_.clear();
+    for (uint32_t i = 0; i < header_->methods_num_; ++i) {
+        Graph* g = new Graph({}, context_);
+        const MethodRecord& method = method_records_[i];
+        g->SetName(std::string(chars_ + method.name_begin_, method.name_size_));
+        methods_.push_back(g);
+    }
+    for (uint32_t i = 0; i < header_->methods_num_; ++i) {
+        DeserializeMethod(method_records_[i], methods_[i]);
+    }
+    return methods_;
+}
+
+std::vector<Graph*> IrDeserializer::DeserializeFile(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return {};
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return {};
+    }
+    size_t size = file_stat.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return {};
+    }
+    std::vector<Graph*> methods = Deserialize(static_cast<const uint8_t*>(data), size);
+    munmap(data, size);
+    return methods;
+}
+
+bool IrDeserializer::Validate()
+{
+    for (uint32_t i = 0; i < header_->methods_num_; ++i) {
+        if (!ValidateMethod(method_records_[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IrDeserializer::ValidateMethod(const MethodRecord& method)
+{
+    if (!ValidateRange(method.name_begin_, method.name_size_, header_->chars_num_) ||
+        !ValidateRange(method.bbs_begin_, method.bbs_num_, header_->bbs_num_) ||
+        !ValidateRange(method.insts_begin_, method.insts_num_, header_->insts_num_) ||
+        !ValidateRange(method.intervals_begin_, method.intervals_num_, header_->intervals_num_) ||
+        !ValidateIndices(method.linear_order_begin_, method.linear_order_num_, method.bbs_num_)) {
+        return false;
+    }
+
+    uint64_t insts_num = 0;
+    for (uint32_t i = 0; i < method.bbs_num_; ++i) {
+        const BlockRecord& bb = bb_records_[method.bbs_begin_ + i];
+        insts_num += bb.insts_num_;
+        if (!ValidateIndices(bb.preds_begin_, bb.preds_num_, method.bbs_num_) ||
+            !ValidateIndices(bb.succs_begin_, bb.succs_num_, method.bbs_num_)) {
+            return false;
+        }
+    }
+    if (insts_num != method.insts_num_) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < method.insts_num_; ++i) {
+        const InstRecord& inst = inst_records_[method.insts_begin_ + i];
+        if (inst.opcode_ >= std::size(OPCODE_TYPES) ||
+            !ValidateRange(inst.operands_begin_, inst.operands_num_, header_->words_num_) ||
+            !ValidateIndices(inst.users_begin_, inst.users_num_, method.insts_num_)) {
+            return false;
+        }
+        const uint32_t* operands = words_ + inst.operands_begin_;
+        bool is_valid = false;
+        switch (OPCODE_TYPES[inst.opcode_]) {
+        case Type::InstWithTwoInputs:
+            is_valid = inst.operands_num_ == 2 && ValidateIndices(inst.operands_begin_, 2, method.insts_num_);
+            break;
+        case Type::InstWithOneInput:
+            is_valid = inst.operands_num_ == 1 && ValidateIndices(inst.operands_begin_, 1, method.insts_num_);
+            break;
+        case Type::InstPhi:
+            is_valid = inst.operands_num_ % 2 == 0 &&
+                       ValidateIndices(inst.operands_begin_, inst.operands_num_ / 2, method.insts_num_, 2) &&
+                       ValidateIndices(inst.operands_begin_ + 1, inst.operands_num_ / 2, method.bbs_num_, 2);
+            break;
+        case Type::InstCall:
+            is_valid = inst.operands_num_ >= 1 && operands[0] < header_->methods_num_ &&
+                       ValidateIndices(inst.operands_begin_ + 1, inst.operands_num_ - 1, method.insts_num_);
+            break;
+        case Type::InstJmp:
+            is_valid = inst.operands_num_ == 1 && operands[0] < method.bbs_num_;
+            break;
+        case Type::InstConstant:
+            is_valid = inst.operands_num_ == 1;
+            break;
+        default:
+            is_valid = inst.operands_num_ == 0;
+            break;
+        }
+        if (!is_valid) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < method.intervals_num_; ++i) {
+        if (interval_records_[method.intervals_begin_ + i].inst_index_ >= method.insts_num_) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IrDeserializer::ValidateRange(uint32_t begin, uint32_t num, uint32_t size)
+{
+    return uint64_t(begin) + num <= size;
+}
+
+bool IrDeserializer::ValidateIndices(uint32_t begin, uint32_t num, uint32_t bound, uint32_t step)
+{
+    if (num == 0) {
+        return true;
+    }
+    if (!ValidateRange(begin, uint64_t(num - 1) * step + 1, header_->words_num_)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < num; ++i) {
+        if (words_[begin + i * step] >= bound) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void IrDeserializer::DeserializeMethod(const MethodRecord& method, Graph* g)
+{
+    const BlockRecord* bb_records = bb_records_ + method.bbs_begin_;
+    const InstRecord* inst_records = inst_records_ + method.insts_begin_;
+
+    bbs_.resize(method.bbs_num_);
+    for (uint32_t i = 0; i < method.bbs_num_; ++i) {
+        bbs_[i] = new BasicBlock(bb_records[i].id_);
+        g->AddBasicBlock(bbs_[i]);
+    }
+
+    insts_.resize(method.insts_num_);
+    uint32_t inst_index = 0;
+    for (uint32_t i = 0; i < method.bbs_num_; ++i) {
+        const BlockRecord& record = bb_records[i];
+        for (uint32_t j = 0; j < record.preds_num_; ++j) {
+            bbs_[i]->AddPred(bbs_[words_[record.preds_begin_ + j]]);
+        }
+        for (uint32_t j = 0; j < record.succs_num_; ++j) {
+            bbs_[i]->AddSucc(bbs_[words_[record.succs_begin_ + j]]);
+        }
+        for (uint32_t j = 0; j < record.insts_num_; ++j, ++inst_index) {
+            const InstRecord& inst_record = inst_records[inst_index];
+            Inst* inst = Inst::InstBuilder(static_cast<Opcode>(inst_record.opcode_), inst_record.id_);
+            inst->SetLinearNumber(inst_record.linear_number_);
+            inst->SetLiveNumber(inst_record.live_number_);
+            bbs_[i]->PushBackInst(inst);
+            insts_[inst_index] = inst;
+        }
+    }
+    for (uint32_t i = 0; i < method.insts_num_; ++i) {
+        DeserializeInst(inst_records[i], insts_[i]);
+    }
+
+    std::vector<BasicBlock*> linear_order;
+    linear_order.reserve(method.linear_order_num_);
+    for (uint32_t i = 0; i < method.linear_order_num_; ++i) {
+        linear_order.push_back(bbs_[words_[method.linear_order_begin_ + i]]);
+    }
+    g->SetLinearOrder(linear_order);
+
+    ArenaAllocator& arena = g->GetContext()->GetArena();
+    std::unordered_map<Inst*, LiveInterval*> live_intervals;
+    live_intervals.reserve(method.intervals_num_);
+    for (uint32_t i = 0; i < method.intervals_num_; ++i) {
+        const IntervalRecord& record = interval_records_[method.intervals_begin_ + i];
+        LiveInterval* interval = arena.New<LiveInterval>(record.start_, record.end_);
+        interval->SetLocation(record.location_);
+        interval->SetIsStackLocation(record.is_stack_location_ != 0);
+        live_intervals[insts_[record.inst_index_]] = interval;
+    }
+    g->SetLiveIntervals(std::move(live_intervals));
+
+    if (method.next_inst_id_ != 0) {
+        g->GetContext()->GetInstIds().Skip(method.next_inst_id_ - 1);
+    }
+    if (method.next_bb_id_ != 0) {
+        g->GetContext()->GetBBIds().Skip(method.next_bb_id_ - 1);
+    }
+    g->SetInlineDepth(method.inline_depth_);
+    g->SetValidPasses(method.valid_passes_low_ | (PassMask(method.valid_passes_high_) << 32U));
+}
+
+void IrDeserializer::DeserializeInst(const InstRecord& record, Inst* inst)
+{
+    const uint32_t* operands = words_ + record.operands_begin_;
+    switch (inst->GetType()) {
+    case Type::InstWithTwoInputs:
+        inst->CastToInstWithTwoInputs()->SetInput1(insts_[operands[0]]);
+        inst->CastToInstWithTwoInputs()->SetInput2(insts_[operands[1]]);
+        break;
+    case Type::InstWithOneInput:
+        inst->CastToInstWithOneInput()->SetInput1(insts_[operands[0]]);
+        break;
+    case Type::InstPhi: {
+        std::vector<Inst*> input_insts;
+        std::vector<BasicBlock*> input_bbs;
+        input_insts.reserve(record.operands_num_ / 2);
+        input_bbs.reserve(record.operands_num_ / 2);
+        for (uint32_t i = 0; i < record.operands_num_; i += 2) {
+            input_insts.push_back(insts_[operands[i]]);
+            input_bbs.push_back(bbs_[operands[i + 1]]);
+        }
+        inst->CastToInstPhi()->SetInputInst(input_insts);
+        inst->CastToInstPhi()->SetInputBB(input_bbs);
+        break;
+    }
+    case Type::InstCall: {
+        inst->CastToInstCall()->SetCallee(methods_[operands[0]]);
+        std::vector<Inst*> arguments;
+        arguments.reserve(record.operands_num_ - 1);
+        for (uint32_t i = 1; i < record.operands_num_; ++i) {
+            arguments.push_back(insts_[operands[i]]);
+        }
+        inst->CastToInstCall()->SetArguments(std::move(arguments));
+        break;
+    }
+    case Type::InstJmp:
+        inst->CastToInstJmp()->SetTargetBB(bbs_[operands[0]]);
+        break;
+    case Type::InstConstant:
+        inst->CastToInstConstant()->SetConstant(static_cast<int32_t>(operands[0]));
+        break;
+    default:
+        break;
+    }
+
+    std::vector<Inst*> users;
+    users.reserve(record.users_num_);
+    for (uint32_t i = 0; i < record.users_num_; ++i) {
+        users.push_back(insts_[words_[record.users_begin_ + i]]);
+    }
+    inst->SetUsers(users);
+}
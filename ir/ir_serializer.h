@@ -0,0 +1,171 @@
+#ifndef IR_SERIALIZER_H
+#define IR_SERIALIZER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "graph.h"
+
+// Binary encoding of graphs for caching of compiled IR. File consists of
+// a header and arrays of fixed size records, which follow each other:
+//
+//     FileHeader
+//     MethodRecord[methods_num_]
+//     BlockRecord[bbs_num_]
+//     InstRecord[insts_num_]
+//     IntervalRecord[intervals_num_]
+//     uint32_t words_[words_num_]
+//     char chars_[chars_num_]
+//
+// Records consist of 32-bit words in native byte order, so a file, which
+// is mapped to memory, is read in place. Blocks and instructions refer to
+// each other by index within their method, variable length data, such as
+// inputs, users and edges, is stored in words_, names of methods in chars_.
+// VERSION is increased on every change of the encoding, including changes
+// of OPCODE_LIST and PassList
+namespace ir_serialization {
+
+constexpr uint32_t MAGIC = 0x52494F43; // "COIR"
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+    uint32_t magic_ = MAGIC;
+    uint32_t version_ = VERSION;
+    // of the whole file
+    uint32_t size_ = 0;
+    uint32_t methods_num_ = 0;
+    uint32_t bbs_num_ = 0;
+    uint32_t insts_num_ = 0;
+    uint32_t intervals_num_ = 0;
+    uint32_t words_num_ = 0;
+    uint32_t chars_num_ = 0;
+};
+
+struct MethodRecord {
+    uint32_t name_begin_ = 0;
+    uint32_t name_size_ = 0;
+    uint32_t bbs_begin_ = 0;
+    uint32_t bbs_num_ = 0;
+    uint32_t insts_begin_ = 0;
+    uint32_t insts_num_ = 0;
+    uint32_t intervals_begin_ = 0;
+    uint32_t intervals_num_ = 0;
+    // block indices in words_
+    uint32_t linear_order_begin_ = 0;
+    uint32_t linear_order_num_ = 0;
+    // next ids of the context
+    uint32_t next_inst_id_ = 0;
+    uint32_t next_bb_id_ = 0;
+    uint32_t inline_depth_ = 0;
+    uint32_t valid_passes_low_ = 0;
+    uint32_t valid_passes_high_ = 0;
+};
+
+// instructions of a block follow instructions of the previous block
+struct BlockRecord {
+    uint32_t id_ = 0;
+    uint32_t insts_num_ = 0;
+    uint32_t preds_begin_ = 0;
+    uint32_t preds_num_ = 0;
+    uint32_t succs_begin_ = 0;
+    uint32_t succs_num_ = 0;
+};
+
+// operands depend on type: input indices, pairs of input and block indices
+// for phi, method index followed by argument indices for call, target
+// block index for jmp, value for constant
+struct InstRecord {
+    uint32_t id_ = 0;
+    uint32_t opcode_ = 0;
+    uint32_t operands_begin_ = 0;
+    uint32_t operands_num_ = 0;
+    uint32_t users_begin_ = 0;
+    uint32_t users_num_ = 0;
+    uint32_t linear_number_ = 0;
+    uint32_t live_number_ = 0;
+};
+
+struct IntervalRecord {
+    uint32_t inst_index_ = 0;
+    uint32_t start_ = 0;
+    uint32_t end_ = 0;
+    uint32_t location_ = 0;
+    uint32_t is_stack_location_ = 0;
+};
+
+} // namespace ir_serialization
+
+class IrSerializer
+{
+public:
+    // callees, which are not in graphs, are serialized after graphs.
+    // Returned data is valid until the next call
+    const std::vector<uint8_t>& Serialize(const std::vector<Graph*>& graphs);
+    void SerializeToFile(const std::vector<Graph*>& graphs, const std::string& path);
+
+private:
+    void AddMethod(Graph* g);
+    void SerializeMethod(Graph* g);
+    void SerializeInst(Inst* inst, ir_serialization::InstRecord* record);
+    uint32_t GetIndex(BasicBlock* bb);
+    uint32_t GetIndex(Inst* inst);
+
+    std::vector<Graph*> methods_;
+    std::unordered_map<Graph*, uint32_t> method_indices_;
+    // of the current method
+    std::unordered_map<BasicBlock*, uint32_t> bb_indices_;
+    std::unordered_map<Inst*, uint32_t> inst_indices_;
+
+    std::vector<ir_serialization::MethodRecord> method_records_;
+    std::vector<ir_serialization::BlockRecord> bb_records_;
+    std::vector<ir_serialization::InstRecord> inst_records_;
+    std::vector<ir_serialization::IntervalRecord> interval_records_;
+    std::vector<uint32_t> words_;
+    std::string chars_;
+    std::vector<uint8_t> buffer_;
+};
+
+// Results of analyses of CFG are not serialized, so they are invalid
+// in deserialized graphs, results of other passes keep their validity
+class IrDeserializer
+{
+public:
+    // graphs are built in the given context, or each in a context of its own
+    explicit IrDeserializer(CompilationContext* context = nullptr) : context_(context) {}
+
+    // data must be aligned to 4 bytes. Returns empty vector if data
+    // is of another version or corrupted
+    std::vector<Graph*> Deserialize(const uint8_t* data, size_t size);
+    // file is mapped to memory and read in place
+    std::vector<Graph*> DeserializeFile(const std::string& path);
+
+private:
+    // checks that all records and indices are in bounds, so that
+    // graphs are built without checks
+    bool Validate();
+    bool ValidateMethod(const ir_serialization::MethodRecord& method);
+    bool ValidateRange(uint32_t begin, uint32_t num, uint32_t size);
+    bool ValidateIndices(uint32_t begin, uint32_t num, uint32_t bound, uint32_t step = 1);
+
+    void DeserializeMethod(const ir_serialization::MethodRecord& method, Graph* g);
+    void DeserializeInst(const ir_serialization::InstRecord& record, Inst* inst);
+
+    CompilationContext* context_ = nullptr;
+
+    const ir_serialization::FileHeader* header_ = nullptr;
+    const ir_serialization::MethodRecord* method_records_ = nullptr;
+    const ir_serialization::BlockRecord* bb_records_ = nullptr;
+    const ir_serialization::InstRecord* inst_records_ = nullptr;
+    const ir_serialization::IntervalRecord* interval_records_ = nullptr;
+    const uint32_t* words_ = nullptr;
+    const char* chars_ = nullptr;
+
+    std::vector<Graph*> methods_;
+    // of the current method
+    std::vector<BasicBlock*> bbs_;
+    std::vector<Inst*> insts_;
+};
+
+#endif // IR_SERIALIZER_H
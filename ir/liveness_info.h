@@ -3,38 +3,10 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <set>
 
 #include "utils.h"
 #include "inst.h"
 
-class LiveSet
-{
-public:
-    LiveSet() = default;
-    ACCESSOR_MUTATOR(live_set_, LiveSet, std::set<Inst*>&)
-
-    void AddInst(Inst* inst)
-    {
-        live_set_.insert(inst);
-    }
-
-    void Union(LiveSet& live_set)
-    {
-        for (auto item: live_set.GetLiveSet()) {
-            live_set_.insert(item);
-        }
-    }
-
-    void RemoveInst(Inst* inst)
-    {
-        live_set_.erase(inst);
-    }
-
-private:
-    std::set<Inst*> live_set_;
-};
-
 class LiveInterval
 {
 public:
@@ -35,6 +35,27 @@ public:
         return blocks_;
     }
 
+    // number of enclosing loops, root loop has zero depth
+    uint32_t GetDepth()
+    {
+        uint32_t depth = 0;
+        for (Loop* loop = outer_loop_; loop != nullptr; loop = loop->GetOuterLoop()) {
+            depth++;
+        }
+        return depth;
+    }
+
+    // true if block belongs to this loop or to one of its inner loops
+    bool Contains(BasicBlock* block)
+    {
+        for (Loop* loop = block->GetLoop(); loop != nullptr; loop = loop->GetOuterLoop()) {
+            if (loop == this) {
+                return true;
+            }
+        }
+        return false;
+    }
+
 private:
 
     BasicBlock *back_edge_source_ = nullptr;
@@ -1,29 +1,34 @@
 #ifndef MARKER_H
 #define MARKER_H
 
-#include <array>
 #include <cassert>
 #include <bitset>
 #include <limits>
 
 #include "utils.h"
 
+// marker holds epoch and slot, object is marked, if it has the epoch
+// of the marker and the bit of its slot. New epoch starts, when no
+// markers are alive, so that slots are reused without clearing objects
 using marker = uint32_t;
-constexpr uint8_t MARKER_NUM = 4;
-constexpr uint8_t SLOT_BITS = 4;
-constexpr uint8_t SLOT_MASK = 0b1111;
-constexpr marker MAX_EPOCH = std::numeric_limits<uint32_t>::max() & 0b10000;
+constexpr uint8_t MARKER_NUM = 32;
+constexpr uint8_t SLOT_BITS = 5;
+constexpr uint8_t SLOT_MASK = 0b11111;
+constexpr marker MAX_EPOCH = std::numeric_limits<marker>::max() >> SLOT_BITS;
 
 class MarkerManager {
 public:
     marker NewMarker() {
-        current_epoch_++;
-        for (int i = 0; i < slots_.size(); ++i) {
-            if (!slots_[i]) {
-                assert(current_epoch_ < MAX_EPOCH);
-                slots_[i] = true;
-                marker mrk = (current_epoch_ << SLOT_BITS) | i;
-                return mrk;
+        if (live_slots_.none()) {
+            current_epoch_++;
+            assert(current_epoch_ < MAX_EPOCH);
+            used_slots_.reset();
+        }
+        for (uint8_t i = 0; i < MARKER_NUM; ++i) {
+            if (!live_slots_[i] && !used_slots_[i]) {
+                live_slots_[i] = true;
+                used_slots_[i] = true;
+                return (current_epoch_ << SLOT_BITS) | i;
             }
         }
         UNREACHABLE()
@@ -31,38 +36,63 @@ public:
 
     void EraseMarker(marker mrk) {
         uint8_t slot = mrk & SLOT_MASK;
-        slots_[slot] = 0;
+        assert(live_slots_[slot]);
+        live_slots_[slot] = false;
+    }
+
+    // slot of an erased marker may keep bits in objects until the epoch
+    // ends, such slots are reused after objects are cleared by ResetSlots
+    bool HasCleanSlot() {
+        return (live_slots_ | used_slots_).count() != MARKER_NUM;
+    }
+
+    uint32_t GetDirtySlots() {
+        return (used_slots_ & ~live_slots_).to_ulong();
+    }
+
+    void SetSlotsCleared() {
+        used_slots_ = live_slots_;
     }
 
 private:
-    uint32_t current_epoch_ = 0;
-    std::bitset<MARKER_NUM> slots_;
+    marker current_epoch_ = 0;
+    std::bitset<MARKER_NUM> live_slots_;
+    // slots allocated in current epoch
+    std::bitset<MARKER_NUM> used_slots_;
 };
 
 class Markers {
 public:
     void SetMarker(marker mrk)
     {
-        uint8_t slot = mrk & SLOT_MASK;
         uint32_t epoch = mrk >> SLOT_BITS;
-        markers_[slot] = epoch;
+        if (epoch_ != epoch) {
+            epoch_ = epoch;
+            slots_ = 0;
+        }
+        slots_ |= 1U << (mrk & SLOT_MASK);
     }
 
     void ResetMarker(marker mrk)
     {
-        uint8_t slot = mrk & SLOT_MASK;
-        markers_[slot] = 0;
+        if (epoch_ == mrk >> SLOT_BITS) {
+            slots_ &= ~(1U << (mrk & SLOT_MASK));
+        }
     }
 
     bool IsMarked(marker mrk)
     {
-        uint32_t slot = mrk & SLOT_MASK;
-        uint32_t epoch = mrk >> SLOT_BITS;
-        return markers_[slot] == epoch;
+        return epoch_ == mrk >> SLOT_BITS && (slots_ & (1U << (mrk & SLOT_MASK))) != 0;
+    }
+
+    void ResetSlots(uint32_t slots)
+    {
+        slots_ &= ~slots;
     }
 
 private:
-    std::array<marker, MARKER_NUM> markers_;
+    uint32_t epoch_ = 0;
+    uint32_t slots_ = 0;
 };
 
 #endif  // MARKER_H
@@ -1,6 +1,8 @@
 #ifndef OPCODES_H
 #define OPCODES_H
 
+#include <string_view>
+
 #define TYPE_LIST(FUNC)                                                                                                \
     FUNC(InstWithTwoInputs)                                                                                            \
     FUNC(InstWithOneInput)                                                                                             \
@@ -52,6 +54,13 @@ enum class Opcode
     SIZE
 };
 
+// indexed by opcode
+inline constexpr std::string_view OPCODE_NAMES[] = {
+#define INIT_OPCODE_NAMES(name, type) #name,
+    OPCODE_LIST(INIT_OPCODE_NAMES)
+#undef INIT_OPCODE_NAMES
+};
+
 enum class Type
 {
 #define INIT_TYPES(type) type,
@@ -61,4 +70,11 @@ enum class Type
     SIZE
 };
 
+// indexed by opcode
+inline constexpr Type OPCODE_TYPES[] = {
+#define INIT_OPCODE_TYPES(name, type) Type::type,
+    OPCODE_LIST(INIT_OPCODE_TYPES)
+#undef INIT_OPCODE_TYPES
+};
+
 #endif // OPCODES_H
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <map>
+#include <string>
+
+#include "pass_profiler.h"
+
+void PassProfiler::BeginPass(const char* pass_name, uint32_t insts, uint32_t bbs, size_t allocated_size)
+{
+    Record record;
+    record.pass_name_ = pass_name;
+    record.depth_ = open_records_.size();
+    record.start_ns_ = GetTimeNs();
+    // allocated size at start is kept here until the pass ends
+    record.alloc_bytes_ = allocated_size;
+    record.insts_before_ = insts;
+    record.bbs_before_ = bbs;
+    open_records_.push_back(records_.size());
+    records_.push_back(record);
+}
+
+void PassProfiler::EndPass(uint32_t insts, uint32_t bbs, size_t allocated_size)
+{
+    assert(!open_records_.empty());
+    Record& record = records_[open_records_.back()];
+    open_records_.pop_back();
+    record.duration_ns_ = GetTimeNs() - record.start_ns_;
+    record.self_ns_ += record.duration_ns_;
+    record.alloc_bytes_ = allocated_size - record.alloc_bytes_;
+    record.insts_after_ = insts;
+    record.bbs_after_ = bbs;
+    if (!open_records_.empty()) {
+        records_[open_records_.back()].self_ns_ -= record.duration_ns_;
+    }
+}
+
+uint64_t PassProfiler::GetTimeNs()
+{
+    auto time = std::chrono::steady_clock::now() - origin_;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+void PassProfiler::DumpReport(std::ostream& out)
+{
+    struct Total {
+        const char* pass_name_ = nullptr;
+        uint32_t runs_ = 0;
+        uint64_t duration_ns_ = 0;
+        int64_t self_ns_ = 0;
+        size_t alloc_bytes_ = 0;
+        int64_t insts_delta_ = 0;
+        int64_t bbs_delta_ = 0;
+    };
+    std::map<std::string, Total> totals_map;
+    for (const auto& record: records_) {
+        Total& total = totals_map[record.pass_name_];
+        total.pass_name_ = record.pass_name_;
+        total.runs_++;
+        total.duration_ns_ += record.duration_ns_;
+        total.self_ns_ += record.self_ns_;
+        total.alloc_bytes_ += record.alloc_bytes_;
+        total.insts_delta_ += static_cast<int64_t>(record.insts_after_) - record.insts_before_;
+        total.bbs_delta_ += static_cast<int64_t>(record.bbs_after_) - record.bbs_before_;
+    }
+    std::vector<Total> totals;
+    for (const auto& item: totals_map) {
+        totals.push_back(item.second);
+    }
+    auto comparator = [](const Total& lhs, const Total& rhs) { return lhs.self_ns_ > rhs.self_ns_; };
+    std::stable_sort(totals.begin(), totals.end(), comparator);
+
+    out << std::left << std::setw(20) << "pass" << std::right << std::setw(8) << "runs" << std::setw(12) << "total us"
+        << std::setw(12) << "self us" << std::setw(14) << "alloc bytes" << std::setw(10) << "insts"
+        << std::setw(8) << "bbs" << "\n";
+    for (const auto& total: totals) {
+        out << std::left << std::setw(20) << total.pass_name_ << std::right << std::setw(8) << total.runs_
+            << std::setw(12) << total.duration_ns_ / 1000 << std::setw(12) << total.self_ns_ / 1000
+            << std::setw(14) << total.alloc_bytes_ << std::setw(10) << std::showpos << total.insts_delta_
+            << std::setw(8) << total.bbs_delta_ << std::noshowpos << "\n";
+    }
+}
+
+void PassProfiler::DumpJson(std::ostream& out)
+{
+    out << "[";
+    for (size_t i = 0; i < records_.size(); ++i) {
+        const Record& record = records_[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "  {\"pass\": \"" << record.pass_name_ << "\", \"depth\": " << record.depth_
+            << ", \"start_ns\": " << record.start_ns_ << ", \"duration_ns\": " << record.duration_ns_
+            << ", \"self_ns\": " << record.self_ns_ << ", \"alloc_bytes\": " << record.alloc_bytes_
+            << ", \"insts_before\": " << record.insts_before_ << ", \"insts_after\": " << record.insts_after_
+            << ", \"bbs_before\": " << record.bbs_before_ << ", \"bbs_after\": " << record.bbs_after_ << "}";
+    }
+    out << "\n]\n";
+}
+
+// complete events, nesting is restored by the viewer from their intervals
+void PassProfiler::DumpChromeTrace(std::ostream& out)
+{
+    out << "{\"traceEvents\": [";
+    for (size_t i = 0; i < records_.size(); ++i) {
+        const Record& record = records_[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "  {\"name\": \"" << record.pass_name_ << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"
+            << std::fixed << std::setprecision(3) << ", \"ts\": " << record.start_ns_ / 1000.0
+            << ", \"dur\": " << record.duration_ns_ / 1000.0 << std::defaultfloat
+            << ", \"args\": {\"alloc_bytes\": " << record.alloc_bytes_ << ", \"insts_before\": "
+            << record.insts_before_ << ", \"insts_after\": " << record.insts_after_ << ", \"bbs_before\": "
+            << record.bbs_before_ << ", \"bbs_after\": " << record.bbs_after_ << "}}";
+    }
+    out << "\n], \"displayTimeUnit\": \"ns\"}\n";
+}
@@ -0,0 +1,75 @@
+#ifndef PASS_PROFILER_H
+#define PASS_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Time, allocated memory and IR size of every pass run, recorded by PassManager
+// when profiler is enabled. Passes run as requirements of another pass
+// are nested into its record, so its time includes theirs, and self time
+// is the time of the pass alone
+class PassProfiler
+{
+public:
+    struct Record {
+        const char* pass_name_ = nullptr;
+        // number of enclosing records
+        uint32_t depth_ = 0;
+        // relative to creation of the profiler
+        uint64_t start_ns_ = 0;
+        uint64_t duration_ns_ = 0;
+        int64_t self_ns_ = 0;
+        // bytes allocated by arena and for instructions
+        size_t alloc_bytes_ = 0;
+        uint32_t insts_before_ = 0;
+        uint32_t insts_after_ = 0;
+        uint32_t bbs_before_ = 0;
+        uint32_t bbs_after_ = 0;
+    };
+
+    PassProfiler() : origin_(std::chrono::steady_clock::now()) {}
+
+    void Enable(bool is_enabled = true)
+    {
+        is_enabled_ = is_enabled;
+    }
+
+    bool IsEnabled()
+    {
+        return is_enabled_;
+    }
+
+    void BeginPass(const char* pass_name, uint32_t insts, uint32_t bbs, size_t allocated_size);
+    void EndPass(uint32_t insts, uint32_t bbs, size_t allocated_size);
+
+    // in order of pass starts
+    const std::vector<Record>& GetRecords()
+    {
+        return records_;
+    }
+
+    void Clear()
+    {
+        records_.clear();
+        open_records_.clear();
+    }
+
+    // totals per pass, the slowest passes first
+    void DumpReport(std::ostream& out);
+    void DumpJson(std::ostream& out);
+    // trace event format, which is opened by chrome://tracing and Perfetto
+    void DumpChromeTrace(std::ostream& out);
+
+private:
+    uint64_t GetTimeNs();
+
+    std::vector<Record> records_;
+    // indices of records of running passes, innermost last
+    std::vector<size_t> open_records_;
+    std::chrono::steady_clock::time_point origin_;
+    bool is_enabled_ = false;
+};
+
+#endif // PASS_PROFILER_H
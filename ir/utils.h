@@ -2,6 +2,7 @@
 #define UTILS_H
 
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <vector>
 
@@ -21,6 +22,43 @@
         field_name = accessor_name;                                                                                    \
     }
 
+// view of contiguous elements, which are owned by another object
+template <typename T>
+class Span
+{
+public:
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    T* begin() const
+    {
+        return data_;
+    }
+
+    T* end() const
+    {
+        return data_ + size_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t index) const
+    {
+        return data_[index];
+    }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
 void throw_inst_error(const std::string& msg, Opcode op_in);
 void throw_error(const std::string& msg);
 
@@ -0,0 +1,89 @@
+#include <algorithm>
+
+#include "call_graph.h"
+
+void CallGraph::Build(const std::vector<Graph*>& graphs)
+{
+    callees_.clear();
+    graphs_.clear();
+    bottom_up_order_.clear();
+    scc_ids_.clear();
+    scc_sizes_.clear();
+    indices_.clear();
+    low_links_.clear();
+    stack_.clear();
+    next_index_ = 0;
+
+    for (auto g: graphs) {
+        AddGraph(g);
+    }
+    for (auto g: graphs_) {
+        if (indices_.count(g) == 0) {
+            VisitGraph(g);
+        }
+    }
+}
+
+void CallGraph::AddGraph(Graph* g)
+{
+    std::vector<Graph*> worklist = {g};
+    while (!worklist.empty()) {
+        Graph* cur = worklist.back();
+        worklist.pop_back();
+        if (callees_.count(cur) != 0) {
+            continue;
+        }
+        graphs_.push_back(cur);
+        auto& callees = callees_[cur];
+        for (auto inst: cur->Insts(Opcode::CALL_STATIC)) {
+            Graph* callee = inst->CastToInstCall()->GetCallee();
+            if (callee != nullptr && std::find(callees.begin(), callees.end(), callee) == callees.end()) {
+                callees.push_back(callee);
+                worklist.push_back(callee);
+            }
+        }
+    }
+}
+
+// component is completed only after all components reachable from it,
+// so components are emitted in bottom-up order
+void CallGraph::VisitGraph(Graph* g)
+{
+    indices_[g] = next_index_;
+    low_links_[g] = next_index_;
+    next_index_++;
+    stack_.push_back(g);
+
+    for (auto callee: callees_[g]) {
+        if (indices_.count(callee) == 0) {
+            VisitGraph(callee);
+            low_links_[g] = std::min(low_links_[g], low_links_[callee]);
+        } else if (scc_ids_.count(callee) == 0) {
+            // callee is still on stack
+            low_links_[g] = std::min(low_links_[g], indices_[callee]);
+        }
+    }
+
+    if (low_links_[g] != indices_[g]) {
+        return;
+    }
+    uint32_t scc_id = scc_sizes_.size();
+    scc_sizes_.push_back(0);
+    Graph* member = nullptr;
+    do {
+        member = stack_.back();
+        stack_.pop_back();
+        scc_ids_[member] = scc_id;
+        scc_sizes_[scc_id]++;
+        bottom_up_order_.push_back(member);
+    } while (member != g);
+}
+
+bool CallGraph::IsRecursive(Graph* g)
+{
+    if (scc_sizes_[scc_ids_.at(g)] > 1) {
+        return true;
+    }
+    auto& callees = callees_.at(g);
+    return std::find(callees.begin(), callees.end(), g) != callees.end();
+}
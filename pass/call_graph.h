@@ -0,0 +1,64 @@
+#ifndef CALL_GRAPH_H
+#define CALL_GRAPH_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "ir/graph.h"
+
+// Static call graph of a compilation unit: given graphs and all graphs
+// reachable from them through CALL_STATIC
+class CallGraph {
+public:
+    void Build(const std::vector<Graph*>& graphs);
+
+    bool HasGraph(Graph* g)
+    {
+        return callees_.count(g) != 0;
+    }
+
+    const std::vector<Graph*>& GetCallees(Graph* g)
+    {
+        return callees_.at(g);
+    }
+
+    // callees precede their callers, graphs of one cycle are adjacent
+    const std::vector<Graph*>& GetBottomUpOrder()
+    {
+        return bottom_up_order_;
+    }
+
+    // true if g may call itself directly or through other graphs
+    bool IsRecursive(Graph* g);
+
+    // graphs calling each other share a component, components
+    // are numbered bottom-up starting from zero
+    uint32_t GetComponentId(Graph* g)
+    {
+        return scc_ids_.at(g);
+    }
+
+    uint32_t GetComponentsNum()
+    {
+        return scc_sizes_.size();
+    }
+
+private:
+    void AddGraph(Graph* g);
+    void VisitGraph(Graph* g);
+
+    std::unordered_map<Graph*, std::vector<Graph*>> callees_;
+    std::vector<Graph*> graphs_;
+    std::vector<Graph*> bottom_up_order_;
+
+    // strongly connected components, found by Tarjan's algorithm
+    std::unordered_map<Graph*, uint32_t> scc_ids_;
+    std::vector<uint32_t> scc_sizes_;
+
+    std::unordered_map<Graph*, uint32_t> indices_;
+    std::unordered_map<Graph*, uint32_t> low_links_;
+    std::vector<Graph*> stack_;
+    uint32_t next_index_ = 0;
+};
+
+#endif // CALL_GRAPH_H
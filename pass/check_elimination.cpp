@@ -1,52 +1,267 @@
 #include "check_elimination.h"
 #include "dom_tree_fast.h"
+#include "loop_analyzer.h"
 
-void CheckElimination::RunPassImpl(Graph *g)
+bool CheckElimination::RunPassImpl(Graph *g)
 {
-    g->RunPass<DomTreeFast>();
+    for (auto loop: g->GetRootLoop()->GetInnerLoops()) {
+        HoistChecks(loop, g);
+    }
+
+    removed_marker_ = g->NewMarker();
+    touched_marker_ = g->NewMarker();
+
+    BuildDomTreeChildren(g);
+    VisitBlock(g->GetBasicBlocks()[0]);
+    g->GetContext()->GetStatistics().Add("CheckElimination.RemovedChecks", removed_checks_.size());
+    RemoveScheduledChecks();
+
+    g->EraseMarker(removed_marker_);
+    g->EraseMarker(touched_marker_);
+    return is_changed_;
+}
+
+// inner loops are processed first, so a check can be hoisted
+// through several levels of nesting
+void CheckElimination::HoistChecks(Loop* loop, Graph *g)
+{
+    for (auto inner_loop: loop->GetInnerLoops()) {
+        HoistChecks(inner_loop, g);
+    }
+
+    BasicBlock* preheader = GetPreheader(loop);
+    if (preheader == nullptr) {
+        return;
+    }
+
+    // reversing, since blocks in loop are stored in reversed order
+    std::vector<Inst*> checks;
+    for (auto it = loop->GetBlocks().rbegin(); it != loop->GetBlocks().rend(); ++it) {
+        BasicBlock* bb = *it;
+        if (!IsExecutedOnEveryIteration(bb, loop, g)) {
+            continue;
+        }
+        for (auto inst: bb->Insts()) {
+            if (IsCheck(inst) && IsLoopInvariant(inst, loop)) {
+                checks.push_back(inst);
+            }
+        }
+    }
+
+    is_changed_ |= !checks.empty();
+    g->GetContext()->GetStatistics().Add("CheckElimination.HoistedChecks", checks.size());
+    for (auto check: checks) {
+        check->GetBB()->UnbindInst(check);
+        Inst* preheader_last = preheader->GetLastInst();
+        if (preheader_last != nullptr && preheader_last->GetType() == Type::InstJmp) {
+            preheader->InsertInst(preheader_last, check);
+        } else {
+            preheader->PushBackInst(check);
+        }
+    }
+}
+
+// the only predecessor of header outside of the loop,
+// provided that it has no other successors
+BasicBlock* CheckElimination::GetPreheader(Loop* loop)
+{
+    BasicBlock* preheader = nullptr;
+    for (auto pred: loop->GetHeader()->GetPreds()) {
+        if (loop->Contains(pred)) {
+            continue;
+        }
+        if (preheader != nullptr) {
+            return nullptr;
+        }
+        preheader = pred;
+    }
+
+    if (preheader == nullptr || preheader->GetSuccs().size() != 1) {
+        return nullptr;
+    }
+    return preheader;
+}
 
-    auto bbs = g->GetBasicBlocks();
-    for (BasicBlock* bb: bbs) {
-        for (Inst *inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
-            if (inst->GetOpcode() == Opcode::CHECK_EQ_ZERO) {
-                TryEliminateCheckOneInput(inst, g);
-            } else if (inst->GetOpcode() == Opcode::CHECK_EQ) {
-                TryEliminateCheckTwoInput(inst, g);
+bool CheckElimination::IsLoopInvariant(Inst* inst, Loop* loop)
+{
+    if (inst->GetType() == Type::InstWithOneInput) {
+        return !loop->Contains(inst->CastToInstWithOneInput()->GetInput1()->GetBB());
+    }
+    auto inst_casted = inst->CastToInstWithTwoInputs();
+    return !loop->Contains(inst_casted->GetInput1()->GetBB()) && !loop->Contains(inst_casted->GetInput2()->GetBB());
+}
+
+// block dominates every exit from the loop and the back edge, so a check placed
+// in it is executed whenever the loop is entered and hoisting it does not
+// introduce a failure on a path which did not fail before
+bool CheckElimination::IsExecutedOnEveryIteration(BasicBlock* bb, Loop* loop, Graph *g)
+{
+    auto dominates = [g, bb](BasicBlock* other) { return bb == other || g->CheckDominance(bb, other); };
+
+    if (!dominates(loop->GetBackEdgeSource())) {
+        return false;
+    }
+    for (auto loop_bb: loop->GetBlocks()) {
+        for (auto succ: loop_bb->GetSuccs()) {
+            if (!loop->Contains(succ) && !dominates(loop_bb)) {
+                return false;
             }
         }
     }
+    return true;
 }
 
-void CheckElimination::TryEliminateCheckOneInput(Inst* inst, Graph *g)
+void CheckElimination::BuildDomTreeChildren(Graph *g)
 {
-    Inst* input = inst->CastToInstWithOneInput()->GetInput1();
-    for (auto input_user: input->GetUsers()) {
-        if (input_user->GetOpcode() == inst->GetOpcode() && input_user != inst &&
-            g->CheckDominance(input_user, inst)) {
-            input->RemoveUser(inst);
-            delete inst;
+    for (auto bb: g->GetBasicBlocks()) {
+        if (bb->GetIDom() != nullptr) {
+            dom_children_[bb->GetIDom()].push_back(bb);
         }
     }
 }
 
-void CheckElimination::TryEliminateCheckTwoInput(Inst* inst, Graph *g)
+// preorder walk over dominator tree: checks available on entry to bb
+// are exactly the checks from its dominators and the facts implied by
+// the edges leading to them
+void CheckElimination::VisitBlock(BasicBlock* bb)
 {
-    Inst* input1 = inst->CastToInstWithTwoInputs()->GetInput1();
-    Inst* input2 = inst->CastToInstWithTwoInputs()->GetInput2();
-    for (auto input_user: input1->GetUsers()) {
-        if (input_user->GetOpcode() == inst->GetOpcode() && input_user != inst &&
-            CheckInputsEqual(input_user->CastToInstWithTwoInputs(), inst->CastToInstWithTwoInputs()) &&
-            g->CheckDominance(input_user, inst)) {
-            input1->RemoveUser(inst);
-            input2->RemoveUser(inst);
-            delete inst;
+    size_t scope_start = scope_keys_.size();
+
+    AddBranchFacts(bb);
+    for (auto inst: bb->InstsSafe()) {
+        if (IsCheck(inst)) {
+            CheckKey key = MakeKey(inst);
+            if (available_checks_.count(key) != 0) {
+                ScheduleRemoval(inst);
+            } else {
+                AddAvailableCheck(key);
+            }
         }
     }
+
+    for (auto child: dom_children_[bb]) {
+        VisitBlock(child);
+    }
+
+    while (scope_keys_.size() > scope_start) {
+        available_checks_.erase(scope_keys_.back());
+        scope_keys_.pop_back();
+    }
 }
 
-// works only with equal instruction, maybe remove it
-bool CheckElimination::CheckInputsEqual(InstWithTwoInputs* inst1, InstWithTwoInputs* inst2)
+// if bb can only be reached through the "equal" edge of a comparison,
+// checks of the same equality are redundant in all blocks dominated by bb
+void CheckElimination::AddBranchFacts(BasicBlock* bb)
 {
-    return ((inst1->GetInput1() == inst2->GetInput1()) && (inst1->GetInput2() == inst2->GetInput2())) ||
-           ((inst1->GetInput2() == inst2->GetInput1()) && (inst1->GetInput1() == inst2->GetInput2()));
-}
\ No newline at end of file
+    if (bb->GetPreds().size() != 1) {
+        return;
+    }
+    Inst* cmp = GetEqualityCondition(bb->GetPreds()[0], bb);
+    if (cmp == nullptr) {
+        return;
+    }
+
+    auto cmp_casted = cmp->CastToInstWithTwoInputs();
+    AddAvailableCheck(MakeKey(Opcode::CHECK_EQ, cmp_casted->GetInput1(), cmp_casted->GetInput2()));
+
+    auto is_zero = [](Inst* inst) {
+        return inst->GetOpcode() == Opcode::CONSTANT && inst->CastToInstConstant()->GetConstant() == 0;
+    };
+    if (is_zero(cmp_casted->GetInput2())) {
+        AddAvailableCheck(MakeKey(Opcode::CHECK_EQ_ZERO, cmp_casted->GetInput1(), nullptr));
+    }
+    if (is_zero(cmp_casted->GetInput1())) {
+        AddAvailableCheck(MakeKey(Opcode::CHECK_EQ_ZERO, cmp_casted->GetInput2(), nullptr));
+    }
+}
+
+void CheckElimination::AddAvailableCheck(const CheckKey& key)
+{
+    if (available_checks_.insert(key).second) {
+        scope_keys_.push_back(key);
+    }
+}
+
+// returns cmp instruction whose operands are equal when control goes from pred to succ
+Inst* CheckElimination::GetEqualityCondition(BasicBlock* pred, BasicBlock* succ)
+{
+    if (pred->GetSuccs().size() != 2 || pred->GetSuccs()[0] == pred->GetSuccs()[1]) {
+        return nullptr;
+    }
+    Inst* jmp = pred->GetLastInst();
+    if (jmp == nullptr || jmp->GetPrev() == nullptr || jmp->GetPrev()->GetOpcode() != Opcode::CMP) {
+        return nullptr;
+    }
+
+    if ((jmp->GetOpcode() == Opcode::JMP_EQ && pred->GetSuccs()[BasicBlock::TRUE_BRANCH_INDEX] == succ) ||
+        (jmp->GetOpcode() == Opcode::JMP_NE && pred->GetSuccs()[BasicBlock::FALSE_BRANCH_INDEX] == succ)) {
+        return jmp->GetPrev();
+    }
+    return nullptr;
+}
+
+// check is unlinked from its block at once, but users of its inputs are
+// updated in RemoveScheduledChecks, so that removing many checks of the
+// same value costs a single pass over the users of that value
+void CheckElimination::ScheduleRemoval(Inst* check)
+{
+    check->SetMarker(removed_marker_);
+    check->GetBB()->UnbindInst(check);
+    removed_checks_.push_back(check);
+
+    Inst* inputs[] = {nullptr, nullptr};
+    if (check->GetType() == Type::InstWithOneInput) {
+        inputs[0] = check->CastToInstWithOneInput()->GetInput1();
+    } else {
+        inputs[0] = check->CastToInstWithTwoInputs()->GetInput1();
+        inputs[1] = check->CastToInstWithTwoInputs()->GetInput2();
+    }
+    for (auto input: inputs) {
+        if (input != nullptr && !input->IsMarked(touched_marker_)) {
+            input->SetMarker(touched_marker_);
+            touched_inputs_.push_back(input);
+        }
+    }
+}
+
+void CheckElimination::RemoveScheduledChecks()
+{
+    marker removed_marker = removed_marker_;
+    for (auto input: touched_inputs_) {
+        std::vector<Inst*> users = input->GetUsers();
+        auto is_removed = [removed_marker](Inst* user) { return user->IsMarked(removed_marker); };
+        users.erase(std::remove_if(users.begin(), users.end(), is_removed), users.end());
+        input->SetUsers(users);
+    }
+
+    is_changed_ |= !removed_checks_.empty();
+    for (auto check: removed_checks_) {
+        Inst::InstDestroyer(check);
+    }
+    removed_checks_.clear();
+    touched_inputs_.clear();
+}
+
+bool CheckElimination::IsCheck(Inst* inst)
+{
+    return inst->GetOpcode() == Opcode::CHECK_EQ_ZERO || inst->GetOpcode() == Opcode::CHECK_EQ;
+}
+
+CheckElimination::CheckKey CheckElimination::MakeKey(Opcode opcode, Inst* input1, Inst* input2)
+{
+    if (opcode == Opcode::CHECK_EQ && std::less<Inst*>()(input2, input1)) {
+        std::swap(input1, input2);
+    }
+    return {opcode, input1, input2};
+}
+
+CheckElimination::CheckKey CheckElimination::MakeKey(Inst* check)
+{
+    if (check->GetType() == Type::InstWithOneInput) {
+        return MakeKey(check->GetOpcode(), check->CastToInstWithOneInput()->GetInput1(), nullptr);
+    }
+    auto check_casted = check->CastToInstWithTwoInputs();
+    return MakeKey(check->GetOpcode(), check_casted->GetInput1(), check_casted->GetInput2());
+}
+
+template bool PassManager::RunPass<CheckElimination>(Graph *g);
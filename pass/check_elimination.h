@@ -1,17 +1,69 @@
 #ifndef CHECK_ELIMINATION_H
 #define CHECK_ELIMINATION_H
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "ir/graph.h"
 
+// CHECK_EQ passes when its inputs are equal, CHECK_EQ_ZERO when its input is zero
 class CheckElimination {
 public:
-    void RunPassImpl(Graph *g);
+    // returns false if no check was hoisted or removed
+    bool RunPassImpl(Graph *g);
 
 private:
-    void TryEliminateCheckOneInput(Inst* inst, Graph *g);
-    void TryEliminateCheckTwoInput(Inst* inst, Graph *g);
+    // check is identified by opcode and inputs, inputs of CHECK_EQ are ordered
+    // since equality is symmetric, CHECK_EQ_ZERO has nullptr as the second input
+    struct CheckKey {
+        Opcode opcode_ = Opcode::DEFAULT;
+        Inst* input1_ = nullptr;
+        Inst* input2_ = nullptr;
+
+        bool operator==(const CheckKey& other) const
+        {
+            return opcode_ == other.opcode_ && input1_ == other.input1_ && input2_ == other.input2_;
+        }
+    };
+
+    struct CheckKeyHash {
+        size_t operator()(const CheckKey& key) const
+        {
+            size_t hash = std::hash<Inst*>()(key.input1_);
+            hash ^= std::hash<Inst*>()(key.input2_) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash ^ static_cast<size_t>(key.opcode_);
+        }
+    };
+
+    void HoistChecks(Loop* loop, Graph *g);
+    BasicBlock* GetPreheader(Loop* loop);
+    bool IsLoopInvariant(Inst* inst, Loop* loop);
+    bool IsExecutedOnEveryIteration(BasicBlock* bb, Loop* loop, Graph *g);
+
+    void BuildDomTreeChildren(Graph *g);
+    void VisitBlock(BasicBlock* bb);
+    void AddBranchFacts(BasicBlock* bb);
+    void AddAvailableCheck(const CheckKey& key);
+    Inst* GetEqualityCondition(BasicBlock* pred, BasicBlock* succ);
+
+    void ScheduleRemoval(Inst* check);
+    void RemoveScheduledChecks();
+
+    static bool IsCheck(Inst* inst);
+    static CheckKey MakeKey(Opcode opcode, Inst* input1, Inst* input2);
+    static CheckKey MakeKey(Inst* check);
+
+    std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> dom_children_;
+    // checks available in the current dominator tree scope
+    std::unordered_set<CheckKey, CheckKeyHash> available_checks_;
+    // keys in order of insertion, used to leave scopes
+    std::vector<CheckKey> scope_keys_;
 
-    bool CheckInputsEqual(InstWithTwoInputs* inst1, InstWithTwoInputs* inst2);
+    std::vector<Inst*> removed_checks_;
+    std::vector<Inst*> touched_inputs_;
+    marker removed_marker_ = 0;
+    marker touched_marker_ = 0;
+    bool is_changed_ = false;
 };
 
 #endif // CHECK_ELIMINATION_H
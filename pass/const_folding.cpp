@@ -2,19 +2,21 @@
 #include "rpo.h"
 #include "dce.h"
 
-void ConstFolding::RunPassImpl(Graph *g)
+bool ConstFolding::RunPassImpl(Graph *g)
 {
-    g->RunPass<RPO>();
-
+    rewritten_ = false;
     auto rpo_bbs = g->GetRPOBasicBlocks();
     for (BasicBlock* bb: rpo_bbs) {
-        for (Inst *inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        for (auto inst: bb->Insts()) {
             table_[static_cast<size_t>(inst->GetOpcode())](inst);
         }
     }
 
+    // rewritten instructions are detached from blocks and left for DCE,
+    // new constants change graph even if DCE removes nothing
     g->SetPassValidity<DCE>(false);
-    g->RunPass<DCE>();
+    bool is_dce_changed = g->RunPass<DCE>();
+    return rewritten_ || is_dce_changed;
 }
 
 bool ConstFolding::CheckConstInput(InstWithTwoInputs *inst)
@@ -25,9 +27,12 @@ bool ConstFolding::CheckConstInput(InstWithTwoInputs *inst)
 
 void ConstFolding::CreateNewConstant(Inst* old_inst, int32_t constant)
 {
-    Inst* new_inst = Inst::InstBuilder<Opcode::CONSTANT>(Inst::NextId());
+    rewritten_ = true;
+    Graph* g = old_inst->GetBB()->GetGraph();
+    g->GetContext()->GetStatistics().Add("ConstFolding.FoldedInsts");
+    Inst* new_inst = Inst::InstBuilder<Opcode::CONSTANT>(g->NewInstId());
     static_cast<InstConstant*>(new_inst)->SetConstant(constant);
-    old_inst->GetBB()->PushFrontInst(new_inst);
+    old_inst->GetBB()->InsertAfterPhis(new_inst);
     for (auto user: old_inst->GetUsers()) {
         new_inst->AddUser(user);
         user->SubstituteInput(old_inst, new_inst);
@@ -70,3 +75,5 @@ void ConstFolding::VisitXOR(Inst *inst)
                           inst_casted->GetInput2()->CastToInstConstant()->GetConstant();
     CreateNewConstant(inst, fold_result);
 }
+
+template bool PassManager::RunPass<ConstFolding>(Graph *g);
@@ -1,12 +1,15 @@
 #ifndef CONST_FOLDING_H
 #define CONST_FOLDING_H
 
+#include <array>
+
 #include "ir/graph.h"
 #include "visitor.h"
 
 class ConstFolding : public InstVisitor {
 public:
-    void RunPassImpl(Graph *g);
+    // returns false if nothing was rewritten
+    bool RunPassImpl(Graph *g);
 
 private:
     static void VisitSUB(Inst *inst);
@@ -16,6 +19,10 @@ private:
     static bool CheckConstInput(InstWithTwoInputs *inst);
     static void CreateNewConstant(Inst* old_inst, int32_t constant);
 
+    // set by visitors, which are static, so that they fit the dispatch table,
+    // graphs of one thread are optimized one at a time
+    static inline thread_local bool rewritten_ = false;
+
     #define BUILD_DISPATCH_TABLE(name, type)    \
     Visit##name,
 
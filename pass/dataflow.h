@@ -0,0 +1,236 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ir/bit_vector.h"
+#include "ir/graph.h"
+#include "rpo.h"
+
+// Iterative solver of bit-vector dataflow problems. Problem describes:
+//   static constexpr bool IS_FORWARD - facts flow from preds to succs
+//   static constexpr bool IS_UNION - meet is union, intersection otherwise
+//   static constexpr const char* NAME - prefix of statistics counters
+//   uint32_t GetBitsNum()
+//   void InitBlock(BasicBlock* bb, BitVector& gen, BitVector& kill)
+//   void InitBoundary(BitVector& facts) - facts at entry or at exits
+//   void AddEdgeFacts(BasicBlock* pred, BasicBlock* succ, BitVector& facts) - e.g. phi inputs,
+//       called once for every edge, facts are added to the facts flowing along it
+// Transfer of a block is gen | (facts & ~kill). Blocks are visited in RPO
+// for forward problems and in RPO of reversed CFG for backward ones, a block
+// is visited again only if facts of its neighbours were changed.
+// Blocks, which are not reachable from entry, are skipped.
+template <typename Problem>
+class DataflowSolver
+{
+public:
+    void Solve(Graph* g, Problem& problem);
+
+    // facts at the start and at the end of bb in program order
+    const BitVector& GetEntryFacts(BasicBlock* bb)
+    {
+        return Problem::IS_FORWARD ? meet_[index_.at(bb)] : result_[index_.at(bb)];
+    }
+
+    const BitVector& GetExitFacts(BasicBlock* bb)
+    {
+        return Problem::IS_FORWARD ? result_[index_.at(bb)] : meet_[index_.at(bb)];
+    }
+
+    // passes over dirty blocks and transfers computed until convergence
+    uint32_t GetPassesNum()
+    {
+        return passes_num_;
+    }
+
+    uint32_t GetVisitsNum()
+    {
+        return visits_num_;
+    }
+
+private:
+    // edge in direction of analysis, facts are empty if it adds nothing
+    struct Edge {
+        uint32_t source_;
+        BitVector facts_;
+    };
+
+    void InitBackwardOrder(const std::vector<BasicBlock*>& rpo);
+    void InitEdges(Problem& problem);
+    void Meet(Problem& problem, uint32_t index);
+
+    std::vector<BasicBlock*> order_;
+    std::unordered_map<BasicBlock*, uint32_t> index_;
+    // indexed by position in order_
+    std::vector<std::vector<Edge>> edges_;
+    std::vector<std::vector<uint32_t>> dependents_;
+    std::vector<BitVector> gen_;
+    std::vector<BitVector> kill_;
+    std::vector<BitVector> meet_;
+    std::vector<BitVector> result_;
+    std::vector<bool> is_dirty_;
+    uint32_t passes_num_ = 0;
+    uint32_t visits_num_ = 0;
+};
+
+template <typename Problem>
+void DataflowSolver<Problem>::Solve(Graph* g, Problem& problem)
+{
+    g->RunPass<RPO>();
+    if constexpr (Problem::IS_FORWARD) {
+        order_ = g->GetRPOBasicBlocks();
+    } else {
+        InitBackwardOrder(g->GetRPOBasicBlocks());
+    }
+
+    uint32_t bits_num = problem.GetBitsNum();
+    index_.clear();
+    gen_.assign(order_.size(), BitVector(bits_num));
+    kill_.assign(order_.size(), BitVector(bits_num));
+    meet_.assign(order_.size(), BitVector(bits_num));
+    result_.assign(order_.size(), BitVector(bits_num));
+    is_dirty_.assign(order_.size(), true);
+    for (uint32_t i = 0; i < order_.size(); i++) {
+        index_[order_[i]] = i;
+        problem.InitBlock(order_[i], gen_[i], kill_[i]);
+        // optimistic start, so that loops converge to the greatest fixed point
+        if constexpr (!Problem::IS_UNION) {
+            result_[i].SetAll();
+        }
+    }
+    InitEdges(problem);
+
+    passes_num_ = 0;
+    visits_num_ = 0;
+    bool has_dirty = true;
+    while (has_dirty) {
+        has_dirty = false;
+        passes_num_++;
+        for (uint32_t i = 0; i < order_.size(); i++) {
+            if (!is_dirty_[i]) {
+                continue;
+            }
+            is_dirty_[i] = false;
+            visits_num_++;
+            Meet(problem, i);
+            if (!result_[i].Transfer(meet_[i], gen_[i], kill_[i])) {
+                continue;
+            }
+            for (auto dependent: dependents_[i]) {
+                is_dirty_[dependent] = true;
+                // blocks later in the order are visited in this pass
+                has_dirty |= dependent <= i;
+            }
+        }
+    }
+
+    auto& statistics = g->GetContext()->GetStatistics();
+    statistics.Add(std::string(Problem::NAME) + ".DataflowPasses", passes_num_);
+    statistics.Add(std::string(Problem::NAME) + ".DataflowVisits", visits_num_);
+}
+
+// RPO of reversed CFG, so that facts reach blocks of a loop from its exits
+// and latches in one pass. Blocks, which reach no exit, are visited last
+template <typename Problem>
+void DataflowSolver<Problem>::InitBackwardOrder(const std::vector<BasicBlock*>& rpo)
+{
+    std::unordered_map<BasicBlock*, bool> is_visited;
+    for (auto bb: rpo) {
+        is_visited[bb] = false;
+    }
+    std::vector<BasicBlock*> post_order;
+    // block and index of its next pred
+    std::vector<std::pair<BasicBlock*, size_t>> stack;
+    auto visit = [&is_visited, &post_order, &stack](BasicBlock* root) {
+        if (is_visited[root]) {
+            return;
+        }
+        is_visited[root] = true;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            BasicBlock* bb = stack.back().first;
+            size_t pred_index = stack.back().second++;
+            if (pred_index == bb->GetPreds().size()) {
+                post_order.push_back(bb);
+                stack.pop_back();
+                continue;
+            }
+            auto it = is_visited.find(bb->GetPreds()[pred_index]);
+            if (it != is_visited.end() && !it->second) {
+                it->second = true;
+                stack.emplace_back(it->first, 0);
+            }
+        }
+    };
+    for (auto bb = rpo.rbegin(); bb != rpo.rend(); bb++) {
+        if ((*bb)->GetSuccs().empty()) {
+            visit(*bb);
+        }
+    }
+    for (auto bb = rpo.rbegin(); bb != rpo.rend(); bb++) {
+        visit(*bb);
+    }
+    order_.assign(post_order.rbegin(), post_order.rend());
+}
+
+// blocks, which are not reachable from entry, neither send nor receive facts
+template <typename Problem>
+void DataflowSolver<Problem>::InitEdges(Problem& problem)
+{
+    edges_.assign(order_.size(), {});
+    dependents_.assign(order_.size(), {});
+    for (uint32_t i = 0; i < order_.size(); i++) {
+        BasicBlock* bb = order_[i];
+        const auto& sources = Problem::IS_FORWARD ? bb->GetPreds() : bb->GetSuccs();
+        for (auto source: sources) {
+            auto it = index_.find(source);
+            if (it == index_.end()) {
+                continue;
+            }
+            BitVector facts(problem.GetBitsNum());
+            if constexpr (Problem::IS_FORWARD) {
+                problem.AddEdgeFacts(source, bb, facts);
+            } else {
+                problem.AddEdgeFacts(bb, source, facts);
+            }
+            edges_[i].push_back({it->second, facts.IsEmpty() ? BitVector() : std::move(facts)});
+            dependents_[it->second].push_back(i);
+        }
+    }
+}
+
+template <typename Problem>
+void DataflowSolver<Problem>::Meet(Problem& problem, uint32_t index)
+{
+    BitVector& facts = meet_[index];
+    bool is_boundary = Problem::IS_FORWARD ? index == 0 : order_[index]->GetSuccs().empty();
+    if (is_boundary || Problem::IS_UNION) {
+        facts.ResetAll();
+    } else {
+        facts.SetAll();
+    }
+    if (is_boundary) {
+        problem.InitBoundary(facts);
+    }
+
+    for (const auto& edge: edges_[index]) {
+        const BitVector& source_facts = result_[edge.source_];
+        if constexpr (Problem::IS_UNION) {
+            facts.Union(source_facts);
+            if (edge.facts_.GetSize() != 0) {
+                facts.Union(edge.facts_);
+            }
+        } else if (edge.facts_.GetSize() != 0) {
+            BitVector edge_facts = source_facts;
+            edge_facts.Union(edge.facts_);
+            facts.Intersect(edge_facts);
+        } else {
+            facts.Intersect(source_facts);
+        }
+    }
+}
+
+#endif // DATAFLOW_H
@@ -1,27 +1,29 @@
 #include "dce.h"
 
-void DCE::RunPassImpl(Graph *g)
+bool DCE::RunPassImpl(Graph *g)
 {
     // mark
     marker sweep_marker = g->NewMarker();
     for (BasicBlock* bb: g->GetBasicBlocks()) {
-        for (Inst *inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        for (auto inst: bb->Insts()) {
             if (inst->GetBB() == nullptr)
                 MarkRecursively(inst, sweep_marker);
         }
     }
 
     // sweep
+    bool is_changed = false;
     for (BasicBlock* bb: g->GetBasicBlocks()) {
-        for (Inst *inst = bb->GetFirstInst(); inst != nullptr;) {
-            Inst *next = inst->GetNext();
+        for (auto inst: bb->InstsSafe()) {
             if (inst->IsMarked(sweep_marker)) {
                 DeleteInst(inst, bb);
+                g->GetContext()->GetStatistics().Add("DCE.RemovedInsts");
+                is_changed = true;
             }
-            inst = next;
         }
     }
     g->EraseMarker(sweep_marker);
+    return is_changed;
 }
 
 void DCE::MarkRecursively(Inst* inst, marker sweep_marker)
@@ -31,23 +33,17 @@ void DCE::MarkRecursively(Inst* inst, marker sweep_marker)
     }
     inst->SetMarker(sweep_marker);
 
-    if (inst->GetType() != Type::InstWithTwoInputs)
-        return;
-
-    auto input1 = inst->CastToInstWithTwoInputs()->GetInput1();
-    auto input2 = inst->CastToInstWithTwoInputs()->GetInput2();
-
-    input1->RemoveUser(inst);
-    if (input1->GetUsers().size() == 0) {
-        MarkRecursively(input1, sweep_marker);
-    }
-
-    if (input1 == input2)
-        return;
-    
-    input2->RemoveUser(inst);
-    if (input2->GetUsers().size() == 0) {
-        MarkRecursively(input2, sweep_marker);
+    auto inputs = inst->GetInputs();
+    for (auto it = inputs.begin(); it != inputs.end(); ++it) {
+        Inst* input = *it;
+        // users are unique, so inst is removed once for repeated inputs
+        if (std::find(inputs.begin(), it, input) != it) {
+            continue;
+        }
+        input->RemoveUser(inst);
+        if (input->GetUsers().empty()) {
+            MarkRecursively(input, sweep_marker);
+        }
     }
 }
 
@@ -58,5 +54,7 @@ void DCE::DeleteInst(Inst* inst, BasicBlock* bb)
     if (bb->GetLastInst() == inst)
         bb->SetLastInst(inst->GetPrev());
     bb->SetSize(bb->GetSize() - 1);
-    delete inst;
+    Inst::InstDestroyer(inst);
 }
+
+template bool PassManager::RunPass<DCE>(Graph *g);
@@ -5,7 +5,8 @@
 
 class DCE {
 public:
-    void RunPassImpl(Graph *g);
+    // returns false if nothing was removed
+    bool RunPassImpl(Graph *g);
 
 private:
     void MarkRecursively(Inst* inst, marker mrk);
@@ -19,13 +19,15 @@ void DomTreeFast::RunPassImpl(Graph *g)
         auto& bucket_entity = bucket[(*node)->parent_->dfs_num_];
         for (auto v = bucket_entity.begin(); v != bucket_entity.end();) {
             auto next = std::next(v, 1);
-            bucket_entity.remove(*v);
+            // copy node, since remove() destroys the element *v refers to
+            HelperNode *v_node = *v;
+            bucket_entity.remove(v_node);
 
-            HelperNode *u = eval(*v);
-            if (u->sdom_dfs_num_ < (*v)->sdom_dfs_num_) {
-                (*v)->dom_ = u;
+            HelperNode *u = eval(v_node);
+            if (u->sdom_dfs_num_ < v_node->sdom_dfs_num_) {
+                v_node->dom_ = u;
             } else {
-                (*v)->dom_ = (*node)->parent_;
+                v_node->dom_ = (*node)->parent_;
             }
 
             v = next;
@@ -109,3 +111,5 @@ std::vector<DomTreeFast::HelperNode*> DomTreeFast::GetPreOrder(Graph *g)
     g->EraseMarker(visited_marker);
     return result_vector;
 }
+
+template bool PassManager::RunPass<DomTreeFast>(Graph *g);
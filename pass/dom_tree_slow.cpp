@@ -31,3 +31,5 @@ void DomTreeSlow::RunPassImpl(Graph* g)
         g->SetPassValidity<RPO>(false); // TODO remove this
     }
 }
+
+template bool PassManager::RunPass<DomTreeSlow>(Graph *g);
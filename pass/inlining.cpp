@@ -1,23 +1,112 @@
 #include "inlining.h"
+#include "ir/graph_cloner.h"
+#include "dom_tree_fast.h"
+#include "loop_analyzer.h"
 #include "rpo.h"
 
-void Inlining::RunPassImpl(Graph* g)
+bool Inlining::RunPassImpl(Graph* g)
+{
+    // inlined callees do not add graphs to the call graph of the unit
+    call_graph_ = g->GetContext()->GetCallGraph();
+    if (call_graph_ == nullptr || !call_graph_->HasGraph(g)) {
+        own_call_graph_.Build({g});
+        call_graph_ = &own_call_graph_;
+    }
+
+    std::vector<CallSite> call_sites;
+    for (auto bb: g->GetBasicBlocks()) {
+        uint32_t loop_depth = bb->GetLoop() == nullptr ? 0 : bb->GetLoop()->GetDepth();
+        CollectCallSites({bb}, loop_depth, 0, call_sites);
+    }
+
+    // the hottest and the smallest callees get the budget first
+    auto comparator = [](const CallSite& lhs, const CallSite& rhs) {
+        if (lhs.loop_depth_ != rhs.loop_depth_) {
+            return lhs.loop_depth_ > rhs.loop_depth_;
+        }
+        return lhs.callee_size_ < rhs.callee_size_;
+    };
+
+    bool is_changed = false;
+    // calls brought by inlined callees are considered in the next round
+    while (!call_sites.empty()) {
+        std::stable_sort(call_sites.begin(), call_sites.end(), comparator);
+        std::vector<CallSite> nested_call_sites;
+        for (const auto& call_site: call_sites) {
+            if (!ShouldInline(call_site, g)) {
+                continue;
+            }
+            Graph* callee = call_site.call_inst_->CastToInstCall()->GetCallee();
+            uint32_t inline_depth = call_site.inline_depth_ + callee->GetInlineDepth() + 1;
+            g->SetInlinedSize(g->GetInlinedSize() + call_site.callee_size_);
+            std::vector<BasicBlock*> inlined_bbs = InlineStaticMethod(call_site.call_inst_);
+            g->GetContext()->GetStatistics().Add("Inlining.InlinedCalls");
+            g->GetContext()->GetStatistics().Add("Inlining.InlinedInsts", call_site.callee_size_);
+            g->SetInlineDepth(std::max(g->GetInlineDepth(), inline_depth));
+            CollectCallSites(inlined_bbs, call_site.loop_depth_, inline_depth, nested_call_sites);
+            is_changed = true;
+        }
+        call_sites = std::move(nested_call_sites);
+    }
+
+    return is_changed;
+}
+
+// call sites are collected before they are inlined, since
+// inlining splits blocks and moves instructions between them
+void Inlining::CollectCallSites(const std::vector<BasicBlock*>& bbs, uint32_t loop_depth, uint32_t inline_depth,
+                                std::vector<CallSite>& call_sites)
 {
-    auto bbs = g->GetBasicBlocks();
     for (BasicBlock* bb: bbs) {
-        for (Inst *inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
-            // suppose it's better to save list of call instructions while building graph
-            // but for the first time let's be primitive
-            if (inst->GetOpcode() == Opcode::CALL_STATIC) {
-                InlineStaticMethod(inst);
+        for (auto inst: bb->Insts(Opcode::CALL_STATIC)) {
+            CallSite call_site;
+            call_site.call_inst_ = inst;
+            call_site.callee_size_ = GetGraphSize(inst->CastToInstCall()->GetCallee());
+            call_site.loop_depth_ = loop_depth;
+            call_site.inline_depth_ = inline_depth;
+            for (auto arg: inst->CastToInstCall()->GetArguments()) {
+                if (arg->GetOpcode() == Opcode::CONSTANT) {
+                    call_site.const_args_++;
+                }
             }
+            call_sites.push_back(call_site);
         }
     }
 }
 
-void Inlining::InlineStaticMethod(Inst* call_inst)
+bool Inlining::ShouldInline(const CallSite& call_site, Graph* caller)
+{
+    Graph* callee = call_site.call_inst_->CastToInstCall()->GetCallee();
+    // recursion can only be unrolled, never flattened
+    if (call_graph_->IsRecursive(callee)) {
+        return false;
+    }
+    if (call_site.inline_depth_ + callee->GetInlineDepth() + 1 > MAX_INLINE_DEPTH) {
+        return false;
+    }
+
+    uint32_t max_size = MAX_CALLEE_SIZE + call_site.loop_depth_ * LOOP_DEPTH_BONUS +
+                        call_site.const_args_ * CONST_ARG_BONUS;
+    uint32_t inlined_size = caller->GetInlinedSize();
+    return call_site.callee_size_ <= max_size && inlined_size + call_site.callee_size_ <= INLINE_BUDGET;
+}
+
+uint32_t Inlining::GetGraphSize(Graph* g)
+{
+    uint32_t size = 0;
+    for (auto bb: g->GetBasicBlocks()) {
+        size += bb->GetSize();
+    }
+    return size;
+}
+
+// callee itself is left intact, a copy of it is consumed instead,
+// so the same callee may be inlined at many call sites,
+// returns blocks of the copy, which now belong to the caller
+std::vector<BasicBlock*> Inlining::InlineStaticMethod(Inst* call_inst)
 {
-    Graph* callee = call_inst->CastToInstCall()->GetCallee();
+    Graph* callee = GraphCloner().CloneGraph(call_inst->CastToInstCall()->GetCallee(),
+                                              call_inst->GetBB()->GetGraph()->GetContext());
 
     SubstituteUsersInputsForArgs(callee, call_inst);
 
@@ -28,7 +117,10 @@ void Inlining::InlineStaticMethod(Inst* call_inst)
     SplitMoveAndConnectBlocks(callee, call_inst, callee_ret_bbs);
     
     call_inst->GetBB()->PopBackInst();
+    std::vector<BasicBlock*> inlined_bbs = callee->GetBasicBlocks();
     callee->Clear();
+    delete callee;
+    return inlined_bbs;
 }
 
 void Inlining::SubstituteUsersInputsForArgs(Graph* callee, Inst* call_inst)
@@ -36,7 +128,10 @@ void Inlining::SubstituteUsersInputsForArgs(Graph* callee, Inst* call_inst)
     // substitute users and inputs for arguments
     for (auto arg: call_inst->CastToInstCall()->GetArguments()) {
         Inst* callee_param = callee->GetBasicBlocks()[0]->GetFirstInst();
-        arg->RemoveUser(call_inst);
+        // the same argument may be passed several times, call is its user once
+        if (arg->HasUser(call_inst)) {
+            arg->RemoveUser(call_inst);
+        }
         for (auto callee_param_user: callee_param->GetUsers()) {
             arg->AddUser(callee_param_user);
             callee_param_user->SubstituteInput(callee_param, arg);
@@ -52,6 +147,10 @@ std::vector<BasicBlock*> Inlining::ProcessReturns(Graph* callee, Inst* call_inst
     std::vector<Inst*> returns;
     int ret_counter = 0;
     for (auto bb_callee: callee->GetBasicBlocks()) {
+        // entry block of a callee with inlined calls may consist of parameters only
+        if (bb_callee->GetLastInst() == nullptr) {
+            continue;
+        }
         if (bb_callee->GetLastInst()->GetOpcode() == Opcode::RET || bb_callee->GetLastInst()->GetOpcode() == Opcode::RET_VOID ||
             bb_callee->GetLastInst()->GetOpcode() == Opcode::THROW) {
             if (bb_callee->GetLastInst()->GetOpcode() == Opcode::RET)
@@ -63,11 +162,12 @@ std::vector<BasicBlock*> Inlining::ProcessReturns(Graph* callee, Inst* call_inst
     if (ret_counter > 0) {
         Inst* call_result_inst = nullptr;
         if (ret_counter > 1) {
-            call_result_inst = Inst::InstBuilder<Opcode::PHI>(Inst::NextId());
+            call_result_inst = Inst::InstBuilder<Opcode::PHI>(caller_inst_bb->GetGraph()->NewInstId());
             for (auto ret_inst: returns) {
                 if (ret_inst->GetOpcode() != Opcode::THROW) {
                     auto ret_inst_casted = ret_inst->CastToInstWithOneInput();
-                    call_result_inst->CastToInstPhi()->AddInput(ret_inst_casted->GetInput1(), ret_inst_casted->GetInput1()->GetBB());
+                    // value comes along the edge from the returning block
+                    call_result_inst->CastToInstPhi()->AddInput(ret_inst_casted->GetInput1(), ret_inst->GetBB());
                     ret_inst_casted->GetInput1()->AddUser(call_result_inst);
                 }
             }
@@ -77,7 +177,9 @@ std::vector<BasicBlock*> Inlining::ProcessReturns(Graph* callee, Inst* call_inst
                 caller_inst_bb->InsertInst(call_inst->GetNext(), call_result_inst);
             }
         } else {
-            call_result_inst = returns[0]->CastToInstWithOneInput()->GetInput1();
+            auto ret_inst = std::find_if(returns.begin(), returns.end(),
+                                         [](Inst* inst) { return inst->GetOpcode() == Opcode::RET; });
+            call_result_inst = (*ret_inst)->CastToInstWithOneInput()->GetInput1();
         }
         for (auto user: call_inst->GetUsers()) {
             call_result_inst->AddUser(user);
@@ -87,6 +189,9 @@ std::vector<BasicBlock*> Inlining::ProcessReturns(Graph* callee, Inst* call_inst
     // remove ret instructions from callee graph
     std::vector<BasicBlock*> callee_ret_bbs;
     for (auto bb_callee: callee->GetBasicBlocks()) {
+        if (bb_callee->GetLastInst() == nullptr) {
+            continue;
+        }
         if (bb_callee->GetLastInst()->GetOpcode() == Opcode::RET ||
             bb_callee->GetLastInst()->GetOpcode() == Opcode::RET_VOID) {
             if (bb_callee->GetLastInst()->GetOpcode() == Opcode::RET) {
@@ -95,27 +200,30 @@ std::vector<BasicBlock*> Inlining::ProcessReturns(Graph* callee, Inst* call_inst
             bb_callee->PopBackInst();
             callee_ret_bbs.push_back(bb_callee);
         }
-        if (bb_callee->GetLastInst()->GetOpcode() == Opcode::THROW) {
-            callee_ret_bbs.push_back(bb_callee);
-        }
     }
     
     return callee_ret_bbs;
 }
 
+// constants are placed after parameters of the caller, since parameters
+// are taken by position, when the caller is inlined itself
 void Inlining::MoveConstants(Graph* callee, Inst* call_inst)
 {
-    BasicBlock* caller_inst_bb = call_inst->GetBB();
-    // move constants from callee to caller
-    Inst* first_callee_inst = callee->GetBasicBlocks()[0]->GetFirstInst();
-    while (first_callee_inst->GetOpcode() == Opcode::CONSTANT) {
-        // unbind from callee first basic block
-        first_callee_inst->GetBB()->UnbindFrontInst();
-        // bind to caller first basic block
-        first_callee_inst->SetNext(nullptr); // hack
-        caller_inst_bb->GetGraph()->GetBasicBlocks()[0]->PushFrontInst(first_callee_inst);
-
-        first_callee_inst = callee->GetBasicBlocks()[0]->GetFirstInst();
+    BasicBlock* caller_first_bb = call_inst->GetBB()->GetGraph()->GetBasicBlocks()[0];
+    Inst* first_non_param = caller_first_bb->GetFirstInst();
+    while (first_non_param != nullptr && first_non_param->GetOpcode() == Opcode::PARAMETER) {
+        first_non_param = first_non_param->GetNext();
+    }
+    BasicBlock* callee_first_bb = callee->GetBasicBlocks()[0];
+    Inst* first_callee_inst = callee_first_bb->GetFirstInst();
+    while (first_callee_inst != nullptr && first_callee_inst->GetOpcode() == Opcode::CONSTANT) {
+        callee_first_bb->UnbindFrontInst();
+        if (first_non_param != nullptr) {
+            caller_first_bb->InsertInst(first_non_param, first_callee_inst);
+        } else {
+            caller_first_bb->PushBackInst(first_callee_inst);
+        }
+        first_callee_inst = callee_first_bb->GetFirstInst();
     }
 }
 
@@ -123,11 +231,12 @@ void Inlining::SplitMoveAndConnectBlocks(Graph* callee, Inst* call_inst, const s
 {
     BasicBlock* caller_inst_bb = call_inst->GetBB();
     // split block with call instruction
-    BasicBlock* call_cont_block = new BasicBlock(BasicBlock::NextId());
+    BasicBlock* call_cont_block = new BasicBlock(caller_inst_bb->GetGraph()->NewBBId());
     // move all instructions after call inst to call_cont_block
     while(caller_inst_bb->GetLastInst() != call_inst) {
-        call_cont_block->PushFrontInst(caller_inst_bb->GetLastInst());
+        Inst* last_inst = caller_inst_bb->GetLastInst();
         caller_inst_bb->UnbindBackInst();
+        call_cont_block->PushFrontInst(last_inst);
     }
 
     // move callee blocks to caller
@@ -137,8 +246,10 @@ void Inlining::SplitMoveAndConnectBlocks(Graph* callee, Inst* call_inst, const s
     }
     caller_inst_bb->GetGraph()->AddBasicBlock(call_cont_block);
 
-    // connect blocks
-    for (auto call_block_succ: caller_inst_bb->GetSuccs()) {
+    // connect blocks, successors are copied since they are removed while iterating
+    auto call_block_succs = caller_inst_bb->GetSuccs();
+    for (auto call_block_succ: call_block_succs) {
+        ReplacePhiInputBB(call_block_succ, caller_inst_bb, call_cont_block);
         call_cont_block->AddSucc(call_block_succ);
         call_block_succ->RemovePred(caller_inst_bb);
         call_block_succ->AddPred(call_cont_block);
@@ -150,4 +261,15 @@ void Inlining::SplitMoveAndConnectBlocks(Graph* callee, Inst* call_inst, const s
         callee_ret_bb->AddSucc(call_cont_block);
         call_cont_block->AddPred(callee_ret_bb);
     }
-}
\ No newline at end of file
+}
+
+void Inlining::ReplacePhiInputBB(BasicBlock* bb, BasicBlock* old_pred, BasicBlock* new_pred)
+{
+    for (auto inst: bb->Phis()) {
+        auto input_bbs = inst->CastToInstPhi()->GetInputBB();
+        std::replace(input_bbs.begin(), input_bbs.end(), old_pred, new_pred);
+        inst->CastToInstPhi()->SetInputBB(input_bbs);
+    }
+}
+
+template bool PassManager::RunPass<Inlining>(Graph *g);
@@ -2,18 +2,52 @@
 #define INLINING_H
 
 #include "ir/graph.h"
+#include "call_graph.h"
 
 class Inlining {
 public:
-    void RunPassImpl(Graph *g);
+    // returns false if no call was inlined
+    bool RunPassImpl(Graph *g);
+
+    // callee is inlined if its size does not exceed MAX_CALLEE_SIZE plus bonuses
+    // for every loop around the call site and for every constant argument
+    static constexpr uint32_t MAX_CALLEE_SIZE = 40;
+    static constexpr uint32_t LOOP_DEPTH_BONUS = 20;
+    static constexpr uint32_t CONST_ARG_BONUS = 5;
+    // total number of instructions which may be inlined into one method by all
+    // runs of the pass, so that it does not grow without bound; other methods
+    // of the unit do not affect it
+    static constexpr uint32_t INLINE_BUDGET = 400;
+    // calls from inlined callees are inlined as well, up to this nesting
+    static constexpr uint32_t MAX_INLINE_DEPTH = 4;
 
 private:
-    void InlineStaticMethod(Inst* call_inst);
+    struct CallSite {
+        Inst* call_inst_ = nullptr;
+        uint32_t callee_size_ = 0;
+        uint32_t loop_depth_ = 0;
+        uint32_t const_args_ = 0;
+        // nesting of inlined code the call belongs to, 0 for calls of the caller itself
+        uint32_t inline_depth_ = 0;
+    };
+
+    void CollectCallSites(const std::vector<BasicBlock*>& bbs, uint32_t loop_depth, uint32_t inline_depth,
+                          std::vector<CallSite>& call_sites);
+    bool ShouldInline(const CallSite& call_site, Graph* caller);
+    static uint32_t GetGraphSize(Graph* g);
+
+    std::vector<BasicBlock*> InlineStaticMethod(Inst* call_inst);
 
     void SubstituteUsersInputsForArgs(Graph* callee, Inst* call_inst);
     std::vector<BasicBlock*> ProcessReturns(Graph* callee, Inst* call_inst);
     void MoveConstants(Graph* callee, Inst* call_inst);
     void SplitMoveAndConnectBlocks(Graph* callee, Inst* call_inst, const std::vector<BasicBlock*>& callee_ret_bbs);
+    // phis of bb take inputs from new_pred instead of old_pred
+    void ReplacePhiInputBB(BasicBlock* bb, BasicBlock* old_pred, BasicBlock* new_pred);
+
+    // call graph of InliningDriver, or own_call_graph_ built for the graph
+    CallGraph* call_graph_ = nullptr;
+    CallGraph own_call_graph_;
 };
 
 #endif // INLINING_H
@@ -0,0 +1,13 @@
+#include "inlining_driver.h"
+#include "inlining.h"
+
+void InliningDriver::Run(const std::vector<Graph*>& graphs)
+{
+    call_graph_.Build(graphs);
+    for (auto g: call_graph_.GetBottomUpOrder()) {
+        CompilationContext* context = g->GetContext();
+        context->SetCallGraph(&call_graph_);
+        g->RunPass<Inlining>();
+        context->SetCallGraph(nullptr);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef INLINING_DRIVER_H
+#define INLINING_DRIVER_H
+
+#include "call_graph.h"
+
+// Inlines calls across a whole compilation unit. Graphs are processed
+// bottom-up over the call graph, so every callee is already flattened
+// when it is inlined into its callers. Graphs of one cycle are never
+// inlined into each other, and the nesting of inlined callees is bounded
+// by Inlining::MAX_INLINE_DEPTH
+class InliningDriver {
+public:
+    void Run(const std::vector<Graph*>& graphs);
+
+    CallGraph& GetCallGraph()
+    {
+        return call_graph_;
+    }
+
+private:
+    CallGraph call_graph_;
+};
+
+#endif // INLINING_DRIVER_H
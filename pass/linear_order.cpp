@@ -4,8 +4,6 @@
 
 void LinearOrder::RunPassImpl(Graph* g)
 {
-    g->RunPass<RPO>();
-    g->RunPass<LoopAnalyzer>();
 
     auto visit_marker = g->NewMarker();
     for (auto bb: g->GetRPOBasicBlocks()) {
@@ -25,6 +23,7 @@ void LinearOrder::RunPassImpl(Graph* g)
         }
     }
 
+    g->EraseMarker(visit_marker);
     g->SetLinearOrder(linear_order_);
 }
 
@@ -34,7 +33,11 @@ void LinearOrder::ProccessLoop(Loop* loop, marker visit_marker)
     for (int i = loop->GetBlocks().size() - 1; i >= 0; --i) {
         auto bb_loop = loop->GetBlocks()[i];
         if (bb_loop->IsLoopHeader() && bb_loop->GetLoop() != loop) {
-            ProccessLoop(bb_loop->GetLoop(), visit_marker);
+            // headers of deeper loops are met in every enclosing loop,
+            // but an inner loop is processed only once
+            if (!bb_loop->IsMarked(visit_marker)) {
+                ProccessLoop(bb_loop->GetLoop(), visit_marker);
+            }
         // second condition is necessary to correctly process bbs from inner loops
         // TODO maybe a little change in loop analysis' logic?
         } else if (!bb_loop->IsMarked(visit_marker) && bb_loop->GetLoop() == loop) {
@@ -106,3 +109,5 @@ Opcode LinearOrder::GetInverseCondition(Opcode op)
         return op;
     }
 }
+
+template bool PassManager::RunPass<LinearOrder>(Graph *g);
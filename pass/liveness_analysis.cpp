@@ -1,10 +1,66 @@
 #include "liveness_analysis.h"
+#include "dataflow.h"
 #include "linear_order.h"
 
+namespace {
+
+// backward problem over linear numbers of instructions: phi is defined
+// at the start of its block and its inputs are used at the end of preds
+class LiveVariables {
+public:
+    static constexpr bool IS_FORWARD = false;
+    static constexpr bool IS_UNION = true;
+    static constexpr const char* NAME = "LivenessAnalysis";
+
+    explicit LiveVariables(uint32_t insts_num) : insts_num_(insts_num) {}
+
+    uint32_t GetBitsNum()
+    {
+        return insts_num_;
+    }
+
+    void InitBlock(BasicBlock* bb, BitVector& gen, BitVector& kill)
+    {
+        for (auto inst: bb->InstsReverse()) {
+            kill.Set(inst->GetLinearNumber());
+            gen.Reset(inst->GetLinearNumber());
+            if (inst->GetType() == Type::InstPhi) {
+                continue;
+            }
+            for (auto input: inst->GetInputs()) {
+                gen.Set(input->GetLinearNumber());
+            }
+        }
+    }
+
+    void InitBoundary(BitVector&) {}
+
+    // inputs merged from several edges keep only one of their blocks, so all
+    // inputs of a phi are live at the end of a pred, which it does not list
+    void AddEdgeFacts(BasicBlock* pred, BasicBlock* succ, BitVector& facts)
+    {
+        for (auto phi: succ->Phis()) {
+            auto inputs = phi->CastToInstPhi()->GetInputInst();
+            const auto& input_bbs = phi->CastToInstPhi()->GetInputBB();
+            bool is_listed = std::find(input_bbs.begin(), input_bbs.end(), pred) != input_bbs.end();
+            for (size_t i = 0; i < inputs.size(); i++) {
+                if (!is_listed || input_bbs[i] == pred) {
+                    facts.Set(inputs[i]->GetLinearNumber());
+                }
+            }
+        }
+    }
+
+private:
+    uint32_t insts_num_ = 0;
+};
+
+}  // namespace
+
 void LivenessAnalysis::RunPassImpl(Graph* g)
 {
-    g->RunPass<LinearOrder>();
     linear_order_ = g->GetLinearOrder();
+    arena_ = &g->GetContext()->GetArena();
 
     InitLiveness();
     CalculateLifeIntervals(g);
@@ -16,12 +72,13 @@ void LivenessAnalysis::InitLiveness()
     uint32_t cur_lin_num = 0;
     for (auto bb: linear_order_) {
         uint32_t bb_live_interval_start = cur_live_num;
-        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        for (auto inst: bb->Insts()) {
             if (inst->GetType() != Type::InstPhi) {
                 cur_live_num += 2;
             }
             inst->SetLiveNumber(cur_live_num);
             inst->SetLinearNumber(cur_lin_num);
+            insts_.push_back(inst);
             cur_lin_num++;
         }
         cur_live_num += 2;
@@ -29,53 +86,33 @@ void LivenessAnalysis::InitLiveness()
     }
 }
 
+// sets of live instructions are computed by dataflow solver, so values
+// live across loops are found for any shape of loops, intervals cover
+// whole blocks, where values are live out, up to the last use otherwise
 void LivenessAnalysis::CalculateLifeIntervals(Graph *g)
 {
+    LiveVariables live_variables(insts_.size());
+    DataflowSolver<LiveVariables> solver;
+    solver.Solve(g, live_variables);
+
     for (auto bb = linear_order_.rbegin(); bb != linear_order_.rend(); bb++) {
-        LiveSet live_set;
-        // calculate initial liveset
-        for (auto succ: (*bb)->GetSuccs()) {
-            live_set.Union(live_inputs_[succ]);
-            
-            AddPhiInputsToLiveset(*bb, succ, live_set);
-        }
-        
-        // process initial liveset
-        for (auto inst: live_set.GetLiveSet()) {
-            AddInstLiveInterval(inst, bb_live_interval_[*bb].GetStart(), bb_live_interval_[*bb].GetEnd());
-        }
-        
-        // iterate over instructions
-        for (Inst* inst = (*bb)->GetLastInst(); inst != nullptr; inst = inst->GetPrev()) {
-            live_set.RemoveInst(inst);
-            
+        auto& bb_interval = bb_live_interval_[*bb];
+        solver.GetExitFacts(*bb).ForEach([this, &bb_interval](size_t index) {
+            AddInstLiveInterval(insts_[index], bb_interval.GetStart(), bb_interval.GetEnd());
+        });
+
+        for (auto inst: (*bb)->InstsReverse()) {
             if (inst->GetType() == Type::InstPhi) {
                 continue;
             }
 
             if (inst_live_interval_.count(inst) == 0) {
-                inst_live_interval_[inst] = new LiveInterval{0, inst->GetLiveNumber() + 2};
+                inst_live_interval_[inst] = arena_->New<LiveInterval>(0, inst->GetLiveNumber() + 2);
             }
             inst_live_interval_[inst]->SetStart(inst->GetLiveNumber());
 
-            IterateOverInputs(inst, live_set);
-        }
-
-        // remove phis from liveset
-        Inst* curr_inst = (*bb)->GetFirstInst();
-        while (curr_inst->GetType() == Type::InstPhi) {
-            live_set.RemoveInst(curr_inst);
-            curr_inst = curr_inst->GetNext();
-        }
-
-        if ((*bb)->IsLoopHeader()) {
-            for (auto inst: live_set.GetLiveSet()) {
-                AddInstLiveInterval(inst, bb_live_interval_[*bb].GetStart(),
-                                    bb_live_interval_[(*bb)->GetLoop()->GetBackEdgeSource()].GetEnd());
-            }
+            AddInputsLiveIntervals(inst);
         }
-
-        live_inputs_[*bb] = live_set;
     }
 
     for (auto item: inst_live_interval_) {
@@ -89,72 +126,20 @@ void LivenessAnalysis::CalculateLifeIntervals(Graph *g)
     g->SetLiveIntervals(inst_live_interval_);
 }
 
-void LivenessAnalysis::AddPhiInputsToLiveset(BasicBlock *curr_bb, BasicBlock *succ, LiveSet& live_set)
+void LivenessAnalysis::AddInputsLiveIntervals(Inst* inst)
 {
-    Inst* curr_inst = succ->GetFirstInst();
-    while (curr_inst->GetType() == Type::InstPhi) {
-        for (auto input: curr_inst->CastToInstPhi()->GetInputInst()) {
-            if (curr_bb->HasInst(input)) {
-                live_set.AddInst(input);
-            }
-        }
-        curr_inst = curr_inst->GetNext();
-    }
-}
-
-void LivenessAnalysis::IterateOverInputs(Inst* inst, LiveSet& live_set)
-{
-    switch (inst->GetType())
-    {
-        case Type::InstWithOneInput:
-        {
-            auto inst_casted = inst->CastToInstWithOneInput();
-            live_set.AddInst(inst_casted->GetInput1());
-            AddInstLiveInterval(inst_casted->GetInput1(), bb_live_interval_[inst_casted->GetBB()].GetStart(),
-                                inst_casted->GetLiveNumber());
-            break;
-        }
-        case Type::InstWithTwoInputs:
-        {
-            auto inst_casted = inst->CastToInstWithTwoInputs();
-            live_set.AddInst(inst_casted->GetInput1());
-            live_set.AddInst(inst_casted->GetInput2());
-            AddInstLiveInterval(inst_casted->GetInput1(), bb_live_interval_[inst_casted->GetBB()].GetStart(),
-                                inst_casted->GetLiveNumber());
-            AddInstLiveInterval(inst_casted->GetInput2(), bb_live_interval_[inst_casted->GetBB()].GetStart(),
-                                inst_casted->GetLiveNumber());
-            break;
-        }
-        case Type::InstCall:
-        {
-            auto inst_casted = inst->CastToInstCall();
-            for (auto input: inst_casted->GetArguments()) {
-                live_set.AddInst(input);
-                AddInstLiveInterval(input, bb_live_interval_[inst_casted->GetBB()].GetStart(),
-                                    inst_casted->GetLiveNumber());
-            }
-            break;
-        }
-        case Type::InstPhi:
-        {
-            auto inst_casted = inst->CastToInstPhi();
-            for (auto input: inst_casted->GetInputInst()) {
-                live_set.AddInst(input);
-                AddInstLiveInterval(input, bb_live_interval_[inst_casted->GetBB()].GetStart(),
-                                    inst_casted->GetLiveNumber());
-            }
-            break;
-        }
-        default:
-            break;
+    for (auto input: inst->GetInputs()) {
+        AddInstLiveInterval(input, bb_live_interval_[inst->GetBB()].GetStart(), inst->GetLiveNumber());
     }
 }
 
 void LivenessAnalysis::AddInstLiveInterval(Inst* inst, uint32_t start, uint32_t end)
 {
     if (inst_live_interval_.count(inst) == 0) {
-        inst_live_interval_[inst] = new LiveInterval{start, end};
+        inst_live_interval_[inst] = arena_->New<LiveInterval>(start, end);
     } else {
         inst_live_interval_[inst]->AddInterval(start, end);
     }
-}
\ No newline at end of file
+}
+
+template bool PassManager::RunPass<LivenessAnalysis>(Graph *g);
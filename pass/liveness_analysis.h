@@ -13,14 +13,16 @@ public:
 private:
     void InitLiveness();
     void CalculateLifeIntervals(Graph *g);
-    void AddPhiInputsToLiveset(BasicBlock *curr_bb, BasicBlock *bb, LiveSet& live_set);
-    void IterateOverInputs(Inst* inst, LiveSet& live_set);
+    void AddInputsLiveIntervals(Inst* inst);
     void AddInstLiveInterval(Inst* inst, uint32_t start, uint32_t end);
 
     std::vector<BasicBlock*> linear_order_;
-    std::unordered_map<BasicBlock*, LiveSet> live_inputs_;
+    // indexed by linear number
+    std::vector<Inst*> insts_;
     std::unordered_map<BasicBlock*, LiveInterval> bb_live_interval_;
     std::unordered_map<Inst*, LiveInterval*> inst_live_interval_;
+    // intervals are stored in the graph, so they live as long as its context
+    ArenaAllocator* arena_ = nullptr;
 };
 
 #endif // LIVENESS_ANALYSIS_H
@@ -5,12 +5,22 @@
 void LoopAnalyzer::RunPassImpl(Graph *g)
 {
     g_ = g;
-    g->RunPass<DomTreeFast>();
+    ResetLoops();
     CollectBackEdges();
     PopulateLoops();
     BuildLoopTree();
 }
 
+// drop results of the previous run, so that analysis may be repeated after cfg changes
+void LoopAnalyzer::ResetLoops()
+{
+    delete g_->GetRootLoop();
+    g_->SetRootLoop(nullptr);
+    for (auto bb: g_->GetBasicBlocks()) {
+        bb->SetLoop(nullptr);
+    }
+}
+
 void LoopAnalyzer::CollectBackEdges()
 {
     black_marker_ = g_->NewMarker();
@@ -46,7 +56,6 @@ void LoopAnalyzer::ProccessEdge(BasicBlock *curr, BasicBlock *prev)
 
 void LoopAnalyzer::PopulateLoops()
 {
-    g_->RunPass<RPO>();
     auto rpo_bbs = g_->GetRPOBasicBlocks();
     for (auto it = rpo_bbs.rbegin(); it != rpo_bbs.rend(); it++) {
         auto header_block = *it;
@@ -113,3 +122,5 @@ void LoopAnalyzer::BuildLoopTree()
     }
     g_->SetRootLoop(root_loop);
 }
+
+template bool PassManager::RunPass<LoopAnalyzer>(Graph *g);
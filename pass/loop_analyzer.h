@@ -9,6 +9,7 @@ public:
     void RunPassImpl(Graph *g);
 
 private:
+    void ResetLoops();
     void CollectBackEdges();
     void ProccessEdge(BasicBlock *root, BasicBlock *prev);
     void PopulateLoops();
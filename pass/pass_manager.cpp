@@ -0,0 +1,80 @@
+#include <array>
+#include <iterator>
+#include <string>
+
+#include "pass_manager.h"
+#include "ir/graph.h"
+#include "ir/graph_verifier.h"
+#include "ir/inst_allocator.h"
+
+// in order of PassList
+static const char* PASS_NAMES[] = {
+    "RPO", "DomTreeSlow", "DomTreeFast", "LoopAnalyzer",
+    "ConstFolding", "DCE", "Peephole", "Inlining", "CheckElimination",
+    "LinearOrder", "LivenessAnalysis", "RegAlloc",
+};
+static_assert(std::size(PASS_NAMES) == std::tuple_size_v<PassList>);
+
+struct PassCounterNames {
+    std::string runs_;
+    std::string changed_runs_;
+};
+
+// keys are built once, since runs are counted after every pass
+static const auto PASS_COUNTER_NAMES = [] {
+    std::array<PassCounterNames, std::size(PASS_NAMES)> names;
+    for (size_t i = 0; i < names.size(); i++) {
+        names[i].runs_ = std::string(PASS_NAMES[i]) + ".Runs";
+        names[i].changed_runs_ = std::string(PASS_NAMES[i]) + ".ChangedRuns";
+    }
+    return names;
+}();
+
+// instructions are allocated by the thread, which runs the pass
+static size_t GetAllocatedSize(CompilationContext* context)
+{
+    return context->GetArena().GetAllocatedSize() + InstAllocator::GetAllocatedSize();
+}
+
+bool PassManager::BeginProfiling(Graph *g, size_t pass_index)
+{
+    CompilationContext* context = g->GetContext();
+    if (!context->GetPassProfiler().IsEnabled()) {
+        return false;
+    }
+    context->GetPassProfiler().BeginPass(PASS_NAMES[pass_index], g->GetInstsNum(), g->GetBasicBlocks().size(),
+                                         GetAllocatedSize(context));
+    return true;
+}
+
+void PassManager::CountRun(Graph *g, size_t pass_index, bool is_changed)
+{
+    Statistics& statistics = g->GetContext()->GetStatistics();
+    statistics.Add(PASS_COUNTER_NAMES[pass_index].runs_);
+    if (is_changed) {
+        statistics.Add(PASS_COUNTER_NAMES[pass_index].changed_runs_);
+    }
+}
+
+void PassManager::EndProfiling(Graph *g)
+{
+    CompilationContext* context = g->GetContext();
+    context->GetPassProfiler().EndPass(g->GetInstsNum(), g->GetBasicBlocks().size(),
+                                       GetAllocatedSize(context));
+}
+
+void PassManager::Verify(Graph *g, size_t pass_index, bool is_nested)
+{
+    VerifyLevel level = g->GetContext()->GetVerifyLevel();
+    if (level == VerifyLevel::OFF || (is_nested && level != VerifyLevel::FULL)) {
+        return;
+    }
+    GraphVerifier verifier(level);
+    if (!verifier.Verify(g)) {
+        std::string msg = std::string("graph is inconsistent after ") + PASS_NAMES[pass_index] + ":";
+        for (const auto& error: verifier.GetErrors()) {
+            msg += "\n    " + error;
+        }
+        throw_error(msg);
+    }
+}
@@ -1,6 +1,9 @@
 #ifndef PASS_MANAGER_H
 #define PASS_MANAGER_H
 
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <tuple>
 #include <type_traits>
 
@@ -23,32 +26,223 @@ using PassList = std::tuple<RPO, DomTreeSlow, DomTreeFast, LoopAnalyzer,
                             ConstFolding, DCE, Peephole, Inlining, CheckElimination,
                             LinearOrder, LivenessAnalysis, RegAlloc>;
 
+// passes, which depend on CFG only
+using CFGAnalyses = std::tuple<RPO, DomTreeSlow, DomTreeFast, LoopAnalyzer, LinearOrder>;
+
+// Required passes are run before the pass. Results of all passes except
+// preserved ones are invalidated after the pass, unless its RunPassImpl
+// returns false, which means that graph was not changed
+template <typename Pass>
+struct PassTraits {
+    using Required = std::tuple<>;
+    using Preserved = std::tuple<>;
+};
+
+// analyses do not change graph
+template <>
+struct PassTraits<RPO> {
+    using Required = std::tuple<>;
+    using Preserved = PassList;
+};
+
+template <>
+struct PassTraits<DomTreeSlow> {
+    using Required = std::tuple<>;
+    using Preserved = PassList;
+};
+
+template <>
+struct PassTraits<DomTreeFast> {
+    using Required = std::tuple<>;
+    using Preserved = PassList;
+};
+
+template <>
+struct PassTraits<LoopAnalyzer> {
+    using Required = std::tuple<RPO, DomTreeFast>;
+    using Preserved = PassList;
+};
+
+template <>
+struct PassTraits<LinearOrder> {
+    using Required = std::tuple<RPO, LoopAnalyzer>;
+    using Preserved = PassList;
+};
+
+template <>
+struct PassTraits<LivenessAnalysis> {
+    using Required = std::tuple<LinearOrder>;
+    using Preserved = PassList;
+};
+
+template <>
+struct PassTraits<RegAlloc> {
+    using Required = std::tuple<LivenessAnalysis>;
+    using Preserved = PassList;
+};
+
+// optimizations, which change instructions but not CFG
+template <>
+struct PassTraits<ConstFolding> {
+    using Required = std::tuple<RPO>;
+    using Preserved = CFGAnalyses;
+};
+
+template <>
+struct PassTraits<DCE> {
+    using Required = std::tuple<>;
+    using Preserved = CFGAnalyses;
+};
+
+template <>
+struct PassTraits<Peephole> {
+    using Required = std::tuple<RPO>;
+    using Preserved = CFGAnalyses;
+};
+
+template <>
+struct PassTraits<CheckElimination> {
+    using Required = std::tuple<DomTreeFast, LoopAnalyzer>;
+    using Preserved = CFGAnalyses;
+};
+
+// changes CFG
+template <>
+struct PassTraits<Inlining> {
+    using Required = std::tuple<LoopAnalyzer>;
+    using Preserved = std::tuple<>;
+};
+
+// bit per pass from PassList
+using PassMask = uint64_t;
+static_assert(std::tuple_size_v<PassList> <= sizeof(PassMask) * 8);
+
+// Base of Graph, which keeps validity of pass results
 class PassManager {
-protected:
+public:
     template <typename Pass>
-    void RunPass(Graph *g);
+    bool IsPassValid()
+    {
+        return pass_validity_[GetPassIndex<Pass>()];
+    }
 
     template <typename Pass>
-    constexpr size_t GetPassIndex();
+    void SetPassValidity(bool is_valid)
+    {
+        pass_validity_[GetPassIndex<Pass>()] = is_valid;
+    }
+
+    // invalidates results of passes from mask
+    void InvalidatePasses(PassMask mask)
+    {
+        pass_validity_ &= ~std::bitset<std::tuple_size_v<PassList>>(mask);
+    }
+
+    PassMask GetValidPasses()
+    {
+        return pass_validity_.to_ullong();
+    }
+
+    void SetValidPasses(PassMask mask)
+    {
+        pass_validity_ = std::bitset<std::tuple_size_v<PassList>>(mask);
+    }
+
+    template <typename Pass>
+    static constexpr size_t GetPassIndex();
+
+    template <typename Passes>
+    static constexpr PassMask GetPassMask();
+
+protected:
+    // returns false if the pass was not run or did not change graph
+    template <typename Pass>
+    bool RunPass(Graph *g);
+
 private:
     template <typename Pass, size_t Index>
-    constexpr size_t GetPassIndexHelper();
+    static constexpr size_t GetPassIndexHelper();
+
+    template <typename... Passes>
+    static constexpr PassMask GetPassMaskHelper(std::tuple<Passes...>*);
+
+    template <typename... Passes>
+    void RunPasses(Graph *g, std::tuple<Passes...>*);
+
+    // return false if profiler of the graph context is disabled
+    static bool BeginProfiling(Graph *g, size_t pass_index);
+    static void EndProfiling(Graph *g);
+    // counts runs of the pass and runs, which changed graph
+    static void CountRun(Graph *g, size_t pass_index, bool is_changed);
+    // aborts if graph is inconsistent after the pass, passes run by other
+    // passes are verified at FULL level only, since the outer pass is verified
+    static void Verify(Graph *g, size_t pass_index, bool is_nested);
+
+    std::bitset<std::tuple_size_v<PassList>> pass_validity_;
+    // number of passes, which are running on graph
+    uint32_t nesting_depth_ = 0;
 };
 
 template <typename Pass>
-void PassManager::RunPass(Graph *g)
+bool PassManager::RunPass(Graph *g)
 {
-    if (g->template IsPassValid<Pass>()) {
-        return;
+    // g is this graph, which is incomplete here
+    if (IsPassValid<Pass>()) {
+        return false;
     }
+    // requirements are profiled as nested passes
+    bool is_profiled = BeginProfiling(g, GetPassIndex<Pass>());
+    using Traits = PassTraits<Pass>;
+    RunPasses(g, static_cast<typename Traits::Required*>(nullptr));
+
     Pass pass;
-    pass.RunPassImpl(g);
-    g->template SetPassValidity<Pass>(true);
+    bool is_changed = true;
+    nesting_depth_++;
+    if constexpr (std::is_same_v<decltype(pass.RunPassImpl(g)), bool>) {
+        is_changed = pass.RunPassImpl(g);
+    } else {
+        pass.RunPassImpl(g);
+    }
+    nesting_depth_--;
+    if (is_changed) {
+        InvalidatePasses(~GetPassMask<typename Traits::Preserved>());
+    }
+    CountRun(g, GetPassIndex<Pass>(), is_changed);
+    // analyses do not change graph
+    if (is_changed && GetPassMask<typename Traits::Preserved>() != GetPassMask<PassList>()) {
+        Verify(g, GetPassIndex<Pass>(), nesting_depth_ != 0);
+    }
+    SetPassValidity<Pass>(true);
+    if (is_profiled) {
+        EndProfiling(g);
+    }
+    return is_changed;
+}
+
+// RunPass is instantiated in the source file of every pass,
+// so callers do not need definitions of passes it depends on
+extern template bool PassManager::RunPass<RPO>(Graph *g);
+extern template bool PassManager::RunPass<DomTreeSlow>(Graph *g);
+extern template bool PassManager::RunPass<DomTreeFast>(Graph *g);
+extern template bool PassManager::RunPass<LoopAnalyzer>(Graph *g);
+extern template bool PassManager::RunPass<ConstFolding>(Graph *g);
+extern template bool PassManager::RunPass<DCE>(Graph *g);
+extern template bool PassManager::RunPass<Peephole>(Graph *g);
+extern template bool PassManager::RunPass<Inlining>(Graph *g);
+extern template bool PassManager::RunPass<CheckElimination>(Graph *g);
+extern template bool PassManager::RunPass<LinearOrder>(Graph *g);
+extern template bool PassManager::RunPass<LivenessAnalysis>(Graph *g);
+extern template bool PassManager::RunPass<RegAlloc>(Graph *g);
+
+template <typename... Passes>
+void PassManager::RunPasses(Graph *g, std::tuple<Passes...>*)
+{
+    (RunPass<Passes>(g), ...);
 }
 
 template <typename Pass>
 constexpr size_t PassManager::GetPassIndex() {
-    GetPassIndexHelper<Pass, 0>();
+    return GetPassIndexHelper<Pass, 0>();
 }
 
 template <typename Pass, size_t Index>
@@ -61,4 +255,14 @@ constexpr size_t PassManager::GetPassIndexHelper() {
     }
 }
 
+template <typename Passes>
+constexpr PassMask PassManager::GetPassMask() {
+    return GetPassMaskHelper(static_cast<Passes*>(nullptr));
+}
+
+template <typename... Passes>
+constexpr PassMask PassManager::GetPassMaskHelper(std::tuple<Passes...>*) {
+    return (PassMask{0} | ... | (PassMask{1} << GetPassIndex<Passes>()));
+}
+
 #endif // PASS_MANAGER_H
@@ -2,29 +2,60 @@
 #include "dce.h"
 #include "rpo.h"
 
-void Peephole::RunPassImpl(Graph* g)
+bool Peephole::RunPassImpl(Graph* g)
 {
-    g->RunPass<RPO>();
-
+    rewritten_ = false;
     auto rpo_bbs = g->GetRPOBasicBlocks();
     for (BasicBlock* bb : rpo_bbs) {
-        for (Inst* inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        for (auto inst: bb->Insts()) {
             table_[static_cast<size_t>(inst->GetOpcode())](inst);
         }
     }
 
+    // rewritten instructions are detached from blocks and left for DCE,
+    // inputs rewritten in place change graph even if DCE removes nothing
     g->SetPassValidity<DCE>(false);
-    g->RunPass<DCE>();
+    bool is_dce_changed = g->RunPass<DCE>();
+    return rewritten_ || is_dce_changed;
 }
 
 void Peephole::ProcessUsersInputs(Inst *old_inst, Inst *new_inst)
 {
+    rewritten_ = true;
+    old_inst->GetBB()->GetGraph()->GetContext()->GetStatistics().Add("Peephole.ReplacedInsts");
     for (auto user : old_inst->GetUsers()) {
         new_inst->AddUser(user);
         user->SubstituteInput(old_inst, new_inst);
     }
 }
 
+// inst and its input are the same operation with constant second inputs,
+// inst is rewritten in place to take input of the previous instruction
+void Peephole::CombineConstants(Inst *inst)
+{
+    rewritten_ = true;
+    auto inst_casted = inst->CastToInstWithTwoInputs();
+    int32_t new_const = inst_casted->GetInput2()->CastToInstConstant()->GetConstant() +
+                        inst->GetPrev()->CastToInstWithTwoInputs()->GetInput2()->CastToInstConstant()->GetConstant();
+    inst->GetBB()->GetGraph()->GetContext()->GetStatistics().Add("Peephole.CombinedConsts");
+    auto new_inst = Inst::InstBuilder<Opcode::CONSTANT>(inst->GetBB()->GetGraph()->NewInstId());
+    new_inst->CastToInstConstant()->SetConstant(new_const);
+    inst->GetBB()->InsertAfterPhis(new_inst);
+    new_inst->AddUser(inst);
+
+    inst_casted->GetInput2()->RemoveUser(inst);
+    if (inst_casted->GetInput2()->GetUsers().size() == 0)
+        inst_casted->GetInput2()->SetBB(nullptr);
+
+    inst_casted->GetInput1()->RemoveUser(inst);
+    if (inst_casted->GetInput1()->GetUsers().size() == 0)
+        inst_casted->GetInput1()->SetBB(nullptr);
+
+    inst->SubstituteInput(inst_casted->GetInput2(), new_inst);
+    inst->GetPrev()->CastToInstWithTwoInputs()->GetInput1()->AddUser(inst);
+    inst->SubstituteInput(inst_casted->GetInput1(), inst->GetPrev()->CastToInstWithTwoInputs()->GetInput1());
+}
+
 void Peephole::VisitSUB(Inst* inst)
 {
     assert(inst->GetOpcode() == Opcode::SUB);
@@ -47,9 +78,9 @@ void Peephole::VisitSUB(Inst* inst)
     // 2 constant 0
     // users(v1) = users(v2)
     if (inst_casted->GetInput1() == inst_casted->GetInput2()) {
-        auto new_inst = Inst::InstBuilder<Opcode::CONSTANT>(Inst::NextId());
+        auto new_inst = Inst::InstBuilder<Opcode::CONSTANT>(inst->GetBB()->GetGraph()->NewInstId());
         new_inst->CastToInstConstant()->SetConstant(0);
-        inst->GetBB()->PushFrontInst(new_inst);
+        inst->GetBB()->InsertAfterPhis(new_inst);
         ProcessUsersInputs(inst, new_inst);
         inst->SetBB(nullptr);
     }
@@ -93,23 +124,7 @@ void Peephole::VisitSUB(Inst* inst)
         inst->GetPrev()->GetOpcode() == Opcode::SUB &&
         inst_casted->GetInput2()->GetOpcode() == Opcode::CONSTANT &&
         inst->GetPrev()->CastToInstWithTwoInputs()->GetInput2()->GetOpcode() == Opcode::CONSTANT) {
-        int32_t new_const = inst_casted->GetInput2()->CastToInstConstant()->GetConstant() +
-                            inst->GetPrev()->CastToInstWithTwoInputs()->GetInput2()->CastToInstConstant()->GetConstant();
-        auto new_inst = Inst::InstBuilder<Opcode::CONSTANT>(Inst::NextId());
-        new_inst->CastToInstConstant()->SetConstant(new_const);
-        inst->GetBB()->PushFrontInst(new_inst);
-        new_inst->AddUser(inst);
-
-        inst_casted->GetInput2()->RemoveUser(inst);
-        if (inst_casted->GetInput2()->GetUsers().size() == 0)
-            inst_casted->GetInput2()->SetBB(nullptr);
-
-        inst_casted->GetInput1()->RemoveUser(inst);
-        if (inst_casted->GetInput1()->GetUsers().size() == 0)
-            inst_casted->GetInput1()->SetBB(nullptr);
-
-        inst->SubstituteInput(inst_casted->GetInput2(), new_inst);
-        inst->SubstituteInput(inst_casted->GetInput1(), inst->GetPrev()->CastToInstWithTwoInputs()->GetInput1());
+        CombineConstants(inst);
     }
 }
 
@@ -154,23 +169,7 @@ void Peephole::VisitSHR(Inst* inst)
         inst->GetPrev()->GetOpcode() == Opcode::SHR &&
         inst_casted->GetInput2()->GetOpcode() == Opcode::CONSTANT &&
         inst->GetPrev()->CastToInstWithTwoInputs()->GetInput2()->GetOpcode() == Opcode::CONSTANT) {
-        int32_t new_const = inst_casted->GetInput2()->CastToInstConstant()->GetConstant() +
-                            inst->GetPrev()->CastToInstWithTwoInputs()->GetInput2()->CastToInstConstant()->GetConstant();
-        auto new_inst = Inst::InstBuilder<Opcode::CONSTANT>(Inst::NextId());
-        new_inst->CastToInstConstant()->SetConstant(new_const);
-        inst->GetBB()->PushFrontInst(new_inst);
-        new_inst->AddUser(inst);
-
-        inst_casted->GetInput2()->RemoveUser(inst);
-        if (inst_casted->GetInput2()->GetUsers().size() == 0)
-            inst_casted->GetInput2()->SetBB(nullptr);
-
-        inst_casted->GetInput1()->RemoveUser(inst);
-        if (inst_casted->GetInput1()->GetUsers().size() == 0)
-            inst_casted->GetInput1()->SetBB(nullptr);
-
-        inst->SubstituteInput(inst_casted->GetInput2(), new_inst);
-        inst->SubstituteInput(inst_casted->GetInput1(), inst->GetPrev()->CastToInstWithTwoInputs()->GetInput1());
+        CombineConstants(inst);
     }
 }
 
@@ -196,9 +195,9 @@ void Peephole::VisitXOR(Inst* inst)
     // 2 constant 0
     // users(v1) = users(v2)
     if (inst_casted->GetInput1() == inst_casted->GetInput2()) {
-        auto new_inst = Inst::InstBuilder<Opcode::CONSTANT>(Inst::NextId());
+        auto new_inst = Inst::InstBuilder<Opcode::CONSTANT>(inst->GetBB()->GetGraph()->NewInstId());
         new_inst->CastToInstConstant()->SetConstant(0);
-        inst->GetBB()->PushFrontInst(new_inst);
+        inst->GetBB()->InsertAfterPhis(new_inst);
         ProcessUsersInputs(inst, new_inst);
         inst->SetBB(nullptr);
     }
@@ -209,10 +208,10 @@ void Peephole::VisitXOR(Inst* inst)
     if (inst_casted->GetInput2()->GetOpcode() == Opcode::CONSTANT &&
         inst_casted->GetInput2()->CastToInstConstant()->GetConstant() == -1) {
 
-        auto new_inst = Inst::InstBuilder<Opcode::NOT>(Inst::NextId());
+        auto new_inst = Inst::InstBuilder<Opcode::NOT>(inst->GetBB()->GetGraph()->NewInstId());
         new_inst->CastToInstWithOneInput()->SetInput1(inst_casted->GetInput1());
         inst->GetBB()->InsertInst(inst, new_inst);
-        inst_casted->GetInput1()->RemoveUser(inst);
+        // inst remains a user of its inputs until DCE deletes it
         inst_casted->GetInput1()->AddUser(new_inst);
 
         ProcessUsersInputs(inst, new_inst);
@@ -220,3 +219,5 @@ void Peephole::VisitXOR(Inst* inst)
         inst->SetBB(nullptr);
     }
 }
+
+template bool PassManager::RunPass<Peephole>(Graph *g);
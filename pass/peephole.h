@@ -1,12 +1,15 @@
 #ifndef PEEPHOLES_H
 #define PEEPHOLES_H
 
+#include <array>
+
 #include "ir/graph.h"
 #include "visitor.h"
 
 class Peephole : public InstVisitor {
 public:
-    void RunPassImpl(Graph *g);
+    // returns false if nothing was rewritten
+    bool RunPassImpl(Graph *g);
 
 private:
     static void VisitSUB(Inst *inst);
@@ -14,6 +17,11 @@ private:
     static void VisitXOR(Inst *inst);
 
     static void ProcessUsersInputs(Inst * old_inst, Inst *new_inst);
+    static void CombineConstants(Inst *inst);
+
+    // set by visitors, which are static, so that they fit the dispatch table,
+    // graphs of one thread are optimized one at a time
+    static inline thread_local bool rewritten_ = false;
 
     #define BUILD_DISPATCH_TABLE(name, type)    \
     Visit##name,
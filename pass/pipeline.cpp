@@ -0,0 +1,135 @@
+#include <unordered_map>
+
+#include "pipeline.h"
+
+Pipeline Pipeline::Parse(const std::string& description)
+{
+    Pipeline pipeline;
+    bool is_in_group = false;
+    size_t pos = 0;
+    while (pos < description.size()) {
+        char c = description[pos];
+        if (c == ',' || c == ' ') {
+            pos++;
+            continue;
+        }
+        if (c == '[') {
+            if (is_in_group) {
+                throw_error("nested fixpoint group in pipeline: " + description);
+            }
+            is_in_group = true;
+            pipeline.steps_.emplace_back();
+            pipeline.steps_.back().is_fixpoint_ = true;
+            pos++;
+            continue;
+        }
+        if (c == ']') {
+            if (!is_in_group) {
+                throw_error("unbalanced ']' in pipeline: " + description);
+            }
+            is_in_group = false;
+            pos++;
+            continue;
+        }
+
+        size_t end = description.find_first_of(",[] ", pos);
+        if (end == std::string::npos) {
+            end = description.size();
+        }
+        std::string name = description.substr(pos, end - pos);
+        pos = end;
+        if (!is_in_group) {
+            pipeline.steps_.emplace_back();
+        }
+        pipeline.steps_.back().names_.push_back(name);
+        pipeline.steps_.back().runners_.push_back(GetPassRunner(name));
+    }
+    if (is_in_group) {
+        throw_error("unbalanced '[' in pipeline: " + description);
+    }
+    return pipeline;
+}
+
+Pipeline Pipeline::Create(OptLevel level)
+{
+    return Parse(GetDescription(level));
+}
+
+// dead instructions left by peephole and const_folding are removed by DCE,
+// which they run themselves, so the levels do not list dce
+const char* Pipeline::GetDescription(OptLevel level)
+{
+    switch (level) {
+    case OptLevel::O0:
+        return "";
+    case OptLevel::O1:
+        return "peephole,const_folding";
+    case OptLevel::O2:
+        return "inlining,[peephole,const_folding],check_elimination";
+    }
+    UNREACHABLE()
+    return "";
+}
+
+// a pass is not rerun while its result is valid, so an iteration, after which
+// every pass of the group is valid, changes nothing and finishes the group
+void Pipeline::Run(Graph* g) const
+{
+    for (const auto& step: steps_) {
+        uint32_t iterations = step.is_fixpoint_ ? MAX_FIXPOINT_ITERATIONS : 1;
+        for (uint32_t i = 0; i < iterations; ++i) {
+            bool is_changed = false;
+            for (auto runner: step.runners_) {
+                is_changed |= runner(g);
+            }
+            if (!is_changed) {
+                break;
+            }
+        }
+    }
+}
+
+std::string Pipeline::GetDescription() const
+{
+    std::string description;
+    for (const auto& step: steps_) {
+        if (!description.empty()) {
+            description += ",";
+        }
+        std::string names;
+        for (const auto& name: step.names_) {
+            names += names.empty() ? name : "," + name;
+        }
+        description += step.is_fixpoint_ ? "[" + names + "]" : names;
+    }
+    return description;
+}
+
+template <typename Pass>
+static bool RunPassByName(Graph* g)
+{
+    return g->RunPass<Pass>();
+}
+
+Pipeline::PassRunner Pipeline::GetPassRunner(const std::string& name)
+{
+    static const std::unordered_map<std::string, PassRunner> runners = {
+        {"rpo", RunPassByName<RPO>},
+        {"dom_tree_slow", RunPassByName<DomTreeSlow>},
+        {"dom_tree_fast", RunPassByName<DomTreeFast>},
+        {"loop_analyzer", RunPassByName<LoopAnalyzer>},
+        {"const_folding", RunPassByName<ConstFolding>},
+        {"dce", RunPassByName<DCE>},
+        {"peephole", RunPassByName<Peephole>},
+        {"inlining", RunPassByName<Inlining>},
+        {"check_elimination", RunPassByName<CheckElimination>},
+        {"linear_order", RunPassByName<LinearOrder>},
+        {"liveness_analysis", RunPassByName<LivenessAnalysis>},
+        {"reg_alloc", RunPassByName<RegAlloc>},
+    };
+    auto it = runners.find(name);
+    if (it == runners.end()) {
+        throw_error("unknown pass in pipeline: " + name);
+    }
+    return it->second;
+}
@@ -0,0 +1,54 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <string>
+#include <vector>
+
+#include "ir/graph.h"
+
+enum class OptLevel {
+    // no optimizations, for methods compiled once
+    O0,
+    // cheap local optimizations, for cold methods
+    O1,
+    // inlining and optimizations until fixpoint, for hot methods
+    O2,
+};
+
+// Sequence of passes selected at runtime. Description lists pass names
+// separated by commas, passes in square brackets form a fixpoint group,
+// which is repeated until none of its passes changes graph, e.g.
+// "inlining,[peephole,const_folding],check_elimination". Peephole and
+// ConstFolding run DCE on the instructions they rewrite, so dce is not
+// listed after them
+class Pipeline {
+public:
+    // aborts on unknown pass names and unbalanced brackets
+    static Pipeline Parse(const std::string& description);
+    static Pipeline Create(OptLevel level);
+    static const char* GetDescription(OptLevel level);
+
+    // pipeline is not modified by runs, so one pipeline may compile
+    // several graphs in parallel
+    void Run(Graph* g) const;
+
+    std::string GetDescription() const;
+
+    // bound for fixpoint groups, which keep rewriting each other's results
+    static constexpr uint32_t MAX_FIXPOINT_ITERATIONS = 8;
+
+private:
+    using PassRunner = bool (*)(Graph*);
+
+    struct Step {
+        std::vector<std::string> names_;
+        std::vector<PassRunner> runners_;
+        bool is_fixpoint_ = false;
+    };
+
+    static PassRunner GetPassRunner(const std::string& name);
+
+    std::vector<Step> steps_;
+};
+
+#endif // PIPELINE_H
@@ -3,11 +3,11 @@
 
 void RegAlloc::RunPassImpl(Graph* g)
 {
-    g->RunPass<LivenessAnalysis>();
-
     PrepareIntervals(g);
 
+    reg_count_ = g->GetContext()->GetRegCount();
     LinearScan();
+    g->GetContext()->GetStatistics().Add("RegAlloc.Spills", cur_free_stack_slot_);
 }
 
 void RegAlloc::PrepareIntervals(Graph* g)
@@ -34,7 +34,7 @@ void RegAlloc::LinearScan()
 {
     for (auto interval: live_intervals_) {
         ExpireOldIntervals(interval);
-        if (active_live_intervals_.size() == reg_num_) {
+        if (active_live_intervals_.size() == reg_count_) {
             SpillAtInterval(interval);
         } else {
             interval->SetLocation(ReserveReg());
@@ -89,4 +89,6 @@ void RegAlloc::SortActiveIntervals()
 {
     auto comparator = [](LiveInterval* lhs, LiveInterval* rhs){ return lhs->GetEnd() < rhs->GetEnd(); };
     std::sort(active_live_intervals_.begin(), active_live_intervals_.end(), comparator);
-}
\ No newline at end of file
+}
+
+template bool PassManager::RunPass<RegAlloc>(Graph *g);
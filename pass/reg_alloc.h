@@ -9,12 +9,6 @@ class RegAlloc {
 public:
     void RunPassImpl(Graph* g);
 
-    static void SetRegCount(size_t reg_num)
-    {
-        assert(reg_num <= MAX_REG_NUM);
-        reg_num_ = reg_num;
-    }
-
 private:
     void PrepareIntervals(Graph* g);
     void SortActiveIntervals();
@@ -36,12 +30,10 @@ private:
         return free_reg;
     }
 
-    static constexpr size_t MAX_REG_NUM = 31;
-    static inline size_t reg_num_ = MAX_REG_NUM;
-
     std::vector<LiveInterval*> live_intervals_;
     std::vector<LiveInterval*> active_live_intervals_;
-    std::bitset<MAX_REG_NUM> reg_map_;
+    std::bitset<CompilationContext::MAX_REG_COUNT> reg_map_;
+    size_t reg_count_ = 0;
 
     uint32_t cur_free_stack_slot_ = 0;
 };
@@ -30,4 +30,6 @@ void RPO::PostOrderVisitor(std::vector<BasicBlock*>& result, BasicBlock* current
         PostOrderVisitor(result, succ, visited_marker);
     }
     result.push_back(current);
-}
\ No newline at end of file
+}
+
+template bool PassManager::RunPass<RPO>(Graph *g);
@@ -93,7 +93,7 @@ TEST(CHECK_ELIMINATION_TEST, TEST3) {
     ASSERT_EQ(g->GetInstById(7), nullptr);
     ASSERT_NE(g->GetInstById(8), nullptr);
     ASSERT_NE(g->GetInstById(10), nullptr);
-    CheckUsers(g->GetInstById(1), {3, 4, 5, 10, 9});
+    CheckUsers(g->GetInstById(1), {3, 4, 5, 9, 10});
     CheckUsers(g->GetInstById(2), {3, 5, 8, 9});
     CheckUsers(g->GetInstById(3), {4, 8});
     CheckUsers(g->GetInstById(9), {10});
@@ -158,4 +158,188 @@ TEST(CHECK_ELIMINATION_TEST, TEST5) {
     ASSERT_EQ(g->GetInstById(12), nullptr);
     CheckUsers(g->GetInstById(1), {3, 4, 6, 9});
     CheckUsers(g->GetInstById(3), {4, 5});
-}
\ No newline at end of file
+}
+
+TEST(CHECK_ELIMINATION_TEST, TEST6) {
+    IrBuilder irb;
+    /*
+                0
+                |
+                v
+                1<--|
+                |   |
+                v   |
+                2---|
+                |
+                v
+                3
+    */
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0, 1>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::PARAMETER>(2),
+            INST<Opcode::CONSTANT>(3, 1),
+            INST<Opcode::JMP>(4, 1),
+        }),
+        BASIC_BLOCK<1, 2>({
+            INST<Opcode::PHI>(5, 3, 0, 9, 2),
+            INST<Opcode::CHECK_EQ_ZERO>(6, 1),
+            INST<Opcode::CHECK_EQ>(7, 1, 2),
+            INST<Opcode::CHECK_EQ>(8, 5, 2),
+        }),
+        BASIC_BLOCK<2, 1, 3>({
+            INST<Opcode::ADD>(9, 5, 3),
+            INST<Opcode::CHECK_EQ>(10, 2, 1),
+            INST<Opcode::CMP>(11, 9, 2),
+            INST<Opcode::JMP_NE>(12, 1),
+        }),
+        BASIC_BLOCK<3>({
+            INST<Opcode::RET_VOID>(13),
+        }),
+    });
+    g->RunPass<CheckElimination>();
+
+    // loop invariant checks are moved to preheader before jmp, duplicates are removed
+    ASSERT_EQ(g->GetBBbyId(0)->GetSize(), 6);
+    std::vector<uint32_t> expected_preheader = {1, 2, 3, 6, 7, 4};
+    Inst* inst = g->GetBBbyId(0)->GetFirstInst();
+    for (auto expected_id: expected_preheader) {
+        ASSERT_EQ(inst->GetId(), expected_id);
+        inst = inst->GetNext();
+    }
+    ASSERT_EQ(inst, nullptr);
+    ASSERT_EQ(g->GetInstById(10), nullptr);
+
+    // check of induction variable stays in loop
+    ASSERT_EQ(g->GetInstById(8)->GetBB(), g->GetBBbyId(1));
+    ASSERT_EQ(g->GetBBbyId(1)->GetSize(), 2);
+    ASSERT_EQ(g->GetBBbyId(2)->GetSize(), 3);
+    CheckUsers(g->GetInstById(1), {6, 7});
+    CheckUsers(g->GetInstById(2), {7, 8, 11});
+}
+
+TEST(CHECK_ELIMINATION_TEST, TEST7) {
+    IrBuilder irb;
+    /*
+                0
+                |
+                v
+            |---1---|
+            |       |
+            v       v
+            2<--|   3
+            |   |   
+            v   |   
+            4---|
+            |
+            v
+            5
+    */
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0, 1>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::PARAMETER>(2),
+        }),
+        BASIC_BLOCK<1, 2, 3>({
+            INST<Opcode::CMP>(3, 1, 2),
+            INST<Opcode::JMP_EQ>(4, 2),
+        }),
+        BASIC_BLOCK<2, 4>({
+            INST<Opcode::PHI>(5, 1, 1, 7, 4),
+            INST<Opcode::CHECK_EQ_ZERO>(6, 1),
+        }),
+        BASIC_BLOCK<3>({
+            INST<Opcode::RET_VOID>(10),
+        }),
+        BASIC_BLOCK<4, 2, 5>({
+            INST<Opcode::ADD>(7, 5, 2),
+            INST<Opcode::CMP>(8, 7, 2),
+            INST<Opcode::JMP_NE>(9, 2),
+        }),
+        BASIC_BLOCK<5>({
+            INST<Opcode::RET_VOID>(11),
+        }),
+    });
+    g->RunPass<CheckElimination>();
+
+    // block 1 has two successors, so it is not a preheader
+    ASSERT_EQ(g->GetInstById(6)->GetBB(), g->GetBBbyId(2));
+    CheckUsers(g->GetInstById(1), {3, 5, 6});
+}
+
+TEST(CHECK_ELIMINATION_TEST, TEST8) {
+    IrBuilder irb;
+    /*
+            |---0---|
+            |       |
+       True v       v False
+            1       2---|
+            |       |   | True
+            v       v   v
+            |-->3<--|   4
+    */
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0, 1, 2>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::PARAMETER>(2),
+            INST<Opcode::CONSTANT>(3, 0),
+            INST<Opcode::CMP>(4, 1, 2),
+            INST<Opcode::JMP_EQ>(5, 1),
+        }),
+        BASIC_BLOCK<1, 3>({
+            INST<Opcode::CHECK_EQ>(6, 1, 2),
+            INST<Opcode::CHECK_EQ>(7, 2, 1),
+            INST<Opcode::CHECK_EQ_ZERO>(8, 1),
+        }),
+        BASIC_BLOCK<2, 4, 3>({
+            INST<Opcode::CHECK_EQ>(9, 1, 2),
+            INST<Opcode::CMP>(10, 3, 2),
+            INST<Opcode::JMP_NE>(11, 4),
+        }),
+        BASIC_BLOCK<3>({
+            INST<Opcode::CHECK_EQ>(12, 1, 2),
+            INST<Opcode::CHECK_EQ_ZERO>(13, 2),
+            INST<Opcode::RET_VOID>(14),
+        }),
+        BASIC_BLOCK<4>({
+            INST<Opcode::CHECK_EQ_ZERO>(15, 2),
+            INST<Opcode::RET_VOID>(16),
+        }),
+    });
+    g->RunPass<CheckElimination>();
+
+    // equality is known on true branch of jmp_eq
+    ASSERT_EQ(g->GetInstById(6), nullptr);
+    ASSERT_EQ(g->GetInstById(7), nullptr);
+    ASSERT_NE(g->GetInstById(8), nullptr);
+    ASSERT_NE(g->GetInstById(9), nullptr);
+    // block 3 is reachable from both branches
+    ASSERT_NE(g->GetInstById(12), nullptr);
+    ASSERT_NE(g->GetInstById(13), nullptr);
+    // equality is known on false branch of jmp_ne only
+    ASSERT_NE(g->GetInstById(15), nullptr);
+    CheckUsers(g->GetInstById(1), {4, 8, 9, 12});
+    CheckUsers(g->GetInstById(2), {4, 9, 10, 12, 13, 15});
+}
+
+TEST(CHECK_ELIMINATION_TEST, TEST9) {
+    IrBuilder irb;
+    constexpr uint32_t CHECK_NUM = 2000;
+    std::vector<Inst*> insts = {
+        INST<Opcode::PARAMETER>(1),
+        INST<Opcode::PARAMETER>(2),
+    };
+    for (uint32_t i = 0; i < CHECK_NUM; ++i) {
+        insts.push_back(INST<Opcode::CHECK_EQ_ZERO>(3 + 2 * i, 1));
+        insts.push_back(INST<Opcode::CHECK_EQ>(4 + 2 * i, 2 - i % 2, 1 + i % 2));
+    }
+    insts.push_back(INST<Opcode::RET_VOID>(3 + 2 * CHECK_NUM));
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0>(insts),
+    });
+    g->RunPass<CheckElimination>();
+
+    ASSERT_EQ(g->GetBBbyId(0)->GetSize(), 5);
+    CheckUsers(g->GetInstById(1), {3, 4});
+    CheckUsers(g->GetInstById(2), {4});
+}
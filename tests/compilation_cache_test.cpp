@@ -0,0 +1,139 @@
+#include <filesystem>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "driver/compilation_cache.h"
+#include "ir/graph_hasher.h"
+#include "ir/ir_parser.h"
+#include "ir/ir_printer.h"
+#include "pass/inlining.h"
+#include "pass/reg_alloc.h"
+
+static const char* CALLS_TEXT =
+    "method caller {\n"
+    "bb0:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = CONSTANT 2\n"
+    "    v2 = CALL_STATIC @callee(v0, v1)\n"
+    "    v3 = SUB v2, v1\n"
+    "    v4 = RET v3\n"
+    "}\n"
+    "\n"
+    "method callee {\n"
+    "bb0:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = PARAMETER\n"
+    "    v2 = CONSTANT -7\n"
+    "    v3 = ADD v0, v1\n"
+    "    v4 = MUL v3, v2\n"
+    "    v5 = RET v4\n"
+    "}\n";
+
+static std::string MakeCacheDir(const std::string& name)
+{
+    std::string dir = testing::TempDir() + name;
+    std::filesystem::remove_all(dir);
+    return dir;
+}
+
+static std::string ReplaceText(std::string text, const std::string& from, const std::string& to)
+{
+    text.replace(text.find(from), from.size(), to);
+    return text;
+}
+
+TEST(COMPILATION_CACHE_TEST, TEST1) {
+    // hash depends on contents of graph and its callees only
+    Graph* caller1 = IrParser().Parse(CALLS_TEXT)[0];
+    Graph* caller2 = IrParser().Parse(CALLS_TEXT)[0];
+    ASSERT_EQ(GraphHasher().Hash(caller1), GraphHasher().Hash(caller2));
+
+    Graph* changed_caller = IrParser().Parse(ReplaceText(CALLS_TEXT, "CONSTANT 2", "CONSTANT 3"))[0];
+    ASSERT_NE(GraphHasher().Hash(changed_caller), GraphHasher().Hash(caller1));
+    Graph* changed_callee = IrParser().Parse(ReplaceText(CALLS_TEXT, "CONSTANT -7", "CONSTANT 7"))[0];
+    ASSERT_NE(GraphHasher().Hash(changed_callee), GraphHasher().Hash(caller1));
+
+    Graph* recursive = IrParser().Parse(ReplaceText(CALLS_TEXT, "@callee", "@caller"))[0];
+    ASSERT_NE(GraphHasher().Hash(recursive), GraphHasher().Hash(caller1));
+}
+
+TEST(COMPILATION_CACHE_TEST, TEST2) {
+    // second compilation of the same graph is loaded from the cache
+    std::string dir = MakeCacheDir("compilation_cache_test2");
+    CompilationCache cache(dir, Pipeline::Create(OptLevel::O2));
+    Graph* g = IrParser().Parse(CALLS_TEXT)[0];
+    std::vector<Graph*> compiled = cache.Compile(g);
+    ASSERT_EQ(compiled, std::vector<Graph*>{g});
+    ASSERT_EQ(cache.GetMisses(), 1);
+
+    Graph* same_g = IrParser().Parse(CALLS_TEXT)[0];
+    std::vector<Graph*> cached = cache.Compile(same_g);
+    ASSERT_EQ(cache.GetHits(), 1);
+    ASSERT_NE(cached[0], same_g);
+    ASSERT_EQ(cached[0]->GetContext(), same_g->GetContext());
+    ASSERT_EQ(IrPrinter().Print({cached[0]}), IrPrinter().Print({g}));
+    ASSERT_TRUE(cached[0]->IsPassValid<RegAlloc>());
+    ASSERT_EQ(cached[0]->GetLiveIntervals().size(), g->GetLiveIntervals().size());
+    // nothing is run for the cached graph
+    ASSERT_EQ(same_g->GetContext()->GetStatistics().Get("Inlining.Runs"), 0);
+
+    // other pipeline or register count is a miss
+    CompilationCache o1_cache(dir, Pipeline::Create(OptLevel::O1));
+    o1_cache.Compile(IrParser().Parse(CALLS_TEXT)[0]);
+    ASSERT_EQ(o1_cache.GetMisses(), 1);
+    Graph* fewer_regs_g = IrParser().Parse(CALLS_TEXT)[0];
+    fewer_regs_g->GetContext()->SetRegCount(1);
+    cache.Compile(fewer_regs_g);
+    ASSERT_EQ(cache.GetMisses(), 2);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(COMPILATION_CACHE_TEST, TEST3) {
+    // corrupted entry is a miss and is replaced
+    std::string dir = MakeCacheDir("compilation_cache_test3");
+    CompilationCache cache(dir, Pipeline::Create(OptLevel::O2));
+    Graph* g = IrParser().Parse(CALLS_TEXT)[0];
+    uint64_t key = cache.GetKey(g);
+    cache.Compile(g);
+    ASSERT_EQ(cache.Load(key).size(), 1);
+
+    std::filesystem::path entry = *std::filesystem::directory_iterator(dir);
+    std::filesystem::resize_file(entry, std::filesystem::file_size(entry) / 2);
+    ASSERT_TRUE(cache.Load(key).empty());
+    cache.Compile(IrParser().Parse(CALLS_TEXT)[0]);
+    ASSERT_EQ(cache.GetMisses(), 2);
+    ASSERT_EQ(cache.Load(key).size(), 1);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(COMPILATION_CACHE_TEST, TEST4) {
+    // inlining into a method does not depend on methods compiled before it,
+    // so the key identifies the result
+    std::string dir = MakeCacheDir("compilation_cache_test4");
+    CompilationCache cache(dir, Pipeline::Create(OptLevel::O2), false);
+    Graph* alone = IrParser().Parse(CALLS_TEXT)[0];
+    uint64_t key = cache.GetKey(alone);
+    cache.Compile(alone);
+
+    // sibling spends more than the whole inlining budget of a method
+    std::string big_text = "method big {\nbb0:\n    v0 = PARAMETER\n    v1 = CONSTANT 2\n";
+    uint32_t calls_num = Inlining::INLINE_BUDGET / 4;
+    for (uint32_t i = 0; i < calls_num; ++i) {
+        big_text += "    v" + std::to_string(2 + i) + " = CALL_STATIC @callee(v0, v1)\n";
+    }
+    big_text += "    v" + std::to_string(2 + calls_num) + " = RET_VOID\n}\n";
+    std::vector<Graph*> graphs = IrParser().Parse(big_text + CALLS_TEXT);
+    Graph* big = graphs[0];
+    Graph* after_big = graphs[1];
+    CompilationCache other_cache(MakeCacheDir("compilation_cache_test4_other"), Pipeline::Create(OptLevel::O2), false);
+    other_cache.Compile(big);
+    ASSERT_NE(IrPrinter().Print({big}).find("CALL_STATIC"), std::string::npos);
+    ASSERT_EQ(cache.GetKey(after_big), key);
+    other_cache.Compile(after_big);
+    ASSERT_EQ(other_cache.GetMisses(), 2);
+    ASSERT_EQ(IrPrinter().Print({after_big}), IrPrinter().Print({alone}));
+    ASSERT_EQ(IrPrinter().Print(cache.Load(key)), IrPrinter().Print({after_big}));
+    std::filesystem::remove_all(dir);
+    std::filesystem::remove_all(testing::TempDir() + "compilation_cache_test4_other");
+}
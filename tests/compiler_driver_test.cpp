@@ -0,0 +1,262 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "driver/bounded_queue.h"
+#include "driver/compiler_driver.h"
+#include "ir/ir_parser.h"
+#include "pass/reg_alloc.h"
+
+static const char* CALLS_TEXT =
+    "method caller {\n"
+    "bb0:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = CONSTANT 2\n"
+    "    v2 = CALL_STATIC @callee(v0, v1)\n"
+    "    v3 = SUB v2, v1\n"
+    "    v4 = RET v3\n"
+    "}\n"
+    "\n"
+    "method callee {\n"
+    "bb0:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = PARAMETER\n"
+    "    v2 = CONSTANT -7\n"
+    "    v3 = ADD v0, v1\n"
+    "    v4 = MUL v3, v2\n"
+    "    v5 = RET v4\n"
+    "}\n";
+
+static const char* FOLDED_TEXT =
+    "method folded {\n"
+    "bb0:\n"
+    "    v0 = CONSTANT 3\n"
+    "    v1 = CONSTANT 4\n"
+    "    v2 = SUB v0, v1\n"
+    "    v3 = RET v2\n"
+    "}\n";
+
+static std::string MakeDir(const std::string& name)
+{
+    std::string dir = testing::TempDir() + name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+static void WriteFile(const std::string& path, const std::string& text)
+{
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream(path) << text;
+}
+
+static std::string ReadFile(const std::string& path)
+{
+    std::ifstream file(path);
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+static bool ParseOptions(std::vector<const char*> args, DriverOptions* options)
+{
+    args.insert(args.begin(), "compiler_opts");
+    std::ostringstream err;
+    return CompilerDriver::ParseOptions(args.size(), args.data(), options, err);
+}
+
+TEST(COMPILER_DRIVER_TEST, TEST1) {
+    DriverOptions options;
+    ASSERT_TRUE(ParseOptions({"-O1", "--regs=4", "--no-regalloc", "-o", "out", "--cache=cache", "--prefetch=0",
+                              "a.ir", "dir"}, &options));
+    ASSERT_EQ(options.pipeline_, Pipeline::GetDescription(OptLevel::O1));
+    ASSERT_EQ(options.reg_count_, 4);
+    ASSERT_FALSE(options.is_reg_alloc_);
+    ASSERT_EQ(options.output_dir_, "out");
+    ASSERT_EQ(options.cache_dir_, "cache");
+    ASSERT_EQ(options.prefetch_, 0);
+    ASSERT_EQ(options.inputs_, (std::vector<std::string>{"a.ir", "dir"}));
+
+    DriverOptions invalid_options;
+    ASSERT_FALSE(ParseOptions({"--regs=100", "a.ir"}, &invalid_options));
+    ASSERT_FALSE(ParseOptions({"--unknown", "a.ir"}, &invalid_options));
+    ASSERT_FALSE(ParseOptions({"-O2"}, &invalid_options));
+    ASSERT_TRUE(ParseOptions({"--help"}, &invalid_options));
+}
+
+TEST(COMPILER_DRIVER_TEST, TEST2) {
+    // every file of the directory is compiled into a file with the same
+    // relative path, callee is inlined into caller
+    std::string dir = MakeDir("compiler_driver_test2");
+    WriteFile(dir + "/in/calls.ir", CALLS_TEXT);
+    WriteFile(dir + "/in/sub/folded.ir", FOLDED_TEXT);
+    WriteFile(dir + "/in/notes.txt", "not IR");
+
+    DriverOptions options;
+    options.inputs_ = {dir + "/in"};
+    options.output_dir_ = dir + "/out";
+    std::ostringstream out;
+    CompilerDriver driver(options, out);
+    ASSERT_TRUE(driver.Run());
+
+    std::vector<Graph*> calls = IrParser().ParseFile(dir + "/out/calls.ir");
+    ASSERT_EQ(calls.size(), 2);
+    ASSERT_EQ(calls[0]->GetName(), "caller");
+    for (auto bb: calls[0]->GetBasicBlocks()) {
+        for (Inst* inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            ASSERT_NE(inst->GetOpcode(), Opcode::CALL_STATIC);
+        }
+    }
+    // locations of allocated registers are printed as comments
+    ASSERT_NE(ReadFile(dir + "/out/calls.ir").find("# R"), std::string::npos);
+
+    std::vector<Graph*> folded = IrParser().ParseFile(dir + "/out/sub/folded.ir");
+    ASSERT_EQ(folded.size(), 1);
+    ASSERT_NE(ReadFile(dir + "/out/sub/folded.ir").find("CONSTANT -1"), std::string::npos);
+    ASSERT_FALSE(std::filesystem::exists(dir + "/out/notes.txt"));
+
+    std::string report = out.str();
+    ASSERT_NE(report.find("calls.ir: 2 methods, 11 insts"), std::string::npos);
+    ASSERT_NE(report.find("folded.ir: 1 methods, 4 insts"), std::string::npos);
+    ASSERT_NE(report.find("# total: 2 files, 3 methods, 15 insts"), std::string::npos);
+    ASSERT_EQ(driver.GetStatistics().Get("Inlining.InlinedCalls"), 1);
+    ASSERT_EQ(driver.GetStatistics().Get("RegAlloc.Runs"), 3);
+}
+
+TEST(COMPILER_DRIVER_TEST, TEST3) {
+    // output without output directory is printed together with the report,
+    // second run takes every method from the cache and prints the same IR
+    std::string dir = MakeDir("compiler_driver_test3");
+    WriteFile(dir + "/calls.ir", CALLS_TEXT);
+
+    DriverOptions options;
+    options.inputs_ = {dir + "/calls.ir", dir + "/missing.ir"};
+    options.cache_dir_ = dir + "/cache";
+    std::ostringstream first_out;
+    ASSERT_FALSE(CompilerDriver(options, first_out).Run());
+    ASSERT_NE(first_out.str().find("# cache: 0 hits, 2 misses"), std::string::npos);
+
+    options.inputs_ = {dir + "/calls.ir"};
+    std::ostringstream second_out;
+    CompilerDriver driver(options, second_out);
+    ASSERT_TRUE(driver.Run());
+    ASSERT_NE(second_out.str().find("# cache: 2 hits, 0 misses"), std::string::npos);
+    ASSERT_EQ(driver.GetStatistics().Get("RegAlloc.Runs"), 0);
+
+    auto get_ir = [](const std::string& out) { return out.substr(0, out.find("\n#")); };
+    ASSERT_EQ(get_ir(second_out.str()), get_ir(first_out.str()));
+    std::vector<Graph*> graphs = IrParser().Parse(second_out.str());
+    ASSERT_EQ(graphs.size(), 2);
+}
+
+TEST(COMPILER_DRIVER_TEST, TEST4) {
+    // streamed files are written in order of inputs with the same
+    // results as files compiled one by one
+    std::string dir = MakeDir("compiler_driver_test4");
+    constexpr uint32_t FILES_NUM = 20;
+    for (uint32_t i = 0; i < FILES_NUM; i++) {
+        WriteFile(dir + "/in/file" + std::to_string(i) + ".ir", i % 2 == 0 ? CALLS_TEXT : FOLDED_TEXT);
+    }
+
+    DriverOptions options;
+    options.inputs_ = {dir + "/in"};
+    options.prefetch_ = 0;
+    std::ostringstream sequential_out;
+    CompilerDriver sequential_driver(options, sequential_out);
+    ASSERT_TRUE(sequential_driver.Run());
+
+    options.prefetch_ = 1;
+    std::ostringstream streaming_out;
+    CompilerDriver streaming_driver(options, streaming_out);
+    ASSERT_TRUE(streaming_driver.Run());
+
+    auto get_ir = [](const std::string& out) {
+        std::istringstream lines(out);
+        std::string ir;
+        for (std::string line; std::getline(lines, line);) {
+            if (line.empty() || line[0] != '#') {
+                ir += line + "\n";
+            }
+        }
+        return ir;
+    };
+    ASSERT_EQ(get_ir(streaming_out.str()), get_ir(sequential_out.str()));
+    std::string ir = get_ir(streaming_out.str());
+    size_t methods_num = 0;
+    for (size_t pos = ir.find("method "); pos != std::string::npos; pos = ir.find("method ", pos + 1)) {
+        methods_num++;
+    }
+    ASSERT_EQ(methods_num, FILES_NUM / 2 * 3);
+    ASSERT_LT(streaming_out.str().find("file0.ir:"), streaming_out.str().find("file1.ir:"));
+    ASSERT_NE(streaming_out.str().find("# total: 20 files, 30 methods"), std::string::npos);
+    ASSERT_EQ(streaming_driver.GetStatistics().GetCounters(), sequential_driver.GetStatistics().GetCounters());
+}
+
+TEST(COMPILER_DRIVER_TEST, TEST5) {
+    // producer does not run ahead of consumer by more than capacity items
+    constexpr int ITEMS_NUM = 1000;
+    BoundedQueue<int> queue(2);
+    std::thread producer([&queue]() {
+        for (int i = 0; i < ITEMS_NUM; i++) {
+            queue.Push(i);
+        }
+        queue.Close();
+    });
+    int expected = 0;
+    for (int item = 0; queue.Pop(item); expected++) {
+        ASSERT_EQ(item, expected);
+        ASSERT_LE(queue.GetSize(), 2);
+    }
+    producer.join();
+    ASSERT_EQ(expected, ITEMS_NUM);
+}
+
+TEST(COMPILER_DRIVER_TEST, TEST6) {
+    // invalid file is reported, other files are compiled anyway
+    std::string dir = MakeDir("compiler_driver_test6");
+    WriteFile(dir + "/in/a.ir", FOLDED_TEXT);
+    WriteFile(dir + "/in/b.ir", "method broken {\nbb0:\n    v0 = JMP bb1\n}\n");
+    WriteFile(dir + "/in/c.ir", CALLS_TEXT);
+
+    for (size_t prefetch: {0, 1}) {
+        DriverOptions options;
+        options.inputs_ = {dir + "/in"};
+        options.output_dir_ = dir + "/out" + std::to_string(prefetch);
+        options.prefetch_ = prefetch;
+        std::ostringstream out;
+        CompilerDriver driver(options, out);
+        ASSERT_FALSE(driver.Run());
+        ASSERT_TRUE(std::filesystem::exists(options.output_dir_ + "/a.ir"));
+        ASSERT_FALSE(std::filesystem::exists(options.output_dir_ + "/b.ir"));
+        ASSERT_TRUE(std::filesystem::exists(options.output_dir_ + "/c.ir"));
+        ASSERT_NE(out.str().find("# total: 2 files, 3 methods"), std::string::npos);
+    }
+}
+
+TEST(COMPILER_DRIVER_TEST, TEST7) {
+    // file, which can not be written, is reported, other files are written anyway
+    std::string dir = MakeDir("compiler_driver_test7");
+    WriteFile(dir + "/in/a.ir", FOLDED_TEXT);
+    WriteFile(dir + "/in/b.ir", FOLDED_TEXT);
+    WriteFile(dir + "/in/c.ir", CALLS_TEXT);
+
+    for (size_t prefetch: {0, 1}) {
+        DriverOptions options;
+        options.inputs_ = {dir + "/in"};
+        options.output_dir_ = dir + "/out" + std::to_string(prefetch);
+        options.prefetch_ = prefetch;
+        // output file is taken by a directory
+        std::filesystem::create_directories(options.output_dir_ + "/b.ir");
+        std::ostringstream out;
+        CompilerDriver driver(options, out);
+        ASSERT_FALSE(driver.Run());
+        ASSERT_NE(ReadFile(options.output_dir_ + "/a.ir").find("CONSTANT -1"), std::string::npos);
+        ASSERT_TRUE(std::filesystem::is_directory(options.output_dir_ + "/b.ir"));
+        ASSERT_EQ(IrParser().ParseFile(options.output_dir_ + "/c.ir").size(), 2);
+        ASSERT_NE(out.str().find("b.ir: 1 not written, 1 methods"), std::string::npos);
+        ASSERT_NE(out.str().find("# total: 3 files, 1 not written, 4 methods"), std::string::npos);
+    }
+}
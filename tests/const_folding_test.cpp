@@ -80,3 +80,25 @@ TEST(CONST_FOLDING_TEST, TEST4) {
     ASSERT_EQ(bb->GetFirstInst()->GetOpcode(), Opcode::CONSTANT);
     ASSERT_EQ(bb->GetFirstInst()->CastToInstConstant()->GetConstant(), 72);
 }
+
+// folding keeps analyses of CFG, but not results of other optimizations
+TEST(CONST_FOLDING_TEST, TEST5) {
+    IrBuilder irb;
+    Graph *g = GRAPH({
+        BASIC_BLOCK<1>({
+            INST<Opcode::CONSTANT>(1, 2),
+            INST<Opcode::CONSTANT>(2, 8),
+            INST<Opcode::SUB>(3, 2, 1),
+        }),
+    });
+    g->RunPass<Peephole>();
+    g->RunPass<LoopAnalyzer>();
+    ASSERT_TRUE(g->IsPassValid<Peephole>());
+
+    g->RunPass<ConstFolding>();
+    ASSERT_TRUE(g->IsPassValid<ConstFolding>());
+    ASSERT_TRUE(g->IsPassValid<RPO>());
+    ASSERT_TRUE(g->IsPassValid<LoopAnalyzer>());
+    ASSERT_FALSE(g->IsPassValid<Peephole>());
+    ASSERT_FALSE(g->IsPassValid<DCE>());
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "ir/ir_parser.h"
+#include "pass/dataflow.h"
+
+static const char* DIAMOND_LOOP_TEXT =
+    "method diamond_loop {\n"
+    "bb0 -> bb1, bb2:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = CMP v0, v0\n"
+    "    v2 = JMP_EQ bb1\n"
+    "bb2 -> bb3:\n"
+    "    v3 = ADD v0, v0\n"
+    "    v4 = JMP bb3\n"
+    "bb1 -> bb3:\n"
+    "    v5 = SUB v0, v0\n"
+    "    v6 = JMP bb3\n"
+    "bb3 -> bb5, bb4:\n"
+    "    v7 = CMP v0, v0\n"
+    "    v8 = JMP_EQ bb5\n"
+    "bb4 -> bb3:\n"
+    "    v9 = MUL v0, v0\n"
+    "    v10 = JMP bb3\n"
+    "bb5:\n"
+    "    v11 = RET v0\n"
+    "}\n";
+
+// instructions defined on some path or on all paths to a block
+template <bool is_union>
+class DefinedInsts {
+public:
+    static constexpr bool IS_FORWARD = true;
+    static constexpr bool IS_UNION = is_union;
+    static constexpr const char* NAME = "DefinedInsts";
+
+    explicit DefinedInsts(uint32_t insts_num) : insts_num_(insts_num) {}
+
+    uint32_t GetBitsNum()
+    {
+        return insts_num_;
+    }
+
+    void InitBlock(BasicBlock* bb, BitVector& gen, BitVector&)
+    {
+        for (auto inst: bb->Insts()) {
+            gen.Set(inst->GetId());
+        }
+    }
+
+    void InitBoundary(BitVector&) {}
+
+    void AddEdgeFacts(BasicBlock*, BasicBlock*, BitVector&) {}
+
+private:
+    uint32_t insts_num_ = 0;
+};
+
+static std::vector<uint32_t> GetIndices(const BitVector& bits)
+{
+    std::vector<uint32_t> indices;
+    bits.ForEach([&indices](size_t index) { indices.push_back(index); });
+    return indices;
+}
+
+TEST(DATAFLOW_TEST, TEST1) {
+    // union converges after the back edge is visited once more
+    Graph* g = IrParser().Parse(DIAMOND_LOOP_TEXT)[0];
+    DefinedInsts<true> problem(12);
+    DataflowSolver<DefinedInsts<true>> solver;
+    solver.Solve(g, problem);
+
+    BasicBlock* bb3 = g->GetBBbyId(3);
+    ASSERT_EQ(GetIndices(solver.GetEntryFacts(bb3)), std::vector<uint32_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+    ASSERT_EQ(GetIndices(solver.GetEntryFacts(g->GetBBbyId(1))), std::vector<uint32_t>({0, 1, 2}));
+    ASSERT_EQ(GetIndices(solver.GetExitFacts(g->GetBBbyId(5))),
+              std::vector<uint32_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}));
+    ASSERT_EQ(solver.GetPassesNum(), 2);
+    ASSERT_EQ(solver.GetVisitsNum(), 9);
+    ASSERT_EQ(g->GetContext()->GetStatistics().Get("DefinedInsts.DataflowPasses"), 2);
+    ASSERT_EQ(g->GetContext()->GetStatistics().Get("DefinedInsts.DataflowVisits"), 9);
+    Graph::GraphDestroyer(g);
+}
+
+TEST(DATAFLOW_TEST, TEST2) {
+    // intersection starts from full sets, so that facts coming
+    // along the back edge do not reduce facts of the loop header
+    Graph* g = IrParser().Parse(DIAMOND_LOOP_TEXT)[0];
+    DefinedInsts<false> problem(12);
+    DataflowSolver<DefinedInsts<false>> solver;
+    solver.Solve(g, problem);
+
+    BasicBlock* bb3 = g->GetBBbyId(3);
+    ASSERT_EQ(GetIndices(solver.GetEntryFacts(bb3)), std::vector<uint32_t>({0, 1, 2}));
+    ASSERT_EQ(GetIndices(solver.GetExitFacts(bb3)), std::vector<uint32_t>({0, 1, 2, 7, 8}));
+    ASSERT_EQ(GetIndices(solver.GetEntryFacts(g->GetBBbyId(4))), std::vector<uint32_t>({0, 1, 2, 7, 8}));
+    ASSERT_TRUE(solver.GetEntryFacts(g->GetBBbyId(0)).GetSize() == 12);
+    ASSERT_TRUE(GetIndices(solver.GetEntryFacts(g->GetBBbyId(0))).empty());
+    Graph::GraphDestroyer(g);
+}
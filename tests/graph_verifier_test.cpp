@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include "ir/graph_verifier.h"
+#include "ir/ir_parser.h"
+#include "pass/pipeline.h"
+
+static const char* LOOP_TEXT =
+    "method loop {\n"
+    "bb0 -> bb1:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = CONSTANT 0\n"
+    "    v2 = CONSTANT 1\n"
+    "bb1 -> bb3, bb2:\n"
+    "    v3 = PHI (v1, bb0), (v6, bb2)\n"
+    "    v4 = CMP v3, v0\n"
+    "    v5 = JMP_GE bb3\n"
+    "bb2 -> bb1:\n"
+    "    v6 = ADD v3, v2\n"
+    "    v7 = JMP bb1\n"
+    "bb3:\n"
+    "    v8 = RET v3\n"
+    "}\n";
+
+static bool Verify(Graph* g, VerifyLevel level = VerifyLevel::FULL)
+{
+    return GraphVerifier(level).Verify(g);
+}
+
+TEST(GRAPH_VERIFIER_TEST, TEST1) {
+    // parsed and optimized graphs are consistent
+    Graph* g = IrParser().Parse(LOOP_TEXT)[0];
+    ASSERT_TRUE(Verify(g, VerifyLevel::CHEAP));
+    ASSERT_TRUE(Verify(g));
+    Pipeline::Create(OptLevel::O2).Run(g);
+    ASSERT_TRUE(Verify(g));
+}
+
+TEST(GRAPH_VERIFIER_TEST, TEST2) {
+    // broken def-use chains, phis and CFG are found by cheap checks
+    Graph* g = IrParser().Parse(LOOP_TEXT)[0];
+    Inst* add = g->GetInstById(6);
+    add->CastToInstWithTwoInputs()->GetInput2()->RemoveUser(add);
+    GraphVerifier verifier(VerifyLevel::CHEAP);
+    ASSERT_FALSE(verifier.Verify(g));
+    ASSERT_EQ(verifier.GetErrors(), std::vector<std::string>{"bb2: v6 is not a user of its input v2"});
+    g->GetInstById(2)->AddUser(add);
+
+    auto phi = g->GetInstById(3)->CastToInstPhi();
+    std::vector<BasicBlock*> input_bbs = {g->GetBBbyId(0), g->GetBBbyId(3)};
+    phi->SetInputBB(input_bbs);
+    ASSERT_FALSE(verifier.Verify(g));
+    ASSERT_EQ(verifier.GetErrors(), std::vector<std::string>{"bb1: v3 has input from bb3, which is not a predecessor"});
+    input_bbs[1] = g->GetBBbyId(2);
+    phi->SetInputBB(input_bbs);
+
+    BasicBlock* bb2 = g->GetBBbyId(2);
+    g->GetBBbyId(1)->RemovePred(bb2);
+    ASSERT_FALSE(verifier.Verify(g));
+    g->GetBBbyId(1)->AddPred(bb2);
+
+    // jump in the middle of block
+    bb2->UnbindInst(add);
+    bb2->PushBackInst(add);
+    ASSERT_FALSE(verifier.Verify(g));
+    ASSERT_EQ(verifier.GetErrors()[0], "bb2: v7 terminates block, but is followed by other instructions");
+    bb2->UnbindInst(add);
+    bb2->PushFrontInst(add);
+
+    bb2->SetSize(5);
+    ASSERT_FALSE(verifier.Verify(g));
+    bb2->SetSize(2);
+    ASSERT_TRUE(verifier.Verify(g));
+}
+
+TEST(GRAPH_VERIFIER_TEST, TEST3) {
+    // uses, which are not dominated by definitions, and users,
+    // which do not use instruction, are found by full checks only
+    Graph* g = IrParser().Parse(LOOP_TEXT)[0];
+    Inst* add = g->GetInstById(6);
+    Inst* cmp = g->GetInstById(4);
+    cmp->CastToInstWithTwoInputs()->GetInput2()->RemoveUser(cmp);
+    cmp->CastToInstWithTwoInputs()->SetInput2(add);
+    add->AddUser(cmp);
+    ASSERT_TRUE(Verify(g, VerifyLevel::CHEAP));
+    GraphVerifier verifier(VerifyLevel::FULL);
+    ASSERT_FALSE(verifier.Verify(g));
+    ASSERT_EQ(verifier.GetErrors(), std::vector<std::string>{"bb2: v6 does not dominate its use in bb1"});
+
+    // use before definition in the same block
+    Inst* jmp = g->GetInstById(5);
+    cmp->CastToInstWithTwoInputs()->SetInput2(jmp);
+    add->RemoveUser(cmp);
+    jmp->AddUser(cmp);
+    ASSERT_FALSE(verifier.Verify(g));
+    ASSERT_EQ(verifier.GetErrors(), std::vector<std::string>{"bb1: v5 does not dominate its use in bb1"});
+
+    cmp->CastToInstWithTwoInputs()->SetInput2(g->GetInstById(0));
+    jmp->RemoveUser(cmp);
+    g->GetInstById(0)->AddUser(cmp);
+    ASSERT_TRUE(verifier.Verify(g));
+
+    g->GetInstById(1)->AddUser(add);
+    ASSERT_FALSE(verifier.Verify(g));
+    ASSERT_EQ(verifier.GetErrors(), std::vector<std::string>{"bb0: v1 has user v6, which does not use it"});
+}
@@ -1,7 +1,9 @@
 #include "gtest/gtest.h"
 
 #include "pass/inlining.h"
+#include "pass/inlining_driver.h"
 #include "ir/ir_builder.h"
+#include "ir/ir_parser.h"
 
 #define INST irb.InstBuilder
 #define BASIC_BLOCK irb.BasicBlockBuilder
@@ -125,39 +127,49 @@ TEST(INLINING_TEST, TEST1) {
             INST<Opcode::RET>(15, 14),
         })
     });
+    uint32_t inst_offset = caller->GetContext()->GetInstIds().GetNextId();
+    uint32_t bb_offset = caller->GetContext()->GetBBIds().GetNextId();
     caller->RunPass<Inlining>();
     ASSERT_EQ(caller->GetBasicBlocks().size(), 6);
 
-    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {1}, {
-        {Opcode::CONSTANT, {42}, {5}},
-        {Opcode::CONSTANT, {314}, {7, 8}},
-        {Opcode::CONSTANT, {271}, {7, 8}},
-        {Opcode::CONSTANT, {50}, {5}},
+    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {bb_offset + 1}, {
+        {Opcode::CONSTANT, {42}, {inst_offset + 5}},
+        {Opcode::CONSTANT, {314}, {inst_offset + 7, inst_offset + 8}},
+        {Opcode::CONSTANT, {271}, {inst_offset + 7, inst_offset + 8}},
+        {Opcode::CONSTANT, {50}, {inst_offset + 5}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[1], {{5}, {2, 3}, {
-        {Opcode::CMP, {13, 4}, {}},
-        {Opcode::JMP_EQ, {3}, {}},
+    CheckBasicBlock(caller->GetBasicBlocks()[1], {{5}, {bb_offset + 2, bb_offset + 3}, {
+        {Opcode::CMP, {13, inst_offset + 4}, {}},
+        {Opcode::JMP_EQ, {bb_offset + 3}, {}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[2], {{1}, {4}, {
-        {Opcode::ADD, {11, 12}, {9}},
+    CheckBasicBlock(caller->GetBasicBlocks()[2], {{bb_offset + 1}, {bb_offset + 4}, {
+        {Opcode::ADD, {11, 12}, {inst_offset + 9}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[3], {{1}, {4}, {
-        {Opcode::SUB, {11, 12}, {9}},
+    CheckBasicBlock(caller->GetBasicBlocks()[3], {{bb_offset + 1}, {bb_offset + 4}, {
+        {Opcode::SUB, {11, 12}, {inst_offset + 9}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[4], {{2, 3}, {caller->GetBasicBlocks()[5]->GetId()}, {
-        {Opcode::PHI, {7, 2, 8, 3}, {15}},
+    CheckBasicBlock(caller->GetBasicBlocks()[4], {{bb_offset + 2, bb_offset + 3}, {caller->GetBasicBlocks()[5]->GetId()}, {
+        {Opcode::PHI, {inst_offset + 7, bb_offset + 2, inst_offset + 8, bb_offset + 3}, {15}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[5], {{4}, {}, {
+    CheckBasicBlock(caller->GetBasicBlocks()[5], {{bb_offset + 4}, {}, {
+        {Opcode::RET, {inst_offset + 9}, {}},
+        }
+    });
+
+    // callee is left intact
+    ASSERT_EQ(callee->GetBasicBlocks().size(), 4);
+    CheckBasicBlock(callee->GetBasicBlocks()[3], {{2, 3}, {}, {
+        {Opcode::PHI, {7, 2, 8, 3}, {10}},
         {Opcode::RET, {9}, {}},
         }
     });
@@ -196,28 +208,30 @@ TEST(INLINING_TEST, TEST2) {
             INST<Opcode::RET_VOID>(10),
         })
     });
+    uint32_t inst_offset = caller->GetContext()->GetInstIds().GetNextId();
+    uint32_t bb_offset = caller->GetContext()->GetBBIds().GetNextId();
     caller->RunPass<Inlining>();
     ASSERT_EQ(caller->GetBasicBlocks().size(), 4);
 
-    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {1}, {
-        {Opcode::CONSTANT, {777}, {5}},
-        {Opcode::CONSTANT, {1}, {4}},
-        {Opcode::CONSTANT, {555}, {4}},
+    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {bb_offset + 1}, {
+        {Opcode::CONSTANT, {1}, {inst_offset + 4}},
+        {Opcode::CONSTANT, {777}, {inst_offset + 5}},
+        {Opcode::CONSTANT, {555}, {inst_offset + 4}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[1], {{2, 5}, {2}, {
-        {Opcode::ADD, {8, 2}, {5}},
+    CheckBasicBlock(caller->GetBasicBlocks()[1], {{bb_offset + 2, 5}, {bb_offset + 2}, {
+        {Opcode::ADD, {8, inst_offset + 2}, {inst_offset + 5}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[2], {{1}, {1, caller->GetBasicBlocks()[3]->GetId()}, {
-        {Opcode::CMP, {4, 3}, {}},
-        {Opcode::JMP_EQ, {1}, {}},
+    CheckBasicBlock(caller->GetBasicBlocks()[2], {{bb_offset + 1}, {bb_offset + 1, caller->GetBasicBlocks()[3]->GetId()}, {
+        {Opcode::CMP, {inst_offset + 4, inst_offset + 3}, {}},
+        {Opcode::JMP_EQ, {bb_offset + 1}, {}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[3], {{2}, {}, {
+    CheckBasicBlock(caller->GetBasicBlocks()[3], {{bb_offset + 2}, {}, {
         {Opcode::RET_VOID, {}, {}},
         }
     });
@@ -263,35 +277,37 @@ TEST(INLINING_TEST, TEST3) {
             INST<Opcode::RET>(15, 14),
         })
     });
+    uint32_t inst_offset = caller->GetContext()->GetInstIds().GetNextId();
+    uint32_t bb_offset = caller->GetContext()->GetBBIds().GetNextId();
     caller->RunPass<Inlining>();
     ASSERT_EQ(caller->GetBasicBlocks().size(), 5);
 
-    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {1}, {
-        {Opcode::CONSTANT, {42}, {5}},
-        {Opcode::CONSTANT, {314}, {7, 9}},
-        {Opcode::CONSTANT, {271}, {7, 9}},
-        {Opcode::CONSTANT, {50}, {5}},
+    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {bb_offset + 1}, {
+        {Opcode::CONSTANT, {42}, {inst_offset + 5}},
+        {Opcode::CONSTANT, {314}, {inst_offset + 7, inst_offset + 9}},
+        {Opcode::CONSTANT, {271}, {inst_offset + 7, inst_offset + 9}},
+        {Opcode::CONSTANT, {50}, {inst_offset + 5}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[1], {{5}, {2, 3}, {
-        {Opcode::CMP, {13, 4}, {}},
-        {Opcode::JMP_EQ, {3}, {}},
+    CheckBasicBlock(caller->GetBasicBlocks()[1], {{5}, {bb_offset + 2, bb_offset + 3}, {
+        {Opcode::CMP, {13, inst_offset + 4}, {}},
+        {Opcode::JMP_EQ, {bb_offset + 3}, {}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[2], {{1}, {caller->GetBasicBlocks()[4]->GetId()}, {
+    CheckBasicBlock(caller->GetBasicBlocks()[2], {{bb_offset + 1}, {caller->GetBasicBlocks()[4]->GetId()}, {
         {Opcode::ADD, {11, 12}, {caller->GetBasicBlocks()[4]->GetFirstInst()->GetId()}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[3], {{1}, {caller->GetBasicBlocks()[4]->GetId()}, {
+    CheckBasicBlock(caller->GetBasicBlocks()[3], {{bb_offset + 1}, {caller->GetBasicBlocks()[4]->GetId()}, {
         {Opcode::SUB, {11, 12}, {caller->GetBasicBlocks()[4]->GetFirstInst()->GetId()}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[4], {{2, 3}, {}, {
-        {Opcode::PHI, {7, 2, 9, 3}, {15}},
+    CheckBasicBlock(caller->GetBasicBlocks()[4], {{bb_offset + 2, bb_offset + 3}, {}, {
+        {Opcode::PHI, {inst_offset + 7, bb_offset + 2, inst_offset + 9, bb_offset + 3}, {15}},
         {Opcode::RET, {caller->GetBasicBlocks()[4]->GetFirstInst()->GetId()}, {}},
         }
     });
@@ -337,36 +353,550 @@ TEST(INLINING_TEST, TEST4) {
             INST<Opcode::RET>(15, 14),
         })
     });
+    uint32_t inst_offset = caller->GetContext()->GetInstIds().GetNextId();
+    uint32_t bb_offset = caller->GetContext()->GetBBIds().GetNextId();
     caller->RunPass<Inlining>();
     ASSERT_EQ(caller->GetBasicBlocks().size(), 5);
-    
-    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {1}, {
-        {Opcode::CONSTANT, {42}, {5}},
-        {Opcode::CONSTANT, {314}, {7, 9}},
-        {Opcode::CONSTANT, {271}, {7, 9}},
-        {Opcode::CONSTANT, {50}, {5}},
+
+    CheckBasicBlock(caller->GetBasicBlocks()[0], {{}, {bb_offset + 1}, {
+        {Opcode::CONSTANT, {42}, {inst_offset + 5}},
+        {Opcode::CONSTANT, {314}, {inst_offset + 7, inst_offset + 9}},
+        {Opcode::CONSTANT, {271}, {inst_offset + 7, inst_offset + 9}},
+        {Opcode::CONSTANT, {50}, {inst_offset + 5}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[1], {{5}, {2, 3}, {
-        {Opcode::CMP, {13, 4}, {}},
-        {Opcode::JMP_EQ, {3}, {}},
+    CheckBasicBlock(caller->GetBasicBlocks()[1], {{5}, {bb_offset + 2, bb_offset + 3}, {
+        {Opcode::CMP, {13, inst_offset + 4}, {}},
+        {Opcode::JMP_EQ, {bb_offset + 3}, {}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[2], {{1}, {caller->GetBasicBlocks()[4]->GetId()}, {
+    CheckBasicBlock(caller->GetBasicBlocks()[2], {{bb_offset + 1}, {caller->GetBasicBlocks()[4]->GetId()}, {
         {Opcode::ADD, {11, 12}, {caller->GetBasicBlocks()[4]->GetFirstInst()->GetId()}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[3], {{1}, {caller->GetBasicBlocks()[4]->GetId()}, {
+    // throw leaves the caller too
+    CheckBasicBlock(caller->GetBasicBlocks()[3], {{bb_offset + 1}, {}, {
         {Opcode::SUB, {11, 12}, {caller->GetBasicBlocks()[4]->GetFirstInst()->GetId()}},
         {Opcode::THROW, {}, {}},
         }
     });
 
-    CheckBasicBlock(caller->GetBasicBlocks()[4], {{2, 3}, {}, {
-        {Opcode::RET, {7}, {}},
+    CheckBasicBlock(caller->GetBasicBlocks()[4], {{bb_offset + 2}, {}, {
+        {Opcode::RET, {inst_offset + 7}, {}},
         }
     });
 }
+
+// callee with one parameter, which consists of size instructions
+Graph* BuildLinearCallee(uint32_t first_id, uint32_t size)
+{
+    IrBuilder irb;
+    std::vector<Inst*> insts = {INST<Opcode::PARAMETER>(first_id)};
+    for (uint32_t id = first_id + 1; id < first_id + size - 1; ++id) {
+        insts.push_back(INST<Opcode::ADD>(id, id - 1, first_id));
+    }
+    insts.push_back(INST<Opcode::RET>(first_id + size - 1, first_id + size - 2));
+    return GRAPH({BASIC_BLOCK<1000>(insts)});
+}
+
+uint32_t CountCalls(Graph* g)
+{
+    uint32_t calls = 0;
+    for (auto bb: g->GetBasicBlocks()) {
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            if (inst->GetOpcode() == Opcode::CALL_STATIC) {
+                calls++;
+            }
+        }
+    }
+    return calls;
+}
+
+TEST(INLINING_TEST, TEST5) {
+    // big callee is inlined only into loop
+    constexpr uint32_t CALLEE_SIZE = Inlining::MAX_CALLEE_SIZE + Inlining::LOOP_DEPTH_BONUS;
+    Graph* callee1 = BuildLinearCallee(100, CALLEE_SIZE);
+    Graph* callee2 = BuildLinearCallee(200, CALLEE_SIZE);
+
+    IrBuilder irb;
+    /*
+                0
+                |
+                v
+                1<--|
+                |   |
+                v   |
+                2---|
+                |
+                v
+                3
+    */
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0, 1>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CALL_STATIC>(2, callee1, 1),
+            INST<Opcode::JMP>(3, 1),
+        }),
+        BASIC_BLOCK<1, 2>({
+            INST<Opcode::PHI>(4, 2, 0, 5, 2),
+        }),
+        BASIC_BLOCK<2, 1, 3>({
+            INST<Opcode::CALL_STATIC>(5, callee2, 4),
+            INST<Opcode::CMP>(6, 5, 1),
+            INST<Opcode::JMP_NE>(7, 1),
+        }),
+        BASIC_BLOCK<3>({
+            INST<Opcode::RET>(8, 4),
+        }),
+    });
+    caller->RunPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(caller), 1);
+    ASSERT_EQ(caller->GetInstById(2)->GetOpcode(), Opcode::CALL_STATIC);
+    ASSERT_EQ(caller->GetInstById(5), nullptr);
+    ASSERT_EQ(caller->GetBasicBlocks().size(), 6);
+
+    // back edge now starts in continuation block
+    BasicBlock* call_cont_block = caller->GetBasicBlocks()[5];
+    ASSERT_EQ(call_cont_block->GetSuccs().size(), 2);
+    ASSERT_EQ(caller->GetBBbyId(1)->GetPreds()[1], call_cont_block);
+}
+
+TEST(INLINING_TEST, TEST6) {
+    // constant arguments make callee cheaper
+    constexpr uint32_t CALLEE_SIZE = Inlining::MAX_CALLEE_SIZE + Inlining::CONST_ARG_BONUS;
+    Graph* callee1 = BuildLinearCallee(100, CALLEE_SIZE);
+    Graph* callee2 = BuildLinearCallee(200, CALLEE_SIZE);
+
+    IrBuilder irb;
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CONSTANT>(2, 42),
+            INST<Opcode::CALL_STATIC>(3, callee1, 1),
+            INST<Opcode::CALL_STATIC>(4, callee2, 2),
+            INST<Opcode::ADD>(5, 3, 4),
+            INST<Opcode::RET>(6, 5),
+        }),
+    });
+    caller->RunPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(caller), 1);
+    ASSERT_EQ(caller->GetInstById(3)->GetOpcode(), Opcode::CALL_STATIC);
+    ASSERT_EQ(caller->GetInstById(4), nullptr);
+}
+
+TEST(INLINING_TEST, TEST7) {
+    // recursive calls are not inlined
+    IrBuilder irb;
+    Graph* callee = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CALL_STATIC>(2, nullptr, 1),
+            INST<Opcode::RET>(3, 2),
+        }),
+    });
+
+    irb = IrBuilder();
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(4),
+            INST<Opcode::CALL_STATIC>(5, callee, 4),
+            INST<Opcode::CALL_STATIC>(6, nullptr, 5),
+            INST<Opcode::RET>(7, 6),
+        }),
+    });
+    callee->GetInstById(2)->CastToInstCall()->SetCallee(caller);
+    caller->GetInstById(6)->CastToInstCall()->SetCallee(caller);
+    caller->RunPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(caller), 2);
+    ASSERT_EQ(caller->GetBasicBlocks().size(), 1);
+}
+
+TEST(INLINING_TEST, TEST8) {
+    // inlining stops when budget is exhausted
+    constexpr uint32_t CALLEE_SIZE = Inlining::MAX_CALLEE_SIZE;
+    constexpr uint32_t CALLS_NUM = Inlining::INLINE_BUDGET / CALLEE_SIZE + 2;
+
+    IrBuilder irb;
+    std::vector<Inst*> insts = {INST<Opcode::PARAMETER>(1)};
+    for (uint32_t i = 0; i < CALLS_NUM; ++i) {
+        Graph* callee = BuildLinearCallee(100 * (i + 1), CALLEE_SIZE);
+        insts.push_back(INST<Opcode::CALL_STATIC>(2 + i, callee, 1));
+    }
+    insts.push_back(INST<Opcode::RET_VOID>(2 + CALLS_NUM));
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0>(insts),
+    });
+    caller->RunPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(caller), CALLS_NUM - Inlining::INLINE_BUDGET / CALLEE_SIZE);
+}
+
+TEST(INLINING_TEST, TEST9) {
+    // the same callee is inlined into several call sites
+    constexpr uint32_t CALLEE_SIZE = 5;
+    Graph* callee = BuildLinearCallee(100, CALLEE_SIZE);
+
+    IrBuilder irb;
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CALL_STATIC>(2, callee, 1),
+            INST<Opcode::CALL_STATIC>(3, callee, 2),
+            INST<Opcode::RET>(4, 3),
+        }),
+    });
+    caller->RunPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(caller), 0);
+    ASSERT_EQ(caller->GetContext()->GetStatistics().Get("Inlining.InlinedCalls"), 2);
+    ASSERT_EQ(callee->GetBasicBlocks().size(), 1);
+    ASSERT_EQ(callee->GetBasicBlocks()[0]->GetSize(), CALLEE_SIZE);
+    ASSERT_EQ(callee->GetInstById(100)->GetUsers().size(), CALLEE_SIZE - 2);
+    ASSERT_EQ(callee->GetInstById(100)->GetBB(), callee->GetBasicBlocks()[0]);
+}
+
+// graphs[i] calls graphs[i + 1] and returns its result, the last graph is a leaf
+std::vector<Graph*> BuildCallChain(uint32_t length)
+{
+    std::vector<Graph*> graphs(length, nullptr);
+    for (uint32_t i = length; i-- > 0;) {
+        IrBuilder irb;
+        uint32_t id = 100 * (i + 1);
+        if (i + 1 == length) {
+            graphs[i] = GRAPH({
+                BASIC_BLOCK<0>({
+                    INST<Opcode::PARAMETER>(id),
+                    INST<Opcode::ADD>(id + 1, id, id),
+                    INST<Opcode::RET>(id + 2, id + 1),
+                }),
+            });
+        } else {
+            graphs[i] = GRAPH({
+                BASIC_BLOCK<0>({
+                    INST<Opcode::PARAMETER>(id),
+                    INST<Opcode::CALL_STATIC>(id + 1, graphs[i + 1], id),
+                    INST<Opcode::RET>(id + 2, id + 1),
+                }),
+            });
+        }
+    }
+    return graphs;
+}
+
+TEST(INLINING_TEST, TEST10) {
+    // calls of inlined callees are inlined as well
+    std::vector<Graph*> graphs = BuildCallChain(3);
+    graphs[0]->RunPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(graphs[0]), 0);
+    ASSERT_EQ(graphs[0]->GetInlineDepth(), 2);
+    ASSERT_EQ(CountCalls(graphs[1]), 1);
+}
+
+TEST(INLINING_TEST, TEST11) {
+    // whole chain is flattened bottom-up
+    std::vector<Graph*> graphs = BuildCallChain(Inlining::MAX_INLINE_DEPTH + 1);
+    InliningDriver driver;
+    driver.Run({graphs[0]});
+
+    ASSERT_EQ(driver.GetCallGraph().GetBottomUpOrder().size(), graphs.size());
+    ASSERT_EQ(driver.GetCallGraph().GetBottomUpOrder().front(), graphs.back());
+    ASSERT_EQ(driver.GetCallGraph().GetBottomUpOrder().back(), graphs.front());
+    for (uint32_t i = 0; i < graphs.size(); ++i) {
+        ASSERT_EQ(CountCalls(graphs[i]), 0);
+        ASSERT_EQ(graphs[i]->GetInlineDepth(), graphs.size() - 1 - i);
+    }
+}
+
+TEST(INLINING_TEST, TEST12) {
+    // nesting of inlined callees is limited
+    std::vector<Graph*> graphs = BuildCallChain(Inlining::MAX_INLINE_DEPTH + 2);
+    InliningDriver driver;
+    driver.Run({graphs[0]});
+
+    ASSERT_EQ(CountCalls(graphs[0]), 1);
+    ASSERT_EQ(graphs[0]->GetInlineDepth(), 0);
+    ASSERT_EQ(CountCalls(graphs[1]), 0);
+    ASSERT_EQ(graphs[1]->GetInlineDepth(), Inlining::MAX_INLINE_DEPTH);
+}
+
+TEST(INLINING_TEST, TEST13) {
+    // graphs of a cycle are not inlined, their other callees are
+    /*
+        caller -> callee1 <-> callee2
+                     |
+                     v
+                    leaf
+    */
+    IrBuilder irb;
+    Graph* leaf = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::RET>(2, 1),
+        }),
+    });
+
+    irb = IrBuilder();
+    Graph* callee2 = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(3),
+            INST<Opcode::CALL_STATIC>(4, nullptr, 3),
+            INST<Opcode::RET>(5, 4),
+        }),
+    });
+
+    irb = IrBuilder();
+    Graph* callee1 = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(6),
+            INST<Opcode::CALL_STATIC>(7, leaf, 6),
+            INST<Opcode::CALL_STATIC>(8, callee2, 7),
+            INST<Opcode::RET>(9, 8),
+        }),
+    });
+    callee2->GetInstById(4)->CastToInstCall()->SetCallee(callee1);
+
+    irb = IrBuilder();
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(10),
+            INST<Opcode::CALL_STATIC>(11, callee1, 10),
+            INST<Opcode::RET>(12, 11),
+        }),
+    });
+
+    InliningDriver driver;
+    driver.Run({caller});
+
+    CallGraph& call_graph = driver.GetCallGraph();
+    ASSERT_TRUE(call_graph.IsRecursive(callee1));
+    ASSERT_TRUE(call_graph.IsRecursive(callee2));
+    ASSERT_FALSE(call_graph.IsRecursive(caller));
+    ASSERT_FALSE(call_graph.IsRecursive(leaf));
+    ASSERT_EQ(call_graph.GetBottomUpOrder().front(), leaf);
+    ASSERT_EQ(call_graph.GetBottomUpOrder().back(), caller);
+
+    ASSERT_EQ(CountCalls(caller), 1);
+    ASSERT_EQ(CountCalls(callee1), 1);
+    ASSERT_EQ(CountCalls(callee2), 1);
+    ASSERT_EQ(callee1->GetInstById(8)->GetOpcode(), Opcode::CALL_STATIC);
+}
+
+TEST(INLINING_TEST, TEST14) {
+    // analyses required by inlining are run before it and invalidated by it
+    std::vector<Graph*> graphs = BuildCallChain(2);
+    graphs[0]->RunPass<Inlining>();
+    ASSERT_TRUE(graphs[0]->IsPassValid<Inlining>());
+    ASSERT_FALSE(graphs[0]->IsPassValid<RPO>());
+    ASSERT_FALSE(graphs[0]->IsPassValid<DomTreeFast>());
+    ASSERT_FALSE(graphs[0]->IsPassValid<LoopAnalyzer>());
+
+    // nothing to inline, analyses stay valid
+    graphs[1]->RunPass<Inlining>();
+    ASSERT_TRUE(graphs[1]->IsPassValid<Inlining>());
+    ASSERT_TRUE(graphs[1]->IsPassValid<RPO>());
+    ASSERT_TRUE(graphs[1]->IsPassValid<DomTreeFast>());
+    ASSERT_TRUE(graphs[1]->IsPassValid<LoopAnalyzer>());
+}
+
+TEST(INLINING_TEST, TEST15) {
+    // callee shares context with the caller, every inlining reserves
+    // only ids of the callee, not all ids of the context
+    CompilationContext context;
+    IrBuilder irb(&context);
+    Graph* callee = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(0),
+            INST<Opcode::CONSTANT>(1, 1),
+            INST<Opcode::ADD>(2, 0, 1),
+            INST<Opcode::RET>(3, 2),
+        }),
+    });
+
+    constexpr uint32_t CALLS_NUM = 40;
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<1>({
+            INST<Opcode::PARAMETER>(4),
+            INST<Opcode::RET>(5, 4),
+        }),
+    });
+    BasicBlock* bb = caller->GetBasicBlocks()[0];
+    Inst* ret = bb->GetLastInst();
+    Inst* arg = bb->GetFirstInst();
+    for (uint32_t i = 0; i < CALLS_NUM; i++) {
+        Inst* call = Inst::InstBuilder<Opcode::CALL_STATIC>(caller->NewInstId());
+        call->CastToInstCall()->SetCallee(callee);
+        call->SetInputs({arg});
+        arg->AddUser(call);
+        bb->InsertInst(ret, call);
+        arg = call;
+    }
+    bb->GetFirstInst()->RemoveUser(ret);
+    ret->SetInputs({arg});
+    arg->AddUser(ret);
+
+    caller->RunPass<Inlining>();
+    ASSERT_EQ(CountCalls(caller), 0);
+    ASSERT_EQ(context.GetStatistics().Get("Inlining.InlinedCalls"), CALLS_NUM);
+    // every inlining takes 4 instruction ids, one phi id and 2 block ids
+    ASSERT_LE(context.GetInstIds().GetNextId(), 6 + CALLS_NUM * (1 + 4 + 1));
+    ASSERT_LE(context.GetBBIds().GetNextId(), 2 + CALLS_NUM * 2);
+}
+
+TEST(INLINING_TEST, TEST16) {
+    // the same argument is passed for both parameters
+    IrBuilder irb;
+    Graph* callee = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::PARAMETER>(2),
+            INST<Opcode::SUB>(3, 1, 2),
+            INST<Opcode::RET>(4, 3),
+        }),
+    });
+
+    irb = IrBuilder();
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CALL_STATIC>(2, callee, 1, 1),
+            INST<Opcode::RET>(3, 2),
+        }),
+    });
+
+    caller->RunPass<Inlining>();
+    ASSERT_EQ(CountCalls(caller), 0);
+    Inst* param = caller->GetBasicBlocks()[0]->GetFirstInst();
+    ASSERT_EQ(param->GetOpcode(), Opcode::PARAMETER);
+    ASSERT_EQ(param->GetUsers().size(), 1);
+    Inst* sub = param->GetUsers()[0];
+    ASSERT_EQ(sub->GetOpcode(), Opcode::SUB);
+    ASSERT_EQ(sub->CastToInstWithTwoInputs()->GetInput1(), param);
+    ASSERT_EQ(sub->CastToInstWithTwoInputs()->GetInput2(), param);
+    ASSERT_EQ(callee->GetBasicBlocks()[0]->GetSize(), 4);
+}
+
+TEST(INLINING_TEST, TEST17) {
+    // every method has its own budget, which is kept between runs of the pass
+    constexpr uint32_t CALLEE_SIZE = Inlining::MAX_CALLEE_SIZE;
+    constexpr uint32_t CALLS_NUM = Inlining::INLINE_BUDGET / CALLEE_SIZE + 1;
+    Graph* callee = BuildLinearCallee(1, CALLEE_SIZE);
+
+    CompilationContext context;
+    IrBuilder irb(&context);
+    std::vector<Inst*> insts = {INST<Opcode::PARAMETER>(1)};
+    for (uint32_t i = 0; i < CALLS_NUM; ++i) {
+        insts.push_back(INST<Opcode::CALL_STATIC>(2 + i, callee, 1));
+    }
+    insts.push_back(INST<Opcode::RET_VOID>(2 + CALLS_NUM));
+    Graph* first = GRAPH({
+        BASIC_BLOCK<0>(insts),
+    });
+
+    irb = IrBuilder(&context);
+    Graph* second = GRAPH({
+        BASIC_BLOCK<1>({
+            INST<Opcode::PARAMETER>(100),
+            INST<Opcode::CALL_STATIC>(101, callee, 100),
+            INST<Opcode::RET>(102, 101),
+        }),
+    });
+
+    first->RunPass<Inlining>();
+    ASSERT_EQ(CountCalls(first), 1);
+    ASSERT_EQ(first->GetInlinedSize(), Inlining::INLINE_BUDGET);
+    first->RunPass<Inlining>();
+    ASSERT_EQ(CountCalls(first), 1);
+    second->RunPass<Inlining>();
+    ASSERT_EQ(CountCalls(second), 0);
+    ASSERT_EQ(second->GetInlinedSize(), CALLEE_SIZE);
+}
+
+// every instruction of the opcode in the graph
+static std::vector<Inst*> CollectInsts(Graph* g, Opcode opcode)
+{
+    std::vector<Inst*> insts;
+    for (auto bb: g->GetBasicBlocks()) {
+        for (auto inst: bb->Insts(opcode)) {
+            insts.push_back(inst);
+        }
+    }
+    return insts;
+}
+
+TEST(INLINING_TEST, TEST18) {
+    // constants of inlined callees are placed after parameters,
+    // so that the caller is inlined into its own callers correctly
+    std::vector<Graph*> graphs = IrParser().Parse(
+        "method top {\n"
+        "bb0:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = CONSTANT 3\n"
+        "    v2 = CALL_STATIC @mid(v0)\n"
+        "    v3 = SUB v2, v1\n"
+        "    v4 = RET v3\n"
+        "}\n"
+        "method mid {\n"
+        "bb0:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = CONSTANT 2\n"
+        "    v2 = CALL_STATIC @leaf(v0)\n"
+        "    v3 = ADD v2, v1\n"
+        "    v4 = RET v3\n"
+        "}\n"
+        "method leaf {\n"
+        "bb0:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = CONSTANT 10\n"
+        "    v2 = MUL v0, v1\n"
+        "    v3 = RET v2\n"
+        "}\n");
+    Graph* top = graphs[0];
+    InliningDriver().Run(graphs);
+    ASSERT_EQ(CountCalls(top), 0);
+    // call graph of the driver is not kept after it
+    ASSERT_EQ(top->GetContext()->GetCallGraph(), nullptr);
+
+    std::vector<Inst*> params = CollectInsts(top, Opcode::PARAMETER);
+    ASSERT_EQ(params.size(), 1);
+    ASSERT_EQ(top->GetBasicBlocks()[0]->GetFirstInst(), params[0]);
+    std::vector<Inst*> muls = CollectInsts(top, Opcode::MUL);
+    ASSERT_EQ(muls.size(), 1);
+    ASSERT_EQ(muls[0]->GetInput(0), params[0]);
+    ASSERT_EQ(muls[0]->GetInput(1)->GetOpcode(), Opcode::CONSTANT);
+    ASSERT_EQ(muls[0]->GetInput(1)->CastToInstConstant()->GetConstant(), 10);
+    Inst* add = CollectInsts(top, Opcode::ADD)[0];
+    ASSERT_EQ(add->GetInput(0), muls[0]);
+    ASSERT_EQ(add->GetInput(1)->CastToInstConstant()->GetConstant(), 2);
+    Inst* sub = CollectInsts(top, Opcode::SUB)[0];
+    ASSERT_EQ(sub->GetInput(0), add);
+    ASSERT_EQ(sub->GetInput(1)->CastToInstConstant()->GetConstant(), 3);
+}
+
+TEST(INLINING_TEST, TEST19) {
+    // accessor, entry block of which has only constants after return is removed
+    std::vector<Graph*> graphs = IrParser().Parse(
+        "method caller {\n"
+        "bb0:\n"
+        "    v0 = CALL_STATIC @leaf()\n"
+        "    v1 = RET v0\n"
+        "}\n"
+        "method leaf {\n"
+        "bb0:\n"
+        "    v0 = CONSTANT 10\n"
+        "    v1 = RET v0\n"
+        "}\n");
+    Graph* caller = graphs[0];
+    InliningDriver().Run(graphs);
+    ASSERT_EQ(CountCalls(caller), 0);
+    Inst* ret = CollectInsts(caller, Opcode::RET)[0];
+    ASSERT_EQ(ret->GetInput(0)->GetOpcode(), Opcode::CONSTANT);
+    ASSERT_EQ(ret->GetInput(0)->CastToInstConstant()->GetConstant(), 10);
+    ASSERT_EQ(ret->GetInput(0)->GetBB(), caller->GetBasicBlocks()[0]);
+}
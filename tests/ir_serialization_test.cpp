@@ -0,0 +1,119 @@
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "ir/ir_parser.h"
+#include "ir/ir_printer.h"
+#include "ir/ir_serializer.h"
+#include "pass/pipeline.h"
+#include "pass/reg_alloc.h"
+
+static const char* CALLS_TEXT =
+    "method caller {\n"
+    "bb0 -> bb1:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = CONSTANT 0\n"
+    "    v2 = CONSTANT 1\n"
+    "bb1 -> bb3, bb2:\n"
+    "    v3 = PHI (v1, bb0), (v6, bb2)\n"
+    "    v4 = CMP v3, v0\n"
+    "    v5 = JMP_GE bb3\n"
+    "bb2 -> bb1:\n"
+    "    v6 = CALL_STATIC @callee(v3, v2)\n"
+    "    v7 = JMP bb1\n"
+    "bb3:\n"
+    "    v8 = RET v3\n"
+    "}\n"
+    "\n"
+    "method callee {\n"
+    "bb0:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = PARAMETER\n"
+    "    v2 = CONSTANT -7\n"
+    "    v3 = ADD v0, v1\n"
+    "    v4 = MUL v3, v2\n"
+    "    v5 = RET v4\n"
+    "}\n";
+
+TEST(SERIALIZATION_TEST, TEST1) {
+    // instructions, users, phis and calls are restored, callee follows caller
+    std::vector<Graph*> methods = IrParser().Parse(CALLS_TEXT);
+    std::vector<uint8_t> data = IrSerializer().Serialize({methods[0]});
+
+    std::vector<Graph*> restored = IrDeserializer().Deserialize(data.data(), data.size());
+    ASSERT_EQ(restored.size(), 2);
+    ASSERT_EQ(restored[0]->GetName(), "caller");
+    ASSERT_EQ(restored[0]->GetInstById(6)->CastToInstCall()->GetCallee(), restored[1]);
+    ASSERT_EQ(restored[0]->GetBBbyId(1)->GetPreds()[1], restored[0]->GetBBbyId(2));
+    ASSERT_EQ(restored[0]->GetInstById(3)->GetUsers().size(), 3);
+    ASSERT_EQ(restored[1]->GetInstById(2)->CastToInstConstant()->GetConstant(), -7);
+    ASSERT_EQ(restored[0]->NewInstId(), 9);
+    ASSERT_EQ(IrPrinter().Print(restored), CALLS_TEXT);
+}
+
+TEST(SERIALIZATION_TEST, TEST2) {
+    // allocated graph is restored with live intervals and locations,
+    // and passes with serialized results are not rerun
+    Graph* g = IrParser().Parse(CALLS_TEXT)[0];
+    g->GetContext()->SetRegCount(2);
+    Pipeline::Create(OptLevel::O1).Run(g);
+    g->RunPass<RegAlloc>();
+    std::vector<uint8_t> data = IrSerializer().Serialize({g});
+
+    Graph* restored = IrDeserializer().Deserialize(data.data(), data.size())[0];
+    ASSERT_EQ(IrPrinter().Print({restored}), IrPrinter().Print({g}));
+    ASSERT_EQ(restored->GetLinearOrder().size(), g->GetLinearOrder().size());
+    for (size_t i = 0; i < g->GetLinearOrder().size(); ++i) {
+        ASSERT_EQ(restored->GetLinearOrder()[i]->GetId(), g->GetLinearOrder()[i]->GetId());
+    }
+    ASSERT_EQ(restored->GetLiveIntervals().size(), g->GetLiveIntervals().size());
+    for (auto [inst, interval]: g->GetLiveIntervals()) {
+        Inst* restored_inst = restored->GetInstById(inst->GetId());
+        ASSERT_EQ(restored_inst->GetLiveNumber(), inst->GetLiveNumber());
+        LiveInterval* restored_interval = restored->GetLiveIntervals().at(restored_inst);
+        ASSERT_EQ(restored_interval->GetStart(), interval->GetStart());
+        ASSERT_EQ(restored_interval->GetEnd(), interval->GetEnd());
+        ASSERT_EQ(restored_interval->GetLocation(), interval->GetLocation());
+        ASSERT_EQ(restored_interval->GetIsStackLocation(), interval->GetIsStackLocation());
+    }
+
+    ASSERT_TRUE(restored->IsPassValid<RegAlloc>());
+    ASSERT_TRUE(restored->IsPassValid<Peephole>());
+    ASSERT_FALSE(restored->IsPassValid<LoopAnalyzer>());
+    Pipeline::Create(OptLevel::O1).Run(restored);
+    ASSERT_EQ(restored->GetContext()->GetStatistics().Get("Peephole.Runs"), 0);
+}
+
+TEST(SERIALIZATION_TEST, TEST3) {
+    // data of another version, truncated or with invalid indices is rejected
+    std::vector<Graph*> methods = IrParser().Parse(CALLS_TEXT);
+    std::vector<uint8_t> data = IrSerializer().Serialize(methods);
+    ASSERT_EQ(IrDeserializer().Deserialize(data.data(), data.size()).size(), 2);
+
+    auto* header = reinterpret_cast<ir_serialization::FileHeader*>(data.data());
+    header->version_++;
+    ASSERT_TRUE(IrDeserializer().Deserialize(data.data(), data.size()).empty());
+    header->version_--;
+    ASSERT_TRUE(IrDeserializer().Deserialize(data.data(), data.size() - 4).empty());
+
+    auto* methods_records = reinterpret_cast<ir_serialization::MethodRecord*>(header + 1);
+    auto* bb_records = reinterpret_cast<ir_serialization::BlockRecord*>(methods_records + header->methods_num_);
+    auto* inst_records = reinterpret_cast<ir_serialization::InstRecord*>(bb_records + header->bbs_num_);
+    inst_records[0].users_begin_ = header->words_num_;
+    ASSERT_TRUE(IrDeserializer().Deserialize(data.data(), data.size()).empty());
+}
+
+TEST(SERIALIZATION_TEST, TEST4) {
+    // file is read in place, methods may share a context
+    std::vector<Graph*> methods = IrParser().Parse(CALLS_TEXT);
+    std::string path = testing::TempDir() + "serialization_test.coir";
+    IrSerializer().SerializeToFile(methods, path);
+
+    CompilationContext context;
+    std::vector<Graph*> restored = IrDeserializer(&context).DeserializeFile(path);
+    std::remove(path.c_str());
+    ASSERT_EQ(restored.size(), 2);
+    ASSERT_EQ(restored[1]->GetContext(), &context);
+    ASSERT_EQ(IrPrinter().Print(restored), CALLS_TEXT);
+    ASSERT_TRUE(IrDeserializer().DeserializeFile(path).empty());
+}
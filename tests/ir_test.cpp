@@ -1,6 +1,10 @@
 #include "gtest/gtest.h"
 
+#include <thread>
+
+#include "ir/graph_cloner.h"
 #include "ir/ir_builder.h"
+#include "ir/ir_parser.h"
 
 #define INST irb.InstBuilder
 #define BASIC_BLOCK irb.BasicBlockBuilder
@@ -119,4 +123,286 @@ TEST(IR_TEST, TEST1) {
     assert(bb1inst3->GetType() == Type::InstConstant);
 
     // TODO finish test
-}
\ No newline at end of file
+}
+TEST(IR_TEST, TEST2) {
+    // every graph has compact ids, unless context is shared
+    IrBuilder irb;
+    Graph* g1 = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(0),
+            INST<Opcode::RET>(1, 0),
+        }),
+    });
+    irb = IrBuilder();
+    Graph* g2 = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(0),
+            INST<Opcode::RET>(1, 0),
+        }),
+    });
+    ASSERT_NE(g1->GetContext(), g2->GetContext());
+    ASSERT_EQ(g1->NewInstId(), 2);
+    ASSERT_EQ(g2->NewInstId(), 2);
+    ASSERT_EQ(g2->NewBBId(), 1);
+
+    CompilationContext context;
+    context.SetRegCount(5);
+    irb = IrBuilder(&context);
+    Graph* g3 = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(0),
+            INST<Opcode::RET>(1, 0),
+        }),
+    });
+    irb = IrBuilder(&context);
+    Graph* g4 = GRAPH({
+        BASIC_BLOCK<3>({
+            INST<Opcode::PARAMETER>(7),
+            INST<Opcode::RET>(8, 7),
+        }),
+    });
+    ASSERT_EQ(g3->GetContext(), &context);
+    ASSERT_EQ(g4->GetContext()->GetRegCount(), 5);
+    ASSERT_EQ(g3->NewInstId(), 9);
+    ASSERT_EQ(g4->NewInstId(), 10);
+    ASSERT_EQ(g3->NewBBId(), 4);
+}
+
+TEST(IR_TEST, TEST3) {
+    // arena returns aligned memory, big objects get separate chunks
+    ArenaAllocator arena;
+    auto first = static_cast<uint8_t*>(arena.Allocate(1, 1));
+    auto second = arena.Allocate(sizeof(uint64_t), alignof(uint64_t));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(second) % alignof(uint64_t), 0);
+    ASSERT_LT(static_cast<uint8_t*>(second) - first, alignof(uint64_t) + 1);
+
+    void* big = arena.Allocate(2 * ArenaAllocator::CHUNK_SIZE);
+    ASSERT_NE(big, nullptr);
+    LiveInterval* interval = arena.New<LiveInterval>(3, 5);
+    ASSERT_EQ(interval->GetStart(), 3);
+    ASSERT_EQ(interval->GetEnd(), 5);
+    ASSERT_EQ(arena.GetAllocatedSize(), 1 + sizeof(uint64_t) + 2 * ArenaAllocator::CHUNK_SIZE + sizeof(LiveInterval));
+}
+
+TEST(IR_TEST, TEST4) {
+    // instructions are freed by another thread and reused, as in the driver
+    std::vector<Inst*> insts;
+    std::thread([&insts]() {
+        for (uint32_t i = 0; i < 1000; ++i) {
+            insts.push_back(Inst::InstBuilder(i % 2 == 0 ? Opcode::ADD : Opcode::PHI, i));
+        }
+    }).join();
+    for (uint32_t i = 0; i < insts.size(); ++i) {
+        ASSERT_EQ(insts[i]->GetId(), i);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(insts[i]) % alignof(std::max_align_t), 0);
+        Inst::InstDestroyer(insts[i]);
+    }
+    insts.clear();
+    std::thread([&insts]() {
+        for (uint32_t i = 0; i < 1000; ++i) {
+            insts.push_back(Inst::InstBuilder(Opcode::CONSTANT, i));
+        }
+    }).join();
+    std::sort(insts.begin(), insts.end());
+    ASSERT_EQ(std::unique(insts.begin(), insts.end()), insts.end());
+    for (auto inst: insts) {
+        Inst::InstDestroyer(inst);
+    }
+}
+
+template <typename Range>
+static std::vector<uint32_t> GetIds(Range range)
+{
+    std::vector<uint32_t> ids;
+    for (auto inst: range) {
+        ids.push_back(inst->GetId());
+    }
+    return ids;
+}
+
+TEST(IR_TEST, TEST5) {
+    // ranges of block and graph instructions
+    Graph* g = IrParser().Parse(
+        "method ranges {\n"
+        "bb0 -> bb1:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = CALL_STATIC @ranges(v0)\n"
+        "bb1:\n"
+        "    v2 = PHI (v0, bb0)\n"
+        "    v3 = PHI (v1, bb0)\n"
+        "    v4 = CALL_STATIC @ranges(v3)\n"
+        "    v5 = ADD v2, v4\n"
+        "    v6 = RET v5\n"
+        "}\n")[0];
+    BasicBlock* bb0 = g->GetBBbyId(0);
+    BasicBlock* bb1 = g->GetBBbyId(1);
+    ASSERT_EQ(GetIds(bb1->Insts()), std::vector<uint32_t>({2, 3, 4, 5, 6}));
+    ASSERT_EQ(GetIds(bb1->InstsReverse()), std::vector<uint32_t>({6, 5, 4, 3, 2}));
+    ASSERT_EQ(GetIds(bb1->Phis()), std::vector<uint32_t>({2, 3}));
+    ASSERT_TRUE(bb0->Phis().empty());
+    ASSERT_EQ(GetIds(bb1->Insts(Opcode::CALL_STATIC)), std::vector<uint32_t>({4}));
+    ASSERT_EQ(GetIds(g->Insts()), std::vector<uint32_t>({0, 1, 2, 3, 4, 5, 6}));
+    ASSERT_EQ(GetIds(g->Insts(Opcode::CALL_STATIC)), std::vector<uint32_t>({1, 4}));
+    ASSERT_EQ(GetIds(g->Phis()), std::vector<uint32_t>({2, 3}));
+
+    // visited instructions are unlinked by safe ranges
+    std::vector<Inst*> unbound;
+    for (auto inst: bb1->InstsSafeReverse()) {
+        if (inst->GetOpcode() != Opcode::RET) {
+            bb1->UnbindInst(inst);
+            unbound.push_back(inst);
+        }
+    }
+    ASSERT_EQ(GetIds(bb1->Insts()), std::vector<uint32_t>({6}));
+    ASSERT_EQ(bb1->GetSize(), 1);
+    for (auto inst: unbound) {
+        Inst::InstDestroyer(inst);
+    }
+    Graph::GraphDestroyer(g);
+}
+
+TEST(IR_TEST, TEST6) {
+    // inputs of all instructions are visited in the same way
+    std::vector<Inst*> params;
+    for (uint32_t i = 0; i < 4; i++) {
+        params.push_back(Inst::InstBuilder(Opcode::PARAMETER, i));
+    }
+    Inst* add = Inst::InstBuilder(Opcode::ADD, 4);
+    add->CastToInstWithTwoInputs()->SetInput1(params[0]);
+    add->CastToInstWithTwoInputs()->SetInput2(params[1]);
+    ASSERT_EQ(add->GetInputCount(), 2);
+    ASSERT_EQ(add->GetInput(1), params[1]);
+    ASSERT_EQ(params[0]->GetInputCount(), 0);
+
+    // phi moves inputs to the heap, when it has more than two of them
+    InstPhi* phi = Inst::InstBuilder(Opcode::PHI, 5)->CastToInstPhi();
+    for (auto param: params) {
+        phi->AddInput(param, nullptr);
+    }
+    phi->AddInput(params[2], nullptr);
+    ASSERT_EQ(std::vector<Inst*>(phi->GetInputs().begin(), phi->GetInputs().end()), params);
+    ASSERT_EQ(phi->GetInputBB().size(), 4);
+
+    phi->RemoveInput(params[0]);
+    ASSERT_EQ(std::vector<Inst*>(phi->GetInputs().begin(), phi->GetInputs().end()),
+              std::vector<Inst*>({params[3], params[1], params[2]}));
+    phi->SubstituteInput(params[1], add);
+    ASSERT_EQ(phi->GetInput(1), add);
+    ASSERT_EQ(phi->GetInputBB().size(), 3);
+
+    Inst* call = Inst::InstBuilder(Opcode::CALL_STATIC, 6);
+    call->CastToInstCall()->SetArguments(params);
+    call->SubstituteInput(params[3], params[0]);
+    ASSERT_EQ(call->CastToInstCall()->GetArguments().size(), 4);
+    ASSERT_EQ(call->GetInput(3), params[0]);
+
+    for (auto inst: {add, static_cast<Inst*>(phi), call}) {
+        Inst::InstDestroyer(inst);
+    }
+    for (auto param: params) {
+        Inst::InstDestroyer(param);
+    }
+}
+
+TEST(IR_TEST, TEST7) {
+    // markers do not run out in long pipelines
+    Graph* g = IrParser().Parse(
+        "method markers {\n"
+        "bb0 -> bb1:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = JMP bb1\n"
+        "bb1:\n"
+        "    v2 = RET v0\n"
+        "}\n")[0];
+    BasicBlock* bb0 = g->GetBBbyId(0);
+    Inst* v0 = g->GetInstById(0);
+    for (uint32_t i = 0; i < 100000; i++) {
+        marker mrk = g->NewMarker();
+        ASSERT_FALSE(v0->IsMarked(mrk));
+        v0->SetMarker(mrk);
+        ASSERT_TRUE(v0->IsMarked(mrk));
+        g->EraseMarker(mrk);
+    }
+
+    // marker alive during many traversals keeps its marks,
+    // erased markers leave no marks in reused slots
+    marker outer = g->NewMarker();
+    bb0->SetMarker(outer);
+    std::vector<marker> nested;
+    for (uint32_t i = 0; i < MARKER_NUM - 1; i++) {
+        nested.push_back(g->NewMarker());
+        v0->SetMarker(nested.back());
+        bb0->SetMarker(nested.back());
+    }
+    for (auto mrk: nested) {
+        g->EraseMarker(mrk);
+    }
+    for (uint32_t i = 0; i < 3 * MARKER_NUM; i++) {
+        marker mrk = g->NewMarker();
+        ASSERT_FALSE(v0->IsMarked(mrk));
+        ASSERT_FALSE(bb0->IsMarked(mrk));
+        bb0->SetMarker(mrk);
+        g->EraseMarker(mrk);
+    }
+    ASSERT_TRUE(bb0->IsMarked(outer));
+    bb0->ResetMarker(outer);
+    ASSERT_FALSE(bb0->IsMarked(outer));
+    g->EraseMarker(outer);
+    Graph::GraphDestroyer(g);
+}
+
+TEST(IR_TEST, TEST8) {
+    // copy shares nothing with source and generates fresh ids
+    Graph* src = IrParser().Parse(
+        "method loop {\n"
+        "bb0 -> bb1:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = CONSTANT 0\n"
+        "    v2 = CONSTANT 1\n"
+        "bb1 -> bb3, bb2:\n"
+        "    v3 = PHI (v1, bb0), (v6, bb2)\n"
+        "    v4 = CMP v3, v0\n"
+        "    v5 = JMP_GE bb3\n"
+        "bb2 -> bb1:\n"
+        "    v6 = ADD v3, v2\n"
+        "    v7 = JMP bb1\n"
+        "bb3:\n"
+        "    v8 = RET v3\n"
+        "}\n")[0];
+    GraphCloner cloner;
+    Graph* dst = cloner.CloneGraph(src);
+    ASSERT_NE(dst->GetContext(), src->GetContext());
+    ASSERT_EQ(dst->GetInstsNum(), src->GetInstsNum());
+    ASSERT_EQ(dst->NewInstId(), 9);
+    ASSERT_EQ(dst->NewBBId(), 4);
+
+    Inst* src_phi = src->GetInstById(3);
+    Inst* dst_phi = cloner.GetClonedInst(src_phi);
+    ASSERT_NE(dst_phi, src_phi);
+    ASSERT_EQ(dst_phi->GetId(), 3);
+    ASSERT_EQ(dst_phi->GetBB(), dst->GetBBbyId(1));
+    ASSERT_EQ(dst_phi->GetInput(0), dst->GetInstById(1));
+    ASSERT_EQ(dst_phi->GetInput(1), dst->GetInstById(6));
+    ASSERT_EQ(dst_phi->CastToInstPhi()->GetInputBB()[0], dst->GetBBbyId(0));
+    ASSERT_EQ(dst_phi->CastToInstPhi()->GetInputBB()[1], dst->GetBBbyId(2));
+    for (auto user: dst_phi->GetUsers()) {
+        ASSERT_EQ(user->GetBB()->GetGraph(), dst);
+    }
+    ASSERT_EQ(dst->GetInstById(5)->CastToInstJmp()->GetTargetBB(), dst->GetBBbyId(3));
+    ASSERT_EQ(dst->GetBBbyId(1)->GetPreds()[1], dst->GetBBbyId(2));
+
+    // mutating copy leaves source intact
+    Inst* dst_add = dst->GetInstById(6);
+    dst_add->GetInput(1)->RemoveUser(dst_add);
+    dst_add->SubstituteInput(dst_add->GetInput(1), dst->GetInstById(0));
+    dst->GetInstById(0)->AddUser(dst_add);
+    dst->GetBBbyId(1)->PopFrontInst();
+    ASSERT_EQ(src->GetBBbyId(1)->GetFirstInst(), src_phi);
+    ASSERT_EQ(src->GetInstById(6)->GetInput(1), src->GetInstById(2));
+    ASSERT_EQ(src->GetInstById(2)->GetUsers().size(), 1);
+    ASSERT_EQ(src->GetInstById(0)->GetUsers().size(), 1);
+    ASSERT_EQ(src_phi->GetUsers().size(), 3);
+
+    Graph::GraphDestroyer(src);
+    Graph::GraphDestroyer(dst);
+}
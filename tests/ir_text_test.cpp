@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+
+#include "ir/ir_builder.h"
+#include "ir/ir_parser.h"
+#include "ir/ir_printer.h"
+#include "pass/pipeline.h"
+#include "pass/reg_alloc.h"
+
+#define INST irb.InstBuilder
+#define BASIC_BLOCK irb.BasicBlockBuilder
+#define GRAPH irb.GraphBuilder
+
+static const char* LOOP_TEXT =
+    "method loop {\n"
+    "bb0 -> bb1:\n"
+    "    v0 = PARAMETER\n"
+    "    v1 = CONSTANT 0\n"
+    "    v2 = CONSTANT 1\n"
+    "bb1 -> bb3, bb2:\n"
+    "    v3 = PHI (v1, bb0), (v6, bb2)\n"
+    "    v4 = CMP v3, v0\n"
+    "    v5 = JMP_GE bb3\n"
+    "bb2 -> bb1:\n"
+    "    v6 = ADD v3, v2\n"
+    "    v7 = JMP bb1\n"
+    "bb3:\n"
+    "    v8 = RET v3\n"
+    "}\n";
+
+TEST(IR_TEXT_TEST, TEST1) {
+    // graph built by IrBuilder is printed
+    IrBuilder irb;
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0, 1, 2>({
+            INST<Opcode::PARAMETER>(0),
+            INST<Opcode::CONSTANT>(1, -5),
+            INST<Opcode::CMP>(2, 0, 1),
+            INST<Opcode::JMP_EQ>(3, 1),
+        }),
+        BASIC_BLOCK<2, 1>({
+            INST<Opcode::NOT>(4, 0),
+            INST<Opcode::JMP>(5, 1),
+        }),
+        BASIC_BLOCK<1>({
+            INST<Opcode::PHI>(6, 1, 0, 4, 2),
+            INST<Opcode::RET>(7, 6),
+        }),
+    });
+    g->SetName("diamond");
+
+    const char* expected =
+        "method diamond {\n"
+        "bb0 -> bb1, bb2:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = CONSTANT -5\n"
+        "    v2 = CMP v0, v1\n"
+        "    v3 = JMP_EQ bb1\n"
+        "bb2 -> bb1:\n"
+        "    v4 = NOT v0\n"
+        "    v5 = JMP bb1\n"
+        "bb1:\n"
+        "    v6 = PHI (v1, bb0), (v4, bb2)\n"
+        "    v7 = RET v6\n"
+        "}\n";
+    IrPrinter printer;
+    ASSERT_EQ(printer.Print({g}), expected);
+}
+
+TEST(IR_TEXT_TEST, TEST2) {
+    // blocks and instructions are referred before definition
+    std::vector<Graph*> methods = IrParser().Parse(LOOP_TEXT);
+    ASSERT_EQ(methods.size(), 1);
+    Graph* g = methods[0];
+    ASSERT_EQ(g->GetName(), "loop");
+    ASSERT_EQ(g->GetBasicBlocks().size(), 4);
+    ASSERT_EQ(g->GetInstsNum(), 9);
+
+    BasicBlock* header = g->GetBBbyId(1);
+    ASSERT_EQ(header->GetPreds().size(), 2);
+    ASSERT_EQ(header->GetPreds()[0]->GetId(), 0);
+    ASSERT_EQ(header->GetPreds()[1]->GetId(), 2);
+    ASSERT_EQ(header->GetSuccs()[BasicBlock::TRUE_BRANCH_INDEX]->GetId(), 3);
+    ASSERT_EQ(header->GetSuccs()[BasicBlock::FALSE_BRANCH_INDEX]->GetId(), 2);
+    ASSERT_EQ(header->GetLastInst()->CastToInstJmp()->GetTargetBB(), g->GetBBbyId(3));
+
+    InstPhi* phi = header->GetFirstInst()->CastToInstPhi();
+    ASSERT_EQ(phi->GetInputInst()[1], g->GetInstById(6));
+    ASSERT_EQ(phi->GetInputBB()[1], g->GetBBbyId(2));
+    ASSERT_EQ(phi->GetUsers().size(), 3);
+    ASSERT_EQ(g->GetInstById(6)->GetUsers()[0], phi);
+
+    // ids of the graph are taken
+    ASSERT_EQ(g->NewInstId(), 9);
+    ASSERT_EQ(g->NewBBId(), 4);
+
+    ASSERT_EQ(IrPrinter().Print(methods), LOOP_TEXT);
+}
+
+TEST(IR_TEXT_TEST, TEST3) {
+    // callee is defined after caller, spaces and comments are ignored
+    const char* text =
+        "# caller\n"
+        "method caller{bb0:v0=CONSTANT 10 v1=CALL_STATIC @callee( v0 ) v2=RET v1}\n"
+        "method callee {\n"
+        "bb0:\n"
+        "    v0 = PARAMETER # argument\n"
+        "    v1 = CONSTANT 3\n"
+        "    v2 = SUB v0, v1\n"
+        "    v3 = RET v2\n"
+        "}\n";
+    std::vector<Graph*> methods = IrParser().Parse(text);
+    ASSERT_EQ(methods.size(), 2);
+    Graph* caller = methods[0];
+    InstCall* call = caller->GetInstById(1)->CastToInstCall();
+    ASSERT_EQ(call->GetCallee(), methods[1]);
+    ASSERT_EQ(call->GetArguments().size(), 1);
+    ASSERT_EQ(caller->GetInstById(0)->GetUsers()[0], call);
+
+    // callee, which is not printed explicitly, follows caller
+    std::string printed = IrPrinter().Print({caller});
+    ASSERT_EQ(IrPrinter().Print(IrParser().Parse(printed)), printed);
+    ASSERT_NE(printed.find("v1 = CALL_STATIC @callee(v0)\n"), std::string::npos);
+    ASSERT_NE(printed.find("method callee {\n"), std::string::npos);
+
+    Pipeline::Create(OptLevel::O2).Run(caller);
+    Inst* result = caller->GetBasicBlocks().back()->GetLastInst()->CastToInstWithOneInput()->GetInput1();
+    ASSERT_EQ(result->GetOpcode(), Opcode::CONSTANT);
+    ASSERT_EQ(result->CastToInstConstant()->GetConstant(), 7);
+}
+
+TEST(IR_TEXT_TEST, TEST4) {
+    // methods of one parser may share a context, optimized graph is printed
+    // and parsed back to the same text
+    CompilationContext context;
+    std::vector<Graph*> methods = IrParser(&context).Parse(LOOP_TEXT);
+    Graph* g = methods[0];
+    ASSERT_EQ(g->GetContext(), &context);
+    Pipeline::Create(OptLevel::O2).Run(g);
+    g->RunPass<RegAlloc>();
+
+    IrPrinter printer;
+    std::string printed = printer.Print(methods);
+    ASSERT_EQ(printer.Print(IrParser().Parse(printed)), printed);
+}
+
+TEST(IR_TEXT_TEST, TEST5) {
+    // unnamed graphs get names, phi without inputs and empty calls are printed
+    Graph* callee = IrParser().Parse("method f { bb0: v0 = RET_VOID }")[0];
+    callee->SetName("");
+    IrBuilder irb;
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PHI>(0),
+            INST<Opcode::CALL_STATIC>(1, callee),
+            INST<Opcode::RET_VOID>(2),
+        }),
+    });
+
+    const char* expected =
+        "method method0 {\n"
+        "bb0:\n"
+        "    v0 = PHI\n"
+        "    v1 = CALL_STATIC @method1()\n"
+        "    v2 = RET_VOID\n"
+        "}\n"
+        "\n"
+        "method method1 {\n"
+        "bb0:\n"
+        "    v0 = RET_VOID\n"
+        "}\n";
+    std::string printed = IrPrinter().Print({g});
+    ASSERT_EQ(printed, expected);
+    ASSERT_EQ(IrPrinter().Print(IrParser().Parse(printed)), printed);
+}
+
+TEST(IR_TEXT_TEST, TEST6) {
+    // generated name does not collide with a callee printed later
+    Graph* callee = IrParser().Parse("method method0 { bb0: v0 = RET_VOID }")[0];
+    IrBuilder irb;
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::CALL_STATIC>(0, callee),
+            INST<Opcode::RET_VOID>(1),
+        }),
+    });
+    std::string printed = IrPrinter().Print({g});
+    ASSERT_EQ(printed.find("method method0_ {\n"), 0);
+    std::vector<Graph*> parsed = IrParser().Parse(printed);
+    ASSERT_EQ(parsed.size(), 2);
+    ASSERT_EQ(IrPrinter().Print(parsed), printed);
+
+    // invalid text is reported instead of aborting
+    IrParser parser;
+    std::vector<Graph*> methods;
+    ASSERT_FALSE(parser.TryParse("method f {\nbb0 -> bb1:\n    v0 = PARAMETER\n    v1 = MOVE v0\n}\n", &methods));
+    ASSERT_EQ(parser.GetError(), "IR parsing error, line 4: unknown opcode 'MOVE'");
+    ASSERT_TRUE(methods.empty());
+    ASSERT_FALSE(parser.TryParse("method f { bb0: v0 = CALL_STATIC @g() }", &methods));
+    ASSERT_NE(parser.GetError().find("method @g is called, but not defined"), std::string::npos);
+    ASSERT_FALSE(parser.TryParseFile(testing::TempDir() + "missing.ir", &methods));
+    ASSERT_TRUE(parser.TryParse(LOOP_TEXT, &methods));
+    ASSERT_EQ(methods.size(), 1);
+    ASSERT_TRUE(parser.GetError().empty());
+}
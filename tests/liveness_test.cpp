@@ -269,3 +269,58 @@ TEST(LIVENESS_TEST, TEST5)
         {11, {26, 28}}, {12, {28, 30}}, {13, {0, 0}},
     });
 }
+
+TEST(LIVENESS_TEST, TEST6)
+{
+    // loop with two latches
+    IrBuilder irb;
+    /*
+                0
+                |
+                v
+      |-------->1----|
+      |         |    |True
+      |         v    v
+      |   |-----2    5
+      |   |True |
+      |   v     v
+      |---3     4
+      ^         |
+      |---------|
+    */
+    Graph *g = GRAPH({
+        BASIC_BLOCK<0, 1>({
+            INST<Opcode::CONSTANT>(0, 1),
+            INST<Opcode::CONSTANT>(1, 10),
+        }),
+        BASIC_BLOCK<1, 5, 2>({
+            INST<Opcode::PHI>(2, 1, 0, 7, 3, 8, 4),
+            INST<Opcode::CMP>(3, 2, 0),
+            INST<Opcode::JMP_EQ>(4, 5),
+        }),
+        BASIC_BLOCK<2, 3, 4>({
+            INST<Opcode::CMP>(5, 2, 1),
+            INST<Opcode::JMP_EQ>(6, 3),
+        }),
+        BASIC_BLOCK<3, 1>({
+            INST<Opcode::ADD>(7, 2, 1),
+            INST<Opcode::JMP>(9, 1),
+        }),
+        BASIC_BLOCK<4, 1>({
+            INST<Opcode::SUB>(8, 2, 1),
+            INST<Opcode::JMP>(10, 1),
+        }),
+        BASIC_BLOCK<5>({
+            INST<Opcode::RET>(11, 2),
+        }),
+    });
+    g->RunPass<LivenessAnalysis>();
+    // linear order is 0, 1, 2, 4, 3, 5: values used in header
+    // are live up to the end of the last latch
+    CheckLiveIntervals(g, {
+        {0, {2, 30}}, {1, {4, 30}}, {2, {6, 32}},
+        {3, {0, 0}}, {4, {0, 0}}, {5, {0, 0}},
+        {6, {0, 0}}, {7, {26, 30}}, {8, {20, 24}},
+        {9, {0, 0}}, {10, {0, 0}}, {11, {32, 34}},
+    });
+}
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include "driver/parallel_compiler.h"
+#include "ir/ir_builder.h"
+
+#define INST irb.InstBuilder
+#define BASIC_BLOCK irb.BasicBlockBuilder
+#define GRAPH irb.GraphBuilder
+
+void SubmitRecursively(ThreadPool& pool, std::atomic<uint32_t>& counter, uint32_t depth)
+{
+    counter++;
+    if (depth == 0) {
+        return;
+    }
+    for (int i = 0; i < 2; ++i) {
+        pool.Submit([&pool, &counter, depth]() { SubmitRecursively(pool, counter, depth - 1); });
+    }
+}
+
+Inst* GetReturnedInst(Graph* g)
+{
+    for (auto bb: g->GetBasicBlocks()) {
+        Inst* last_inst = bb->GetLastInst();
+        if (last_inst != nullptr && last_inst->GetOpcode() == Opcode::RET) {
+            return last_inst->CastToInstWithOneInput()->GetInput1();
+        }
+    }
+    return nullptr;
+}
+
+TEST(PARALLEL_COMPILER_TEST, TEST1) {
+    // tasks submitted by tasks are waited for
+    constexpr uint32_t DEPTH = 10;
+    std::atomic<uint32_t> counter = 0;
+    ThreadPool pool(4);
+    pool.Submit([&pool, &counter]() { SubmitRecursively(pool, counter, DEPTH); });
+    pool.Wait();
+
+    ASSERT_EQ(counter, (1u << (DEPTH + 1)) - 1);
+}
+
+TEST(PARALLEL_COMPILER_TEST, TEST2) {
+    // every caller inlines shared callee and folds the call away
+    constexpr uint32_t CALLERS_NUM = 200;
+
+    IrBuilder irb;
+    Graph* callee = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::PARAMETER>(2),
+            INST<Opcode::SUB>(3, 1, 2),
+            INST<Opcode::RET>(4, 3),
+        }),
+    });
+
+    std::vector<Graph*> callers;
+    for (uint32_t i = 0; i < CALLERS_NUM; ++i) {
+        irb = IrBuilder();
+        Graph* caller = GRAPH({
+            BASIC_BLOCK<0>({
+                INST<Opcode::CONSTANT>(1, i + 1000),
+                INST<Opcode::CONSTANT>(2, 1000),
+                INST<Opcode::CALL_STATIC>(3, callee, 1, 2),
+                INST<Opcode::RET>(4, 3),
+            }),
+        });
+        callers.push_back(caller);
+    }
+
+    ParallelCompiler compiler(4);
+    compiler.Compile(callers);
+
+    for (uint32_t i = 0; i < CALLERS_NUM; ++i) {
+        Inst* result = GetReturnedInst(callers[i]);
+        ASSERT_NE(result, nullptr);
+        ASSERT_EQ(result->GetOpcode(), Opcode::CONSTANT);
+        ASSERT_EQ(result->CastToInstConstant()->GetConstant(), i);
+    }
+    ASSERT_EQ(callee->GetBasicBlocks()[0]->GetSize(), 4);
+}
+
+TEST(PARALLEL_COMPILER_TEST, TEST3) {
+    // callees are compiled before their callers, cycles by one task
+    IrBuilder irb;
+    Graph* leaf = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::RET>(2, 1),
+        }),
+    });
+
+    irb = IrBuilder();
+    Graph* callee2 = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CALL_STATIC>(2, nullptr, 1),
+            INST<Opcode::RET>(3, 2),
+        }),
+    });
+
+    irb = IrBuilder();
+    Graph* callee1 = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CALL_STATIC>(2, leaf, 1),
+            INST<Opcode::CALL_STATIC>(3, callee2, 2),
+            INST<Opcode::RET>(4, 3),
+        }),
+    });
+    callee2->GetInstById(2)->CastToInstCall()->SetCallee(callee1);
+
+    std::mutex order_mutex;
+    std::vector<Graph*> order;
+    auto pipeline = [&order_mutex, &order](Graph* g) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(g);
+    };
+    ParallelCompiler compiler(4, pipeline);
+    compiler.Compile({callee1});
+
+    ASSERT_EQ(order.size(), 3);
+    ASSERT_EQ(order[0], leaf);
+    ASSERT_TRUE((order[1] == callee1 && order[2] == callee2) || (order[1] == callee2 && order[2] == callee1));
+}
@@ -132,7 +132,7 @@ TEST(PEEPHOLE_TEST, TEST_SUB) {
     ASSERT_EQ(bb->GetSize(), 6);
     ASSERT_EQ(g5->GetInstById(3), nullptr);
     ASSERT_NE(g5->GetInstById(new_inst_id), nullptr);
-    CheckUsers(bb, {{5}, {4}, {4}, {6}, {6}, {-1}});
+    CheckUsers(bb, {{5}, {4, 5}, {4}, {6}, {6}, {-1}});
     CheckInstsWithTwoInputs(bb, {{1, 2}, {1, new_inst_id}, {5, 4}});
 }
 
@@ -197,7 +197,7 @@ TEST(PEEPHOLE_TEST, TEST_SHR) {
     ASSERT_EQ(bb->GetSize(), 6);
     ASSERT_EQ(g3->GetInstById(3), nullptr);
     ASSERT_NE(g3->GetInstById(new_inst_id), nullptr);
-    CheckUsers(bb, {{5}, {4}, {4}, {6}, {6}, {-1}});
+    CheckUsers(bb, {{5}, {4, 5}, {4}, {6}, {6}, {-1}});
     CheckInstsWithTwoInputs(bb, {{1, 2}, {1, new_inst_id}, {5, 4}});
 }
 
@@ -261,6 +261,6 @@ TEST(PEEPHOLE_TEST, TEST_XOR) {
     ASSERT_EQ(g3->GetInstById(2), nullptr);
     ASSERT_EQ(g3->GetInstById(3), nullptr);
     ASSERT_NE(g3->GetInstById(new_inst_id), nullptr);
-    CheckUsers(bb, {{4, new_inst_id}, {4}, {-1}});
+    CheckUsers(bb, {{new_inst_id, 4}, {4}, {-1}});
     CheckInstsWithTwoInputs(bb, {{1, new_inst_id}});
 }
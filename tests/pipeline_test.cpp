@@ -0,0 +1,215 @@
+#include "gtest/gtest.h"
+
+#include "pass/pipeline.h"
+#include "pass/reg_alloc.h"
+#include "pass/liveness_analysis.h"
+#include "ir/ir_builder.h"
+#include "ir/ir_parser.h"
+#include "ir/graph_verifier.h"
+
+#define INST irb.InstBuilder
+#define BASIC_BLOCK irb.BasicBlockBuilder
+#define GRAPH irb.GraphBuilder
+
+Inst* GetRetInput(Graph* g)
+{
+    Inst* ret = g->GetBasicBlocks().back()->GetLastInst();
+    assert(ret->GetOpcode() == Opcode::RET);
+    return ret->CastToInstWithOneInput()->GetInput1();
+}
+
+// res = p - (2 - 2)
+Graph* BuildFoldedZeroSub(IrBuilder& irb)
+{
+    return GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CONSTANT>(2, 2),
+            INST<Opcode::CONSTANT>(3, 2),
+            INST<Opcode::SUB>(4, 2, 3),
+            INST<Opcode::SUB>(5, 1, 4),
+            INST<Opcode::RET>(6, 5),
+        }),
+    });
+}
+
+TEST(PIPELINE_TEST, TEST1) {
+    Pipeline pipeline = Pipeline::Parse("inlining, [peephole,const_folding],dce");
+    ASSERT_EQ(pipeline.GetDescription(), "inlining,[peephole,const_folding],dce");
+
+    ASSERT_EQ(Pipeline::Create(OptLevel::O0).GetDescription(), "");
+    for (auto level: {OptLevel::O1, OptLevel::O2}) {
+        ASSERT_EQ(Pipeline::Create(level).GetDescription(), Pipeline::GetDescription(level));
+    }
+}
+
+TEST(PIPELINE_TEST, TEST2) {
+    // peephole can remove subtraction of zero only after folding,
+    // which runs after it
+    IrBuilder irb;
+    Graph* g = BuildFoldedZeroSub(irb);
+    Pipeline::Create(OptLevel::O1).Run(g);
+    ASSERT_EQ(GetRetInput(g)->GetOpcode(), Opcode::SUB);
+
+    irb = IrBuilder();
+    g = BuildFoldedZeroSub(irb);
+    Pipeline::Create(OptLevel::O2).Run(g);
+    ASSERT_EQ(GetRetInput(g)->GetOpcode(), Opcode::PARAMETER);
+    ASSERT_EQ(g->GetBasicBlocks()[0]->GetSize(), 2);
+    ASSERT_TRUE(g->IsPassValid<Peephole>());
+    ASSERT_TRUE(g->IsPassValid<ConstFolding>());
+}
+
+TEST(PIPELINE_TEST, TEST3) {
+    // callee is inlined and folded into constant
+    IrBuilder irb;
+    Graph* callee = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(1),
+            INST<Opcode::CONSTANT>(2, 3),
+            INST<Opcode::SUB>(3, 1, 2),
+            INST<Opcode::RET>(4, 3),
+        }),
+    });
+
+    irb = IrBuilder();
+    Graph* caller = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::CONSTANT>(1, 10),
+            INST<Opcode::CALL_STATIC>(2, callee, 1),
+            INST<Opcode::RET>(3, 2),
+        }),
+    });
+
+    Pipeline::Create(OptLevel::O2).Run(caller);
+    Inst* result = GetRetInput(caller);
+    ASSERT_EQ(result->GetOpcode(), Opcode::CONSTANT);
+    ASSERT_EQ(result->CastToInstConstant()->GetConstant(), 7);
+}
+
+TEST(PIPELINE_TEST, TEST4) {
+    // requirements are profiled inside the pass which needs them
+    IrBuilder irb;
+    Graph* g = BuildFoldedZeroSub(irb);
+    PassProfiler& profiler = g->GetContext()->GetPassProfiler();
+    g->RunPass<RPO>();
+    ASSERT_TRUE(profiler.GetRecords().empty());
+
+    profiler.Enable();
+    g->RunPass<LinearOrder>();
+    auto& records = profiler.GetRecords();
+    ASSERT_EQ(records.size(), 3);
+    ASSERT_STREQ(records[0].pass_name_, "LinearOrder");
+    ASSERT_STREQ(records[1].pass_name_, "LoopAnalyzer");
+    ASSERT_STREQ(records[2].pass_name_, "DomTreeFast");
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        ASSERT_EQ(records[i].depth_, i);
+        ASSERT_LE(records[i].self_ns_, records[i].duration_ns_);
+        ASSERT_EQ(records[i].insts_before_, 6);
+        ASSERT_EQ(records[i].bbs_after_, 1);
+    }
+    ASSERT_LE(records[1].start_ns_ + records[1].duration_ns_, records[0].start_ns_ + records[0].duration_ns_);
+
+    Pipeline::Create(OptLevel::O2).Run(g);
+    ASSERT_EQ(profiler.GetRecords().back().insts_after_, 2);
+    // folding allocates a constant and no arena memory
+    auto folding = std::find_if(records.begin(), records.end(), [](const PassProfiler::Record& record) {
+        return std::string(record.pass_name_) == "ConstFolding";
+    });
+    ASSERT_NE(folding, records.end());
+    ASSERT_GE(folding->alloc_bytes_, sizeof(InstConstant));
+
+    std::stringstream report;
+    profiler.DumpReport(report);
+    ASSERT_NE(report.str().find("ConstFolding"), std::string::npos);
+    std::stringstream trace;
+    profiler.DumpChromeTrace(trace);
+    ASSERT_NE(trace.str().find("\"name\": \"DomTreeFast\", \"ph\": \"X\""), std::string::npos);
+}
+
+TEST(PIPELINE_TEST, TEST5) {
+    // effect of every pass is counted
+    IrBuilder irb;
+    Graph* g = BuildFoldedZeroSub(irb);
+    Pipeline::Create(OptLevel::O2).Run(g);
+
+    Statistics& statistics = g->GetContext()->GetStatistics();
+    ASSERT_EQ(statistics.Get("ConstFolding.FoldedInsts"), 1);
+    ASSERT_EQ(statistics.Get("Peephole.ReplacedInsts"), 1);
+    ASSERT_EQ(statistics.Get("DCE.RemovedInsts"), 5);
+    ASSERT_EQ(statistics.Get("Peephole.Runs"), 2);
+    ASSERT_EQ(statistics.Get("Peephole.ChangedRuns"), 1);
+    ASSERT_EQ(statistics.Get("ConstFolding.Runs"), 2);
+    ASSERT_EQ(statistics.Get("ConstFolding.ChangedRuns"), 1);
+    ASSERT_EQ(statistics.Get("Inlining.ChangedRuns"), 0);
+    ASSERT_EQ(statistics.Get("CheckElimination.RemovedChecks"), 0);
+}
+
+TEST(PIPELINE_TEST, TEST6) {
+    // constants are combined in place and DCE removes nothing,
+    // liveness has to be recomputed for register allocation
+    IrBuilder irb;
+    Graph* g = GRAPH({
+        BASIC_BLOCK<0>({
+            INST<Opcode::PARAMETER>(0),
+            INST<Opcode::CONSTANT>(1, 1),
+            INST<Opcode::CONSTANT>(2, 2),
+            INST<Opcode::SUB>(3, 0, 1),
+            INST<Opcode::SUB>(4, 3, 2),
+            INST<Opcode::ADD>(5, 3, 4),
+            INST<Opcode::ADD>(6, 5, 2),
+            INST<Opcode::RET>(7, 6),
+        }),
+    });
+    g->GetContext()->SetRegCount(1);
+    g->RunPass<LivenessAnalysis>();
+    g->RunPass<Peephole>();
+    ASSERT_EQ(g->GetContext()->GetStatistics().Get("Peephole.CombinedConsts"), 1);
+    ASSERT_EQ(g->GetContext()->GetStatistics().Get("DCE.RemovedInsts"), 0);
+    ASSERT_EQ(g->GetContext()->GetStatistics().Get("Peephole.ChangedRuns"), 1);
+    ASSERT_FALSE(g->IsPassValid<LivenessAnalysis>());
+
+    g->RunPass<RegAlloc>();
+    auto& intervals = g->GetLiveIntervals();
+    Inst* new_const = g->GetBasicBlocks()[0]->GetFirstInst();
+    ASSERT_EQ(new_const->CastToInstConstant()->GetConstant(), 3);
+    ASSERT_NE(intervals.find(new_const), intervals.end());
+    // sub v0, 3 reads new constant and parameter, which are live together
+    Inst* param = new_const->GetNext();
+    ASSERT_EQ(param->GetOpcode(), Opcode::PARAMETER);
+    auto const_interval = intervals.at(new_const);
+    auto param_interval = intervals.at(param);
+    ASSERT_FALSE(!const_interval->GetIsStackLocation() && !param_interval->GetIsStackLocation() &&
+                 const_interval->GetLocation() == param_interval->GetLocation());
+}
+
+TEST(PIPELINE_TEST, TEST7) {
+    // constants created by folding and peephole are placed after phis
+    const char* text =
+        "method loop {\n"
+        "bb0 -> bb1:\n"
+        "    v0 = PARAMETER\n"
+        "    v1 = CONSTANT 5\n"
+        "    v2 = CONSTANT 1\n"
+        "bb1 -> bb3, bb2:\n"
+        "    v3 = PHI (v1, bb0), (v7, bb2)\n"
+        "    v4 = SUB v1, v2\n"
+        "    v5 = XOR v0, v0\n"
+        "    v6 = CMP v3, v0\n"
+        "    v8 = JMP_GE bb3\n"
+        "bb2 -> bb1:\n"
+        "    v7 = ADD v3, v4\n"
+        "    v9 = JMP bb1\n"
+        "bb3:\n"
+        "    v10 = ADD v3, v5\n"
+        "    v11 = RET v10\n"
+        "}\n";
+    for (auto level: {OptLevel::O1, OptLevel::O2}) {
+        Graph* g = IrParser().Parse(text)[0];
+        Pipeline::Create(level).Run(g);
+        ASSERT_TRUE(GraphVerifier(VerifyLevel::FULL).Verify(g));
+        BasicBlock* bb1 = g->GetBBbyId(1);
+        ASSERT_EQ(bb1->GetFirstInst()->GetOpcode(), Opcode::PHI);
+        ASSERT_EQ(g->GetContext()->GetStatistics().Get("ConstFolding.FoldedInsts"), 1);
+    }
+}
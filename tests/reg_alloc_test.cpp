@@ -72,13 +72,14 @@ TEST(REG_ALLOC_TEST, TEST1) {
             INST<Opcode::RET_VOID>(11),
         }),
     });
-    RegAlloc::SetRegCount(TEST_REG_NUM);
+    g->GetContext()->SetRegCount(TEST_REG_NUM);
     g->RunPass<RegAlloc>();
     CheckAllocatedIntervals(g, {
         {0, "R0"}, {1, "R1"}, {2, "S1"},
         {3, "S0"}, {4, "R1"}, {7, "R2"},
         {8, "R1"}, {10, "R0"},
     });
+    ASSERT_EQ(g->GetContext()->GetStatistics().Get("RegAlloc.Spills"), 2);
 }
 
 TEST(REG_ALLOC_TEST, TEST2)
@@ -116,7 +117,7 @@ TEST(REG_ALLOC_TEST, TEST2)
             INST<Opcode::RET_VOID>(11),
         }),
     });
-    RegAlloc::SetRegCount(TEST_REG_NUM);
+    g->GetContext()->SetRegCount(TEST_REG_NUM);
     g->RunPass<RegAlloc>();
     CheckAllocatedIntervals(g, {
         {0, "R0"}, {1, "R1"}, {2, "S1"},
@@ -163,7 +164,7 @@ TEST(REG_ALLOC_TEST, TEST3)
             INST<Opcode::RET_VOID>(12),
         }),
     });
-    RegAlloc::SetRegCount(TEST_REG_NUM);
+    g->GetContext()->SetRegCount(TEST_REG_NUM);
     g->RunPass<RegAlloc>();
     CheckAllocatedIntervals(g, {
         {0, "R0"}, {1, "R1"}, {2, "R2"},
@@ -215,7 +216,7 @@ TEST(REG_ALLOC_TEST, TEST4)
             INST<Opcode::RET_VOID>(13)
         }),
     });
-    RegAlloc::SetRegCount(TEST_REG_NUM);
+    g->GetContext()->SetRegCount(TEST_REG_NUM);
     g->RunPass<RegAlloc>();
     CheckAllocatedIntervals(g, {
         {0, "R0"}, {1, "R1"}, {2, "R2"},
@@ -269,7 +270,7 @@ TEST(REG_ALLOC_TEST, TEST5)
             INST<Opcode::RET_VOID>(13)
         }),
     });
-    RegAlloc::SetRegCount(TEST_REG_NUM);
+    g->GetContext()->SetRegCount(TEST_REG_NUM);
     g->RunPass<RegAlloc>();
     CheckAllocatedIntervals(g, {
         {0, "R0"}, {1, "S0"}, {2, "R2"},